@@ -38,6 +38,7 @@
 #include "m64p_types.h"
 #include "main/cheat.h"
 #include "main/eventloop.h"
+#include "main/frame_pacer.h"
 #include "main/main.h"
 #include "main/rom.h"
 #include "main/savestates.h"
@@ -46,6 +47,7 @@
 #include "main/workqueue.h"
 #include "main/screenshot.h"
 #include "main/netplay.h"
+#include "backends/file_storage.h"
 #include "plugin/plugin.h"
 #include "vidext.h"
 
@@ -85,6 +87,7 @@ EXPORT m64p_error CALL CoreStartup(int APIVersion, const char *ConfigPath, const
     plugin_connect(M64PLUGIN_CORE, NULL);
 
     savestates_init();
+    frame_pacer_startup();
 
     /* next, start up the configuration handling code by loading and parsing the config file */
     if (ConfigInit(ConfigPath, DataPath) != M64ERR_SUCCESS)
@@ -107,6 +110,7 @@ EXPORT m64p_error CALL CoreStartup(int APIVersion, const char *ConfigPath, const
     romdatabase_open();
 
     workqueue_init();
+    file_storage_writer_init();
 
     l_CoreInit = 1;
     return M64ERR_SUCCESS;
@@ -121,7 +125,9 @@ EXPORT m64p_error CALL CoreShutdown(void)
     romdatabase_close();
     ConfigShutdown();
     workqueue_shutdown();
+    file_storage_writer_deinit();
     savestates_deinit();
+    frame_pacer_shutdown();
 
     /* if the calling code is using SDL, don't shut it down */
     if (!l_CallerUsingSDL)
@@ -221,6 +227,10 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
             cheat_delete_all(&g_cheat_ctx);
             cheat_uninit(&g_cheat_ctx);
             return close_disk();
+        case M64CMD_ROM_DATABASE_LOOKUP:
+            if (ParamPtr == NULL || ParamInt != sizeof(m64p_rom_database_lookup))
+                return M64ERR_INPUT_ASSERT;
+            return lookup_rom_database((m64p_rom_database_lookup *) ParamPtr);
         case M64CMD_PIF_OPEN:
             if (g_EmulatorRunning)
                 return M64ERR_INVALID_STATE;
@@ -304,6 +314,30 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
             if (ParamInt < 0 || ParamInt > 9)
                 return M64ERR_INPUT_INVALID;
             return main_core_state_set(M64CORE_SAVESTATE_SLOT, ParamInt);
+        case M64CMD_STATE_SAVE_MEMORY:
+        case M64CMD_STATE_LOAD_MEMORY:
+            if (ParamPtr == NULL || ParamInt != sizeof(m64p_state_memory))
+                return M64ERR_INPUT_ASSERT;
+            if (((m64p_state_memory *) ParamPtr)->data == NULL)
+            {
+                ((m64p_state_memory *) ParamPtr)->size = savestates_get_memory_size();
+                return M64ERR_SUCCESS;
+            }
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (((m64p_state_memory *) ParamPtr)->size < savestates_get_memory_size())
+                return M64ERR_INPUT_INVALID;
+            if (!savestates_set_memory_job(Command == M64CMD_STATE_SAVE_MEMORY ? savestates_job_save : savestates_job_load,
+                                           (const m64p_state_memory *) ParamPtr))
+                return M64ERR_INVALID_STATE;
+            return M64ERR_SUCCESS;
+        case M64CMD_FRAME_TIMING_QUERY:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (ParamPtr == NULL || ParamInt != sizeof(m64p_frame_timing))
+                return M64ERR_INPUT_ASSERT;
+            frame_pacer_get_timing((m64p_frame_timing *) ParamPtr);
+            return M64ERR_SUCCESS;
         case M64CMD_SEND_SDL_KEYDOWN:
             if (!g_EmulatorRunning)
                 return M64ERR_INVALID_STATE;
@@ -454,6 +488,7 @@ EXPORT m64p_error CALL CoreGetRomSettings(m64p_rom_settings *RomSettings, int Ro
     RomSettings->savetype = entry->savetype;
     RomSettings->sidmaduration = entry->sidmaduration;
     RomSettings->aidmamodifier = entry->aidmamodifier;
+    RomSettings->runahead = 0;
 
     return M64ERR_SUCCESS;
 }
@@ -28,6 +28,7 @@
 /* ----------------------------------------- */
 
 /* necessary headers */
+#include <stddef.h>
 #include <stdint.h>
 #if defined(WIN32)
   #include <windows.h>
@@ -139,6 +140,7 @@ typedef enum {
   M64CORE_STATE_LOADCOMPLETE,
   M64CORE_STATE_SAVECOMPLETE,
   M64CORE_SCREENSHOT_CAPTURED,
+  M64CORE_DISPLAY_REFRESH_RATE
 } m64p_core_param;
 
 typedef enum {
@@ -171,7 +173,11 @@ typedef enum {
   M64CMD_PIF_OPEN,
   M64CMD_ROM_SET_SETTINGS,
   M64CMD_DISK_OPEN,
-  M64CMD_DISK_CLOSE
+  M64CMD_DISK_CLOSE,
+  M64CMD_ROM_DATABASE_LOOKUP,
+  M64CMD_STATE_SAVE_MEMORY,
+  M64CMD_STATE_LOAD_MEMORY,
+  M64CMD_FRAME_TIMING_QUERY
 } m64p_command;
 
 typedef struct {
@@ -287,8 +293,34 @@ typedef struct
    unsigned int countperop; /* Number of CPU cycles per instruction. */
    unsigned int sidmaduration; /* Default SI DMA duration */
    unsigned int aidmamodifier; /* Percentage modifier for AI DMA duration */
+   unsigned int runahead; /* Amount of frames to run ahead, 0 disables run-ahead */
 } m64p_rom_settings;
 
+typedef struct
+{
+   m64p_rom_header   header;  /* ROM header in native (.z64) byte order */
+   unsigned char     md5[16]; /* MD5 digest of the whole ROM image in native (.z64) byte order */
+   m64p_rom_settings settings; /* Receives the settings from the ROM database */
+} m64p_rom_database_lookup;
+
+typedef struct {
+   void  *data;    /* Caller-provided buffer holding the uncompressed state */
+   size_t size;    /* Size of data in bytes, receives the required size when data is NULL */
+   void (*callback)(void *context, int result); /* Called on the emulation thread when the job has finished */
+   void  *context; /* Passed to callback */
+} m64p_state_memory;
+
+typedef struct {
+   unsigned int       frame_count; /* Amount of frames paced since emulation started */
+   unsigned int       late_frames; /* Amount of frames which were already past their deadline */
+   unsigned int       resyncs;     /* Amount of times emulation fell too far behind and the deadline was dropped */
+   unsigned long long target_ns;   /* Target duration of a frame in nanoseconds */
+   unsigned long long last_ns;     /* Duration of the last frame in nanoseconds */
+   unsigned long long average_ns;  /* Moving average of the frame duration in nanoseconds */
+   unsigned long long jitter_ns;   /* Moving average of the deviation from the target duration in nanoseconds */
+   long long          error_ns;    /* Difference between the end of the last frame and its deadline in nanoseconds */
+} m64p_frame_timing;
+
 /* ----------------------------------------- */
 /* Structures and Types for the Debugger     */
 /* ----------------------------------------- */
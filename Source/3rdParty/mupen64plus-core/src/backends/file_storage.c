@@ -21,7 +21,11 @@
 
 #include "file_storage.h"
 
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
@@ -29,6 +33,378 @@
 #include "device/dd/dd_controller.h"
 #include "main/util.h"
 #include "main/netplay.h"
+#include "osal/files.h"
+
+/* changes are written once they have been pending for this long (in ms) */
+#define FILE_STORAGE_WRITE_DELAY 1000
+
+/* when there are more dirty ranges, they're merged into one */
+#define FILE_STORAGE_MAX_RANGES 16
+
+/* storages up to this size (i.e cartridge saves) are written to a
+ * temporary file which replaces the save file, larger storages
+ * (i.e 64DD disks) only have their dirty ranges written in place */
+#define FILE_STORAGE_MAX_REPLACE_SIZE (1024 * 1024)
+
+struct file_storage_range
+{
+    size_t start;
+    size_t end;
+    /* copy of the range, only used when writing in place */
+    uint8_t* data;
+};
+
+struct file_storage_writer
+{
+    struct file_storage* fstorage;
+    struct file_storage_writer* next;
+
+    /* whether the dirty ranges are written in place,
+     * otherwise the whole file is replaced */
+    int in_place;
+
+    /* copy of the storage data which is updated on every save,
+     * NULL when writing in place */
+    uint8_t* shadow;
+    /* copy of the storage data which the writer thread writes to disk,
+     * NULL when writing in place */
+    uint8_t* buffer;
+
+    /* ranges of the shadow copy which haven't been copied to the buffer */
+    struct file_storage_range ranges[FILE_STORAGE_MAX_RANGES];
+    size_t range_count;
+    uint32_t dirty_time;
+
+    int flush;
+    int writing;
+};
+
+struct file_storage_writer_globals
+{
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_cond* work_avail;
+    SDL_cond* work_done;
+    struct file_storage_writer* writers;
+    int quit;
+};
+
+static struct file_storage_writer_globals writer_mgmt;
+
+static int ranges_touch(const struct file_storage_range* range, size_t start, size_t end)
+{
+    return range->start <= end && start <= range->end;
+}
+
+/* records a dirty range, when writing in place the merged range
+ * is copied from the storage data, returns 0 when that fails */
+static int add_dirty_range(struct file_storage_writer* writer, size_t start, size_t end)
+{
+    size_t i;
+    size_t merged = 0;
+    uint8_t* data = NULL;
+    int merge_all;
+
+    /* the new range is merged with the ranges it overlaps or touches,
+     * when there would be too many ranges, they're all merged into one */
+    for (i = 0; i < writer->range_count; ++i) {
+        if (ranges_touch(&writer->ranges[i], start, end))
+            ++merged;
+    }
+    merge_all = (writer->range_count - merged) == FILE_STORAGE_MAX_RANGES;
+
+    for (i = 0; i < writer->range_count; ++i) {
+        const struct file_storage_range* range = &writer->ranges[i];
+        if (merge_all || ranges_touch(range, start, end)) {
+            start = (range->start < start) ? range->start : start;
+            end = (range->end > end) ? range->end : end;
+        }
+    }
+
+    if (writer->in_place) {
+        data = malloc(end - start);
+        if (data == NULL)
+            return 0;
+
+        /* the storage data is newer than the
+         * copies of the ranges which are merged */
+        memcpy(data, writer->fstorage->data + start, end - start);
+    }
+
+    i = 0;
+    while (i < writer->range_count) {
+        struct file_storage_range* range = &writer->ranges[i];
+        if (merge_all || ranges_touch(range, start, end)) {
+            free(range->data);
+            writer->ranges[i] = writer->ranges[--writer->range_count];
+        }
+        else {
+            ++i;
+        }
+    }
+
+    writer->ranges[writer->range_count].start = start;
+    writer->ranges[writer->range_count].end = end;
+    writer->ranges[writer->range_count].data = data;
+    writer->range_count++;
+    return 1;
+}
+
+/* writes the ranges to the file in place and flushes it to disk */
+static file_status_t write_ranges_to_file(const char* filename, const struct file_storage_range* ranges, size_t count)
+{
+    FILE* f;
+    size_t i;
+
+    f = osal_file_open(filename, "rb+");
+    if (f == NULL)
+        return file_open_error;
+
+    for (i = 0; i < count; ++i) {
+        if (fseek(f, (long)ranges[i].start, SEEK_SET) != 0 ||
+            fwrite(ranges[i].data, 1, ranges[i].end - ranges[i].start, f) != ranges[i].end - ranges[i].start) {
+            fclose(f);
+            return file_write_error;
+        }
+    }
+
+    if (fflush(f) != 0 || osal_file_sync(f) != 0) {
+        fclose(f);
+        return file_write_error;
+    }
+
+    fclose(f);
+    return file_ok;
+}
+
+static void write_file_storage(struct file_storage_writer* writer)
+{
+    struct file_storage_range ranges[FILE_STORAGE_MAX_RANGES];
+    size_t range_count = writer->range_count;
+    size_t i;
+    file_status_t err;
+
+    /* take the changes while the lock is held,
+     * then write the file without holding it */
+    if (writer->in_place) {
+        memcpy(ranges, writer->ranges, range_count * sizeof(ranges[0]));
+    }
+    else {
+        for (i = 0; i < range_count; ++i) {
+            memcpy(writer->buffer + writer->ranges[i].start,
+                   writer->shadow + writer->ranges[i].start,
+                   writer->ranges[i].end - writer->ranges[i].start);
+        }
+    }
+    writer->range_count = 0;
+    writer->writing = 1;
+
+    SDL_UnlockMutex(writer_mgmt.lock);
+    if (writer->in_place) {
+        err = write_ranges_to_file(writer->fstorage->filename, ranges, range_count);
+        for (i = 0; i < range_count; ++i)
+            free(ranges[i].data);
+    }
+    else {
+        err = write_to_file_safely(writer->fstorage->filename, writer->buffer, writer->fstorage->size);
+    }
+    SDL_LockMutex(writer_mgmt.lock);
+
+    writer->writing = 0;
+    SDL_CondBroadcast(writer_mgmt.work_done);
+
+    switch(err)
+    {
+    case file_open_error:
+        DebugMessage(M64MSG_WARNING, "couldn't open storage file '%s' for writing", writer->fstorage->filename);
+        break;
+    case file_write_error:
+        DebugMessage(M64MSG_WARNING, "failed to write storage file '%s'", writer->fstorage->filename);
+        break;
+    default:
+        break;
+    }
+}
+
+static int file_storage_writer_thread(void* data)
+{
+    struct file_storage_writer* writer;
+    struct file_storage_writer* ready;
+    uint32_t now, elapsed, timeout;
+
+    SDL_LockMutex(writer_mgmt.lock);
+
+    for (;;) {
+        ready = NULL;
+        timeout = UINT32_MAX;
+        now = SDL_GetTicks();
+
+        for (writer = writer_mgmt.writers; writer != NULL; writer = writer->next) {
+            if (writer->range_count == 0)
+                continue;
+
+            elapsed = now - writer->dirty_time;
+            if (writer->flush || writer_mgmt.quit || elapsed >= FILE_STORAGE_WRITE_DELAY) {
+                ready = writer;
+                break;
+            }
+
+            if ((FILE_STORAGE_WRITE_DELAY - elapsed) < timeout)
+                timeout = FILE_STORAGE_WRITE_DELAY - elapsed;
+        }
+
+        if (ready != NULL) {
+            write_file_storage(ready);
+            continue;
+        }
+
+        /* everything has been written */
+        if (writer_mgmt.quit)
+            break;
+
+        if (timeout == UINT32_MAX)
+            SDL_CondWait(writer_mgmt.work_avail, writer_mgmt.lock);
+        else
+            SDL_CondWaitTimeout(writer_mgmt.work_avail, writer_mgmt.lock, timeout);
+    }
+
+    SDL_UnlockMutex(writer_mgmt.lock);
+    return 0;
+}
+
+static void free_file_storage_writer(struct file_storage_writer* writer)
+{
+    for (size_t i = 0; i < writer->range_count; ++i)
+        free(writer->ranges[i].data);
+
+    writer->fstorage->writer = NULL;
+    free(writer->shadow);
+    free(writer->buffer);
+    free(writer);
+}
+
+/* returns 0 when the changes have to be written right away */
+static int queue_file_storage_write(struct file_storage* fstorage, size_t start, size_t size)
+{
+    struct file_storage_writer* writer;
+    int in_place = fstorage->size > FILE_STORAGE_MAX_REPLACE_SIZE;
+
+    if (writer_mgmt.thread == NULL)
+        return 0;
+
+    /* ranges are written in place into the existing file,
+     * so the first save writes the whole file right away */
+    if (in_place && fstorage->first_access)
+        return 0;
+
+    SDL_LockMutex(writer_mgmt.lock);
+
+    writer = fstorage->writer;
+    if (writer == NULL) {
+        writer = calloc(1, sizeof(struct file_storage_writer));
+        if (writer == NULL) {
+            SDL_UnlockMutex(writer_mgmt.lock);
+            return 0;
+        }
+
+        writer->in_place = in_place;
+        if (!in_place) {
+            writer->shadow = malloc(fstorage->size);
+            writer->buffer = malloc(fstorage->size);
+            if (writer->shadow == NULL || writer->buffer == NULL) {
+                free(writer->shadow);
+                free(writer->buffer);
+                free(writer);
+                SDL_UnlockMutex(writer_mgmt.lock);
+                return 0;
+            }
+
+            /* the whole file is written every time,
+             * so the buffer starts with all data */
+            memcpy(writer->shadow, fstorage->data, fstorage->size);
+            memcpy(writer->buffer, fstorage->data, fstorage->size);
+        }
+
+        writer->fstorage = fstorage;
+        writer->next = writer_mgmt.writers;
+        writer_mgmt.writers = writer;
+        fstorage->writer = writer;
+    }
+    else if (!in_place) {
+        memcpy(writer->shadow + start, fstorage->data + start, size);
+    }
+
+    if (writer->range_count == 0) {
+        writer->dirty_time = SDL_GetTicks();
+        SDL_CondSignal(writer_mgmt.work_avail);
+    }
+
+    if (!add_dirty_range(writer, start, start + size)) {
+        /* drop the pending ranges and write the whole file right
+         * away instead, once the writer thread is done with it */
+        while (writer->writing)
+            SDL_CondWait(writer_mgmt.work_done, writer_mgmt.lock);
+        for (size_t i = 0; i < writer->range_count; ++i)
+            free(writer->ranges[i].data);
+        writer->range_count = 0;
+        fstorage->first_access = 1;
+        SDL_UnlockMutex(writer_mgmt.lock);
+        return 0;
+    }
+
+    SDL_UnlockMutex(writer_mgmt.lock);
+    return 1;
+}
+
+void file_storage_writer_init(void)
+{
+    memset(&writer_mgmt, 0, sizeof(writer_mgmt));
+
+    writer_mgmt.lock = SDL_CreateMutex();
+    writer_mgmt.work_avail = SDL_CreateCond();
+    writer_mgmt.work_done = SDL_CreateCond();
+    if (writer_mgmt.lock == NULL || writer_mgmt.work_avail == NULL || writer_mgmt.work_done == NULL) {
+        DebugMessage(M64MSG_WARNING, "Could not create storage writer, saves are written right away");
+        file_storage_writer_deinit();
+        return;
+    }
+
+    writer_mgmt.thread = SDL_CreateThread(file_storage_writer_thread, "m64pstorage", NULL);
+    if (writer_mgmt.thread == NULL) {
+        DebugMessage(M64MSG_WARNING, "Could not create storage writer thread, saves are written right away");
+        file_storage_writer_deinit();
+    }
+}
+
+void file_storage_writer_deinit(void)
+{
+    struct file_storage_writer* writer;
+
+    if (writer_mgmt.thread != NULL) {
+        SDL_LockMutex(writer_mgmt.lock);
+        writer_mgmt.quit = 1;
+        SDL_CondSignal(writer_mgmt.work_avail);
+        SDL_UnlockMutex(writer_mgmt.lock);
+
+        /* the thread writes all pending changes before it exits */
+        SDL_WaitThread(writer_mgmt.thread, NULL);
+    }
+
+    while (writer_mgmt.writers != NULL) {
+        writer = writer_mgmt.writers;
+        writer_mgmt.writers = writer->next;
+        free_file_storage_writer(writer);
+    }
+
+    if (writer_mgmt.work_done != NULL)
+        SDL_DestroyCond(writer_mgmt.work_done);
+    if (writer_mgmt.work_avail != NULL)
+        SDL_DestroyCond(writer_mgmt.work_avail);
+    if (writer_mgmt.lock != NULL)
+        SDL_DestroyMutex(writer_mgmt.lock);
+
+    memset(&writer_mgmt, 0, sizeof(writer_mgmt));
+}
 
 int open_file_storage(struct file_storage* fstorage, size_t size, const char* filename)
 {
@@ -36,6 +412,7 @@ int open_file_storage(struct file_storage* fstorage, size_t size, const char* fi
     fstorage->filename = filename;
     fstorage->size = size;
     fstorage->first_access = 1;
+    fstorage->writer = NULL;
 
     /* allocate memory for holding data */
     fstorage->data = malloc(fstorage->size);
@@ -60,6 +437,7 @@ int open_rom_file_storage(struct file_storage* fstorage, const char* filename)
     fstorage->size = 0;
     fstorage->filename = NULL;
     fstorage->first_access = 1;
+    fstorage->writer = NULL;
 
     file_status_t err = load_file(filename, (void**)&fstorage->data, &fstorage->size);
 
@@ -71,8 +449,36 @@ int open_rom_file_storage(struct file_storage* fstorage, const char* filename)
     return err;
 }
 
+void flush_file_storage(struct file_storage* fstorage)
+{
+    struct file_storage_writer* writer = fstorage->writer;
+    struct file_storage_writer** link;
+
+    if (writer == NULL)
+        return;
+
+    SDL_LockMutex(writer_mgmt.lock);
+
+    writer->flush = 1;
+    SDL_CondSignal(writer_mgmt.work_avail);
+    while (writer->range_count != 0 || writer->writing)
+        SDL_CondWait(writer_mgmt.work_done, writer_mgmt.lock);
+
+    for (link = &writer_mgmt.writers; *link != NULL; link = &(*link)->next) {
+        if (*link == writer) {
+            *link = writer->next;
+            break;
+        }
+    }
+
+    SDL_UnlockMutex(writer_mgmt.lock);
+
+    free_file_storage_writer(writer);
+}
+
 void close_file_storage(struct file_storage* fstorage)
 {
+    flush_file_storage(fstorage);
     free((void*)fstorage->data);
     free((void*)fstorage->filename);
 }
@@ -99,6 +505,9 @@ static void file_storage_save(void* storage, size_t start, size_t size)
 
     file_status_t err;
 
+    if (queue_file_storage_write(fstorage, start, size))
+        return;
+
     /* On first save access ignore start/size and write full storage content,
      * otherwise write only updated chunk */
     if (fstorage->first_access) {
@@ -124,8 +533,10 @@ static void file_storage_save(void* storage, size_t start, size_t size)
 
 static void file_storage_parent_save(void* storage, size_t start, size_t size)
 {
-    struct file_storage* fstorage = (struct file_storage*)((struct file_storage*)storage)->filename;
-    file_storage_save(fstorage, start, size);
+    struct file_storage* sub_fstorage = (struct file_storage*)storage;
+    struct file_storage* fstorage = (struct file_storage*)sub_fstorage->filename;
+    /* start is relative to the data of the sub storage */
+    file_storage_save(fstorage, (size_t)(sub_fstorage->data - fstorage->data) + start, size);
 }
 
 static void dummy_save(void* storage, size_t start, size_t size)
@@ -25,17 +25,32 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct file_storage_writer;
+
 struct file_storage
 {
     uint8_t* data;
     size_t size;
     const char* filename;
     int first_access;
+    /* pending background writes, NULL when there are none */
+    struct file_storage_writer* writer;
 };
 
 
+/* Saves are written to disk in the background by a writer thread.
+ * Changes are collected for a short while, so games which save every
+ * frame only cause a write every so often. Cartridge saves are replaced
+ * atomically, larger storages (64DD disks) only have the changed ranges
+ * written in place. Without the writer thread, saves are written right away. */
+void file_storage_writer_init(void);
+void file_storage_writer_deinit(void);
+
 int open_file_storage(struct file_storage* storage, size_t size, const char* filename);
 int open_rom_file_storage(struct file_storage* storage, const char* filename);
+/* writes pending changes to disk and waits for them to finish,
+ * the storage data mustn't be released before this */
+void flush_file_storage(struct file_storage* storage);
 void close_file_storage(struct file_storage* storage);
 
 extern const struct storage_backend_interface g_ifile_storage;
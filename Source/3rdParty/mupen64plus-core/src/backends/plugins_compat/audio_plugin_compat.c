@@ -27,6 +27,8 @@
 #include "device/rcp/vi/vi_controller.h"
 #include "device/rdram/rdram.h"
 #include "main/rom.h"
+#include "main/rollback.h"
+#include "main/runahead.h"
 #include "plugin/plugin.h"
 
 static void audio_plugin_set_frequency(void* aout, unsigned int frequency)
@@ -48,6 +50,11 @@ static void audio_plugin_push_samples(void* aout, const void* buffer, size_t siz
     uint32_t saved_ai_length = ai->regs[AI_LEN_REG];
     uint32_t saved_ai_dram = ai->regs[AI_DRAM_ADDR_REG];
 
+    /* frames which will be rolled back by run-ahead
+     * and frames which are resimulated aren't heard */
+    if (runahead_is_audio_silent() || rollback_is_audio_silent())
+        return;
+
     /* exploit the fact that buffer points in g_dev.rdram.dram to retreive dram_addr_reg value */
     ai->regs[AI_DRAM_ADDR_REG] = (uint32_t)((uint8_t*)buffer - (uint8_t*)ai->ri->rdram->dram);
     ai->regs[AI_LEN_REG] = (uint32_t)size;
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 #include "interrupt.h"
+#include "interrupt_queue.h"
 #include "tlb.h"
 
 #include "new_dynarec/new_dynarec.h"
@@ -140,33 +141,6 @@ enum r4300_cp0_registers
 
 
 
-enum { INTERRUPT_NODES_POOL_CAPACITY = 16 };
-
-struct interrupt_event
-{
-    int type;
-    unsigned int count;
-};
-
-struct node
-{
-    struct interrupt_event data;
-    struct node *next;
-};
-
-struct pool
-{
-    struct node nodes [INTERRUPT_NODES_POOL_CAPACITY];
-    struct node* stack[INTERRUPT_NODES_POOL_CAPACITY];
-    size_t index;
-};
-
-struct interrupt_queue
-{
-    struct pool pool;
-    struct node* first;
-};
-
 struct interrupt_handler
 {
     void* opaque;
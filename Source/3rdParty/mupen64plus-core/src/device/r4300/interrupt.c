@@ -44,72 +44,49 @@
 #include "device/rcp/ai/ai_controller.h"
 #include "device/rcp/vi/vi_controller.h"
 #include "main/main.h"
+#include "main/rollback.h"
+#include "main/runahead.h"
 #include "main/savestates.h"
 
 
-/***************************************************************************
- * Pool of Single Linked List Nodes
- **************************************************************************/
-
-static struct node* alloc_node(struct pool* p);
-static void free_node(struct pool* p, struct node* node);
-static void clear_pool(struct pool* p);
-
-
-/* node allocation/deallocation on a given pool */
-static struct node* alloc_node(struct pool* p)
-{
-    /* return NULL if pool is too small */
-    if (p->index >= INTERRUPT_NODES_POOL_CAPACITY) {
-        return NULL;
-    }
-
-    return p->stack[p->index++];
-}
-
-static void free_node(struct pool* p, struct node* node)
-{
-    if (p->index == 0 || node == NULL) {
-        return;
-    }
-
-    p->stack[--p->index] = node;
-}
-
-/* release all nodes */
-static void clear_pool(struct pool* p)
-{
-    size_t i;
-
-    for (i = 0; i < INTERRUPT_NODES_POOL_CAPACITY; ++i) {
-        p->stack[i] = &p->nodes[i];
-    }
-
-    p->index = 0;
-}
-
 /***************************************************************************
  * Interrupt Queue
  **************************************************************************/
 
 static void clear_queue(struct interrupt_queue* q)
 {
-    q->first = NULL;
-    clear_pool(&q->pool);
+    clear_interrupt_queue(q);
 }
 
-static int before_event(const struct cp0* cp0, unsigned int evt1, unsigned int evt2, int type2)
+/* events are ordered relative to the count at which
+ * the next interrupt is checked */
+static void update_queue_base(struct cp0* cp0)
 {
-    const uint32_t* cp0_regs = r4300_cp0_regs((struct cp0*)cp0); /* OK to cast away const qualifier */
+    const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
     uint32_t count = cp0_regs[CP0_COUNT_REG];
-    int* cp0_cycle_count = r4300_cp0_cycle_count((struct cp0*)cp0);
+    int* cp0_cycle_count = r4300_cp0_cycle_count(cp0);
 
     /* At least one other interrupt is pending */
     if (*cp0_cycle_count > 0)
         count -= *cp0_cycle_count;
 
-    if ((evt1 - count) < (evt2 - count)) return 1;
-    else return 0;
+    cp0->q.base = count;
+}
+
+static void update_next_interrupt(struct cp0* cp0)
+{
+    const struct interrupt_event* first = first_interrupt_queue(&cp0->q);
+    const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
+    unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(cp0);
+    int* cp0_cycle_count = r4300_cp0_cycle_count(cp0);
+
+    *cp0_next_interrupt = (first != NULL)
+        ? first->count
+        : 0;
+
+    *cp0_cycle_count = (first != NULL)
+        ? (cp0_regs[CP0_COUNT_REG] - first->count)
+        : 0;
 }
 
 unsigned int add_random_interrupt_time(struct r4300_core* r4300)
@@ -134,146 +111,63 @@ void add_interrupt_event(struct cp0* cp0, int type, unsigned int delay)
 
 void add_interrupt_event_count(struct cp0* cp0, int type, unsigned int count)
 {
-    struct node* event;
-    struct node* e;
-    const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
-    unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(cp0);
-    int* cp0_cycle_count = r4300_cp0_cycle_count(cp0);
-
     if (get_event(&cp0->q, type)) {
         DebugMessage(M64MSG_WARNING, "two events of type 0x%x in interrupt queue", type);
     }
 
-    event = alloc_node(&cp0->q.pool);
-    if (event == NULL)
+    update_queue_base(cp0);
+
+    if (push_interrupt_queue(&cp0->q, type, count) == NULL)
     {
         DebugMessage(M64MSG_ERROR, "Failed to allocate node for new interrupt event");
         return;
     }
 
-    event->data.count = count;
-    event->data.type = type;
-
-    if (cp0->q.first == NULL)
-    {
-        cp0->q.first = event;
-        event->next = NULL;
-    }
-    else if (before_event(cp0, count, cp0->q.first->data.count, cp0->q.first->data.type))
-    {
-        event->next = cp0->q.first;
-        cp0->q.first = event;
-    }
-    else
-    {
-        for (e = cp0->q.first;
-            e->next != NULL &&
-            (!before_event(cp0, count, e->next->data.count, e->next->data.type));
-            e = e->next);
-
-        if (e->next == NULL)
-        {
-            e->next = event;
-            event->next = NULL;
-        }
-        else
-        {
-            for(; e->next != NULL && e->next->data.count == count; e = e->next);
-
-            event->next = e->next;
-            e->next = event;
-        }
-    }
-    *cp0_next_interrupt = cp0->q.first->data.count;
-    *cp0_cycle_count = cp0_regs[CP0_COUNT_REG] - cp0->q.first->data.count;
+    update_next_interrupt(cp0);
 }
 
 void remove_interrupt_event(struct cp0* cp0)
 {
-    struct node* e;
-    const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
-    unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(cp0);
-    int* cp0_cycle_count = r4300_cp0_cycle_count(cp0);
-
-    e = cp0->q.first;
-    cp0->q.first = e->next;
-    free_node(&cp0->q.pool, e);
-
-    *cp0_next_interrupt = (cp0->q.first != NULL)
-        ? cp0->q.first->data.count
-        : 0;
-
-    *cp0_cycle_count = (cp0->q.first != NULL)
-        ? (cp0_regs[CP0_COUNT_REG] - cp0->q.first->data.count)
-        : 0;
+    pop_interrupt_queue(&cp0->q);
+    update_next_interrupt(cp0);
 }
 
 unsigned int* get_event(const struct interrupt_queue* q, int type)
 {
-    struct node* e = q->first;
-
-    if (e == NULL) {
-        return NULL;
-    }
+    struct node* e = find_interrupt_queue(q, type);
 
-    if (e->data.type == type) {
-        return &e->data.count;
-    }
-
-    for (; e->next != NULL && e->next->data.type != type; e = e->next);
-
-    return (e->next != NULL)
-        ? &e->next->data.count
+    return (e != NULL)
+        ? &e->data.count
         : NULL;
 }
 
 int get_next_event_type(const struct interrupt_queue* q)
 {
-    return (q->first == NULL)
+    const struct interrupt_event* first = first_interrupt_queue(q);
+
+    return (first == NULL)
         ? 0
-        : q->first->data.type;
+        : first->type;
 }
 
 void remove_event(struct interrupt_queue* q, int type)
 {
-    struct node* to_del;
-    struct node* e = q->first;
+    struct node* e = find_interrupt_queue(q, type);
 
-    if (e == NULL) {
-        return;
-    }
-
-    if (e->data.type == type)
-    {
-        q->first = e->next;
-        free_node(&q->pool, e);
-    }
-    else
-    {
-        for (; e->next != NULL && e->next->data.type != type; e = e->next);
-
-        if (e->next != NULL)
-        {
-            to_del = e->next;
-            e->next = to_del->next;
-            free_node(&q->pool, to_del);
-        }
+    if (e != NULL) {
+        remove_interrupt_queue(q, e);
     }
 }
 
 void translate_event_queue(struct cp0* cp0, unsigned int base)
 {
-    struct node* e;
     uint32_t* cp0_regs = r4300_cp0_regs(cp0);
     int* cp0_cycle_count = r4300_cp0_cycle_count(cp0);
 
     remove_event(&cp0->q, COMPARE_INT);
     remove_event(&cp0->q, SPECIAL_INT);
 
-    for (e = cp0->q.first; e != NULL; e = e->next)
-    {
-        e->data.count = (e->data.count - cp0_regs[CP0_COUNT_REG]) + base;
-    }
+    shift_interrupt_queue(&cp0->q, base - cp0_regs[CP0_COUNT_REG]);
 
     cp0_regs[CP0_COUNT_REG] = base;
     add_interrupt_event_count(cp0, SPECIAL_INT, ((cp0_regs[CP0_COUNT_REG] & UINT32_C(0x80000000)) ^ UINT32_C(0x80000000)));
@@ -285,7 +179,7 @@ void translate_event_queue(struct cp0* cp0, unsigned int base)
     cp0_regs[CP0_COUNT_REG] -= cp0->count_per_op;
 
     /* Update next interrupt in case first event is COMPARE_INT */
-    *cp0_cycle_count = cp0_regs[CP0_COUNT_REG] - cp0->q.first->data.count;
+    *cp0_cycle_count = cp0_regs[CP0_COUNT_REG] - first_interrupt_queue(&cp0->q)->count;
 }
 
 int save_eventqueue_infos(const struct cp0* cp0, char *buf)
@@ -334,7 +228,6 @@ void init_interrupt(struct cp0* cp0)
 
 void r4300_check_interrupt(struct r4300_core* r4300, uint32_t cause_ip, int set_cause)
 {
-    struct node* event;
     uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0);
     unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(&r4300->cp0);
     int* cp0_cycle_count = r4300_cp0_cycle_count(&r4300->cp0);
@@ -351,29 +244,14 @@ void r4300_check_interrupt(struct r4300_core* r4300, uint32_t cause_ip, int set_
     }
     if (cp0_regs[CP0_STATUS_REG] & cp0_regs[CP0_CAUSE_REG] & UINT32_C(0xFF00))
     {
-        event = alloc_node(&r4300->cp0.q.pool);
-
-        if (event == NULL)
+        if (push_front_interrupt_queue(&r4300->cp0.q, CHECK_INT, cp0_regs[CP0_COUNT_REG]) == NULL)
         {
             DebugMessage(M64MSG_ERROR, "Failed to allocate node for new interrupt event");
             return;
         }
 
-        event->data.count = *cp0_next_interrupt = cp0_regs[CP0_COUNT_REG];
-        event->data.type = CHECK_INT;
+        *cp0_next_interrupt = cp0_regs[CP0_COUNT_REG];
         *cp0_cycle_count = 0;
-
-        if (r4300->cp0.q.first == NULL)
-        {
-            r4300->cp0.q.first = event;
-            event->next = NULL;
-        }
-        else
-        {
-            event->next = r4300->cp0.q.first;
-            r4300->cp0.q.first = event;
-
-        }
     }
 }
 
@@ -406,7 +284,7 @@ void compare_int_handler(void* opaque)
     cp0_regs[CP0_COUNT_REG] -= r4300->cp0.count_per_op;
 
     /* Update next interrupt in case first event is COMPARE_INT */
-    *cp0_cycle_count = cp0_regs[CP0_COUNT_REG] - r4300->cp0.q.first->data.count;
+    *cp0_cycle_count = cp0_regs[CP0_COUNT_REG] - first_interrupt_queue(&r4300->cp0.q)->count;
 
     raise_maskable_interrupt(r4300, CP0_CAUSE_IP7);
 }
@@ -534,10 +412,6 @@ static void call_interrupt_handler(const struct cp0* cp0, size_t index)
 
 void gen_interrupt(struct r4300_core* r4300)
 {
-    uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0);
-    unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(&r4300->cp0);
-    int* cp0_cycle_count = r4300_cp0_cycle_count(&r4300->cp0);
-
     if (*r4300_stop(r4300) == 1)
     {
         g_gs_vi_counter = 0; // debug
@@ -549,6 +423,14 @@ void gen_interrupt(struct r4300_core* r4300)
     }
 
     if (!r4300->cp0.interrupt_unsafe_state)
+    {
+        if (runahead_load() || rollback_load())
+            return;
+    }
+
+    /* anything done while running ahead or resimulating would be
+     * rolled back, so wait for the frame with fresh input */
+    if (!r4300->cp0.interrupt_unsafe_state && !runahead_is_ahead() && !rollback_is_resimulating())
     {
         if (savestates_get_job() == savestates_job_load)
         {
@@ -556,6 +438,12 @@ void gen_interrupt(struct r4300_core* r4300)
             return;
         }
 
+        if (savestates_get_memory_job() == savestates_job_load)
+        {
+            savestates_load_memory();
+            return;
+        }
+
         if (r4300->reset_hard_job)
         {
             call_interrupt_handler(&r4300->cp0, 11);
@@ -568,20 +456,14 @@ void gen_interrupt(struct r4300_core* r4300)
         uint32_t dest = r4300->skip_jump;
         r4300->skip_jump = 0;
 
-        *cp0_next_interrupt = (r4300->cp0.q.first != NULL)
-            ? r4300->cp0.q.first->data.count
-            : 0;
-
-        *cp0_cycle_count = (r4300->cp0.q.first != NULL)
-            ? (cp0_regs[CP0_COUNT_REG] - r4300->cp0.q.first->data.count)
-            : 0;
+        update_next_interrupt(&r4300->cp0);
 
         r4300->cp0.last_addr = dest;
         generic_jump_to(r4300, dest);
         return;
     }
 
-    switch (r4300->cp0.q.first->data.type)
+    switch (get_next_event_type(&r4300->cp0.q))
     {
         case VI_INT:
             call_interrupt_handler(&r4300->cp0, 0);
@@ -657,19 +539,31 @@ void gen_interrupt(struct r4300_core* r4300)
             break;
 
         default:
-            DebugMessage(M64MSG_ERROR, "Unknown interrupt queue event type %.8X.", r4300->cp0.q.first->data.type);
+            DebugMessage(M64MSG_ERROR, "Unknown interrupt queue event type %.8X.", get_next_event_type(&r4300->cp0.q));
             remove_interrupt_event(&r4300->cp0);
             exception_general(r4300);
             break;
     }
 
     if (!r4300->cp0.interrupt_unsafe_state)
+    {
+        runahead_save();
+        rollback_save();
+    }
+
+    if (!r4300->cp0.interrupt_unsafe_state && !runahead_is_ahead() && !rollback_is_resimulating())
     {
         if (savestates_get_job() == savestates_job_save)
         {
             savestates_save();
             return;
         }
+
+        if (savestates_get_memory_job() == savestates_job_save)
+        {
+            savestates_save_memory();
+            return;
+        }
     }
 }
 
@@ -0,0 +1,145 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - interrupt_queue.c                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "interrupt_queue.h"
+
+#include <string.h>
+
+static int before_event(const struct interrupt_queue* q, unsigned int evt1, unsigned int evt2)
+{
+    return (evt1 - q->base) < (evt2 - q->base);
+}
+
+static struct node* alloc_node(struct interrupt_queue* q, int type, unsigned int count)
+{
+    struct node* node;
+    size_t bucket = interrupt_queue_bucket(type);
+
+    /* return NULL if pool is too small */
+    if (q->pool.index >= INTERRUPT_NODES_POOL_CAPACITY) {
+        return NULL;
+    }
+
+    node = q->pool.stack[q->pool.index++];
+
+    node->data.type = type;
+    node->data.count = count;
+
+    q->buckets[bucket] = node;
+    q->bucket_sizes[bucket]++;
+
+    return node;
+}
+
+void clear_interrupt_queue(struct interrupt_queue* q)
+{
+    size_t i;
+
+    for (i = 0; i < INTERRUPT_NODES_POOL_CAPACITY; ++i) {
+        q->pool.stack[i] = &q->pool.nodes[i];
+    }
+
+    memset(q->buckets, 0, sizeof(q->buckets));
+    memset(q->bucket_sizes, 0, sizeof(q->bucket_sizes));
+
+    q->pool.index = 0;
+    q->first = NULL;
+    q->base = 0;
+}
+
+struct node* push_interrupt_queue(struct interrupt_queue* q, int type, unsigned int count)
+{
+    struct node* e;
+    struct node* node = alloc_node(q, type, count);
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (q->first == NULL || before_event(q, count, q->first->data.count))
+    {
+        node->next = q->first;
+        q->first = node;
+        return node;
+    }
+
+    /* insert after all events which don't come later,
+     * so events with the same count keep their order */
+    for (e = q->first;
+        e->next != NULL && !before_event(q, count, e->next->data.count);
+        e = e->next);
+
+    node->next = e->next;
+    e->next = node;
+
+    return node;
+}
+
+struct node* push_front_interrupt_queue(struct interrupt_queue* q, int type, unsigned int count)
+{
+    struct node* node = alloc_node(q, type, count);
+
+    if (node != NULL) {
+        node->next = q->first;
+        q->first = node;
+    }
+
+    return node;
+}
+
+void pop_interrupt_queue(struct interrupt_queue* q)
+{
+    if (q->first != NULL) {
+        remove_interrupt_queue(q, q->first);
+    }
+}
+
+void remove_interrupt_queue(struct interrupt_queue* q, struct node* node)
+{
+    struct node* e;
+    struct node** link = &q->first;
+    size_t bucket = interrupt_queue_bucket(node->data.type);
+
+    while (*link != node) {
+        link = &(*link)->next;
+    }
+    *link = node->next;
+
+    /* keep an event which is left in the bucket */
+    if (--q->bucket_sizes[bucket] != 0 && q->buckets[bucket] == node)
+    {
+        for (e = q->first; interrupt_queue_bucket(e->data.type) != bucket; e = e->next);
+        q->buckets[bucket] = e;
+    }
+
+    q->pool.stack[--q->pool.index] = node;
+}
+
+void shift_interrupt_queue(struct interrupt_queue* q, unsigned int offset)
+{
+    struct node* e;
+
+    for (e = q->first; e != NULL; e = e->next) {
+        e->data.count += offset;
+    }
+
+    q->base += offset;
+}
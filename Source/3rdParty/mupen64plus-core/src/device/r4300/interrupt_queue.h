@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - interrupt_queue.h                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_DEVICE_R4300_INTERRUPT_QUEUE_H
+#define M64P_DEVICE_R4300_INTERRUPT_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The interrupt queue is a singly linked list sorted by the count of the
+ * events. Counts wrap around, so they are compared relative to the base
+ * count of the queue, which has to be set before events are added.
+ * Events with the same count are kept in the order in which they were added.
+ *
+ * Events are also kept in buckets by their type, which makes looking up
+ * events by their type cheap.
+ */
+
+enum { INTERRUPT_NODES_POOL_CAPACITY = 16 };
+enum { INTERRUPT_QUEUE_TYPE_BUCKETS = 32 };
+
+struct interrupt_event
+{
+    int type;
+    unsigned int count;
+};
+
+struct node
+{
+    struct interrupt_event data;
+    struct node *next;
+};
+
+struct pool
+{
+    struct node nodes [INTERRUPT_NODES_POOL_CAPACITY];
+    struct node* stack[INTERRUPT_NODES_POOL_CAPACITY];
+    size_t index;
+};
+
+struct interrupt_queue
+{
+    struct pool pool;
+    struct node* first;
+    /* an event of the types in each bucket, and how many there are */
+    struct node* buckets[INTERRUPT_QUEUE_TYPE_BUCKETS];
+    unsigned char bucket_sizes[INTERRUPT_QUEUE_TYPE_BUCKETS];
+    /* count to which the counts of the events are relative */
+    unsigned int base;
+};
+
+void clear_interrupt_queue(struct interrupt_queue* q);
+
+/* returns NULL when the queue is full */
+struct node* push_interrupt_queue(struct interrupt_queue* q, int type, unsigned int count);
+
+/* adds the event in front of all other events, regardless of its count */
+struct node* push_front_interrupt_queue(struct interrupt_queue* q, int type, unsigned int count);
+
+void pop_interrupt_queue(struct interrupt_queue* q);
+
+void remove_interrupt_queue(struct interrupt_queue* q, struct node* node);
+
+/* adds offset to the counts of all events and the base count,
+ * which keeps the order of the events the same */
+void shift_interrupt_queue(struct interrupt_queue* q, unsigned int offset);
+
+static inline size_t interrupt_queue_bucket(int type)
+{
+    /* the event types are powers of two, multiplying them by
+     * a de Bruijn sequence puts each in a different bucket */
+    return (uint32_t)((uint32_t)type * UINT32_C(0x077CB531)) >> 27;
+}
+
+/* returns the first event of the given type, NULL when there is none */
+static inline struct node* find_interrupt_queue(const struct interrupt_queue* q, int type)
+{
+    struct node* e;
+    size_t bucket = interrupt_queue_bucket(type);
+
+    if (q->bucket_sizes[bucket] == 0) {
+        return NULL;
+    }
+
+    if (q->bucket_sizes[bucket] == 1)
+    {
+        e = q->buckets[bucket];
+        return (e->data.type == type) ? e : NULL;
+    }
+
+    /* there are more events in the bucket, which is rare,
+     * return the one of the given type which comes first */
+    for (e = q->first; e != NULL && e->data.type != type; e = e->next);
+
+    return e;
+}
+
+static inline const struct interrupt_event* first_interrupt_queue(const struct interrupt_queue* q)
+{
+    return (q->first != NULL)
+        ? &q->first->data
+        : NULL;
+}
+
+#endif /* M64P_DEVICE_R4300_INTERRUPT_QUEUE_H */
@@ -28,6 +28,8 @@
 #include "device/r4300/r4300_core.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "main/main.h"
+#include "main/rollback.h"
+#include "main/runahead.h"
 #include "plugin/plugin.h"
 
 unsigned int vi_clock_from_tv_standard(m64p_system_type tv_standard)
@@ -163,10 +165,16 @@ void write_vi_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
 void vi_vertical_interrupt_event(void* opaque)
 {
     struct vi_controller* vi = (struct vi_controller*)opaque;
-    if (vi->dp->do_on_unfreeze & DELAY_DP_INT)
-        vi->dp->do_on_unfreeze |= DELAY_UPDATESCREEN;
-    else
-        gfx.updateScreen();
+
+    /* frames which will be rolled back by run-ahead
+     * and frames which are resimulated aren't shown */
+    if (!runahead_is_video_silent() && !rollback_is_video_silent())
+    {
+        if (vi->dp->do_on_unfreeze & DELAY_DP_INT)
+            vi->dp->do_on_unfreeze |= DELAY_UPDATESCREEN;
+        else
+            gfx.updateScreen();
+    }
 
     /* allow main module to do things on VI event */
     new_vi();
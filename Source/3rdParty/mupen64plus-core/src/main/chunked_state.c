@@ -0,0 +1,561 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - chunked_state.c                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "chunked_state.h"
+#include "osal/files.h"
+#include "util.h"
+
+/* Container layout, all values are little endian:
+ *   magic         8 bytes
+ *   format        4 bytes
+ *   codec         4 bytes
+ *   chunk size    4 bytes
+ *   data size     4 bytes
+ *   chunk sizes   4 bytes for every chunk, 0 when the chunk only
+ *                 contains zeroes, the chunk size when the chunk
+ *                 is stored uncompressed
+ *   chunks        the compressed chunks */
+enum { CHUNKED_STATE_HEADER_SIZE = 24 };
+enum { CHUNKED_STATE_FORMAT = 1 };
+enum { CHUNKED_STATE_CHUNK_SIZE = 64 * 1024 };
+enum { CHUNKED_STATE_MAX_CHUNK_SIZE = 16 * 1024 * 1024 };
+enum { CHUNKED_STATE_MAX_THREADS = 8 };
+
+static const char* chunked_state_magic = "M64+CHNK";
+
+enum chunked_state_codec_id
+{
+    CHUNKED_STATE_CODEC_DEFLATE = 1
+};
+
+struct chunked_state_codec
+{
+    uint32_t id;
+    size_t (*bound)(size_t size);
+    /* both return 1 on success, dst_size is updated
+     * to the size of the compressed data */
+    int (*compress)(unsigned char *dst, size_t *dst_size, const unsigned char *src, size_t src_size);
+    int (*decompress)(unsigned char *dst, size_t dst_size, const unsigned char *src, size_t src_size);
+};
+
+struct chunked_state_job
+{
+    const struct chunked_state_codec *codec;
+    int compress;
+
+    unsigned char *data;
+    size_t data_size;
+    size_t chunk_size;
+    size_t chunk_count;
+
+    /* compressed chunks, when compressing each
+     * chunk has a slot of slot_size bytes */
+    unsigned char *chunks;
+    size_t slot_size;
+    size_t *offsets;
+    uint32_t *sizes;
+
+    SDL_atomic_t next_chunk;
+    SDL_atomic_t failed;
+};
+
+/* the worker threads are created when the first job runs
+ * and are kept around until chunked_state_deinit() */
+struct chunked_state_pool
+{
+    /* serializes jobs, states can be saved on the
+     * workqueue while another state is being loaded */
+    SDL_mutex *run_lock;
+
+    SDL_mutex *lock;
+    SDL_cond *work_avail;
+    SDL_cond *work_done;
+
+    SDL_Thread *threads[CHUNKED_STATE_MAX_THREADS];
+    size_t thread_count;
+
+    struct chunked_state_job *job;
+    /* amount of workers which still have to pick up the job */
+    size_t pending;
+    /* amount of workers which haven't finished the job yet */
+    size_t busy;
+    int quit;
+};
+
+static struct chunked_state_pool chunked_state_pool;
+
+static size_t deflate_bound(size_t size)
+{
+    return compressBound((uLong)size);
+}
+
+static int deflate_compress(unsigned char *dst, size_t *dst_size, const unsigned char *src, size_t src_size)
+{
+    uLongf size = (uLongf)*dst_size;
+
+    if (compress2(dst, &size, src, (uLong)src_size, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return 0;
+
+    *dst_size = (size_t)size;
+    return 1;
+}
+
+static int deflate_decompress(unsigned char *dst, size_t dst_size, const unsigned char *src, size_t src_size)
+{
+    uLongf size = (uLongf)dst_size;
+
+    return uncompress(dst, &size, src, (uLong)src_size) == Z_OK && size == dst_size;
+}
+
+static const struct chunked_state_codec chunked_state_codecs[] =
+{
+    { CHUNKED_STATE_CODEC_DEFLATE, deflate_bound, deflate_compress, deflate_decompress },
+};
+
+static const struct chunked_state_codec *chunked_state_find_codec(uint32_t id)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(chunked_state_codecs) / sizeof(chunked_state_codecs[0]); i++)
+    {
+        if (chunked_state_codecs[i].id == id)
+            return &chunked_state_codecs[i];
+    }
+
+    return NULL;
+}
+
+static int is_zero_chunk(const unsigned char *data, size_t size)
+{
+    return data[0] == 0 && memcmp(data, data + 1, size - 1) == 0;
+}
+
+static int chunked_state_compress_chunk(struct chunked_state_job *job, size_t i)
+{
+    unsigned char *data = job->data + i * job->chunk_size;
+    unsigned char *chunk = job->chunks + i * job->slot_size;
+    size_t size = job->data_size - i * job->chunk_size;
+    size_t compressed_size = job->slot_size;
+
+    if (size > job->chunk_size)
+        size = job->chunk_size;
+
+    if (is_zero_chunk(data, size))
+    {
+        job->sizes[i] = 0;
+        return 1;
+    }
+
+    if (!job->codec->compress(chunk, &compressed_size, data, size))
+        return 0;
+
+    /* store incompressible chunks as-is */
+    if (compressed_size >= size)
+    {
+        memcpy(chunk, data, size);
+        compressed_size = size;
+    }
+
+    job->sizes[i] = (uint32_t)compressed_size;
+    return 1;
+}
+
+static int chunked_state_decompress_chunk(struct chunked_state_job *job, size_t i)
+{
+    unsigned char *data = job->data + i * job->chunk_size;
+    const unsigned char *chunk = job->chunks + job->offsets[i];
+    size_t size = job->data_size - i * job->chunk_size;
+
+    if (size > job->chunk_size)
+        size = job->chunk_size;
+
+    if (job->sizes[i] == 0)
+    {
+        memset(data, 0, size);
+        return 1;
+    }
+
+    if (job->sizes[i] == size)
+    {
+        memcpy(data, chunk, size);
+        return 1;
+    }
+
+    return job->codec->decompress(data, size, chunk, job->sizes[i]);
+}
+
+static int chunked_state_worker(void *opaque)
+{
+    struct chunked_state_job *job = (struct chunked_state_job *)opaque;
+    size_t i;
+    int ret;
+
+    while (!SDL_AtomicGet(&job->failed))
+    {
+        i = (size_t)SDL_AtomicAdd(&job->next_chunk, 1);
+        if (i >= job->chunk_count)
+            break;
+
+        ret = job->compress ? chunked_state_compress_chunk(job, i)
+                            : chunked_state_decompress_chunk(job, i);
+        if (!ret)
+            SDL_AtomicSet(&job->failed, 1);
+    }
+
+    return 0;
+}
+
+static int chunked_state_pool_thread(void *opaque)
+{
+    struct chunked_state_pool *pool = (struct chunked_state_pool *)opaque;
+    struct chunked_state_job *job;
+
+    SDL_LockMutex(pool->lock);
+    for (;;)
+    {
+        while (!pool->quit && pool->pending == 0)
+            SDL_CondWait(pool->work_avail, pool->lock);
+
+        if (pool->quit)
+            break;
+
+        pool->pending--;
+        job = pool->job;
+        SDL_UnlockMutex(pool->lock);
+
+        chunked_state_worker(job);
+
+        SDL_LockMutex(pool->lock);
+        if (--pool->busy == 0)
+            SDL_CondSignal(pool->work_done);
+    }
+    SDL_UnlockMutex(pool->lock);
+
+    return 0;
+}
+
+/* creates the worker threads, one less than there are
+ * CPU cores because the calling thread helps as well */
+static void chunked_state_pool_start(struct chunked_state_pool *pool)
+{
+    size_t thread_count = (size_t)SDL_GetCPUCount();
+    size_t i;
+
+    if (thread_count > CHUNKED_STATE_MAX_THREADS)
+        thread_count = CHUNKED_STATE_MAX_THREADS;
+
+    /* when a thread can't be created, the
+     * remaining threads pick up its chunks */
+    for (i = 1; i < thread_count; i++)
+    {
+        pool->threads[pool->thread_count] = SDL_CreateThread(chunked_state_pool_thread, "StateChunks", pool);
+        if (pool->threads[pool->thread_count] != NULL)
+            pool->thread_count++;
+    }
+}
+
+/* processes all chunks of the job on the calling
+ * thread and the worker threads of the pool */
+static int chunked_state_run(struct chunked_state_job *job)
+{
+    struct chunked_state_pool *pool = &chunked_state_pool;
+    size_t worker_count;
+
+    SDL_AtomicSet(&job->next_chunk, 0);
+    SDL_AtomicSet(&job->failed, 0);
+
+    /* without a pool, only use the calling thread */
+    if (pool->run_lock == NULL)
+    {
+        chunked_state_worker(job);
+        return !SDL_AtomicGet(&job->failed);
+    }
+
+    SDL_LockMutex(pool->run_lock);
+
+    if (pool->thread_count == 0)
+        chunked_state_pool_start(pool);
+
+    /* the calling thread processes chunks as well */
+    worker_count = pool->thread_count;
+    if (worker_count >= job->chunk_count)
+        worker_count = job->chunk_count > 0 ? job->chunk_count - 1 : 0;
+
+    SDL_LockMutex(pool->lock);
+    pool->job = job;
+    pool->pending = worker_count;
+    pool->busy = worker_count;
+    SDL_CondBroadcast(pool->work_avail);
+    SDL_UnlockMutex(pool->lock);
+
+    chunked_state_worker(job);
+
+    SDL_LockMutex(pool->lock);
+    while (pool->busy != 0)
+        SDL_CondWait(pool->work_done, pool->lock);
+    pool->job = NULL;
+    SDL_UnlockMutex(pool->lock);
+
+    SDL_UnlockMutex(pool->run_lock);
+
+    return !SDL_AtomicGet(&job->failed);
+}
+
+void chunked_state_init(void)
+{
+    struct chunked_state_pool *pool = &chunked_state_pool;
+
+    memset(pool, 0, sizeof(*pool));
+
+    pool->run_lock = SDL_CreateMutex();
+    pool->lock = SDL_CreateMutex();
+    pool->work_avail = SDL_CreateCond();
+    pool->work_done = SDL_CreateCond();
+    if (pool->run_lock == NULL || pool->lock == NULL ||
+        pool->work_avail == NULL || pool->work_done == NULL)
+    {
+        DebugMessage(M64MSG_WARNING, "Could not create chunked state worker pool, states are compressed on a single thread");
+        chunked_state_deinit();
+    }
+}
+
+void chunked_state_deinit(void)
+{
+    struct chunked_state_pool *pool = &chunked_state_pool;
+    size_t i;
+
+    if (pool->lock != NULL && pool->work_avail != NULL)
+    {
+        SDL_LockMutex(pool->lock);
+        pool->quit = 1;
+        SDL_CondBroadcast(pool->work_avail);
+        SDL_UnlockMutex(pool->lock);
+    }
+
+    for (i = 0; i < pool->thread_count; i++)
+        SDL_WaitThread(pool->threads[i], NULL);
+
+    SDL_DestroyCond(pool->work_done);
+    SDL_DestroyCond(pool->work_avail);
+    SDL_DestroyMutex(pool->lock);
+    SDL_DestroyMutex(pool->run_lock);
+    memset(pool, 0, sizeof(*pool));
+}
+
+int chunked_state_probe(const char *filepath)
+{
+    char magic[8];
+    FILE *f;
+    int ret;
+
+    f = osal_file_open(filepath, "rb");
+    if (f == NULL)
+        return 0;
+
+    ret = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+          memcmp(magic, chunked_state_magic, sizeof(magic)) == 0;
+
+    fclose(f);
+    return ret;
+}
+
+int chunked_state_write(const char *filepath, const void *data, size_t size)
+{
+    struct chunked_state_job job;
+    unsigned char header[CHUNKED_STATE_HEADER_SIZE];
+    unsigned char *table = NULL;
+    FILE *f = NULL;
+    size_t i;
+    int ret = 0;
+
+    memset(&job, 0, sizeof(job));
+    job.codec = chunked_state_find_codec(CHUNKED_STATE_CODEC_DEFLATE);
+    job.compress = 1;
+    /* OK to cast away const qualifier, the data is only read when compressing */
+    job.data = (unsigned char *)data;
+    job.data_size = size;
+    job.chunk_size = CHUNKED_STATE_CHUNK_SIZE;
+    job.chunk_count = (size + job.chunk_size - 1) / job.chunk_size;
+    job.slot_size = job.codec->bound(job.chunk_size);
+
+    if (size == 0 || size > UINT32_MAX)
+    {
+        DebugMessage(M64MSG_ERROR, "Invalid size for chunked state: %zu", size);
+        return 0;
+    }
+
+    job.chunks = (unsigned char *)malloc(job.chunk_count * job.slot_size);
+    job.sizes = (uint32_t *)malloc(job.chunk_count * sizeof(uint32_t));
+    table = (unsigned char *)malloc(job.chunk_count * 4);
+    if (job.chunks == NULL || job.sizes == NULL || table == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Insufficient memory to compress state");
+        goto cleanup;
+    }
+
+    if (!chunked_state_run(&job))
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to compress state");
+        goto cleanup;
+    }
+
+    memcpy(header, chunked_state_magic, 8);
+    store_leu32(CHUNKED_STATE_FORMAT, header + 8);
+    store_leu32(job.codec->id, header + 12);
+    store_leu32((uint32_t)job.chunk_size, header + 16);
+    store_leu32((uint32_t)job.data_size, header + 20);
+
+    for (i = 0; i < job.chunk_count; i++)
+        store_leu32(job.sizes[i], table + i * 4);
+
+    f = osal_file_open(filepath, "wb");
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Could not open state file: %s", filepath);
+        goto cleanup;
+    }
+
+    if (fwrite(header, 1, sizeof(header), f) != sizeof(header) ||
+        fwrite(table, 1, job.chunk_count * 4, f) != job.chunk_count * 4)
+        goto write_error;
+
+    for (i = 0; i < job.chunk_count; i++)
+    {
+        if (fwrite(job.chunks + i * job.slot_size, 1, job.sizes[i], f) != job.sizes[i])
+            goto write_error;
+    }
+
+    if (fclose(f) != 0)
+    {
+        f = NULL;
+        goto write_error;
+    }
+
+    f = NULL;
+    ret = 1;
+    goto cleanup;
+
+write_error:
+    DebugMessage(M64MSG_ERROR, "Could not write data to state file: %s", filepath);
+cleanup:
+    if (f != NULL)
+        fclose(f);
+    free(table);
+    free(job.sizes);
+    free(job.chunks);
+    return ret;
+}
+
+int chunked_state_read(const char *filepath, void *data, size_t size)
+{
+    struct chunked_state_job job;
+    unsigned char *file = NULL;
+    size_t file_size = 0;
+    size_t offset;
+    size_t i;
+    int ret = 0;
+
+    if (load_file(filepath, (void **)&file, &file_size) != file_ok)
+    {
+        DebugMessage(M64MSG_ERROR, "Could not read state file: %s", filepath);
+        return 0;
+    }
+
+    memset(&job, 0, sizeof(job));
+
+    if (file_size < CHUNKED_STATE_HEADER_SIZE ||
+        memcmp(file, chunked_state_magic, 8) != 0 ||
+        load_leu32(file + 8) != CHUNKED_STATE_FORMAT)
+    {
+        DebugMessage(M64MSG_ERROR, "Unsupported chunked state: %s", filepath);
+        goto cleanup;
+    }
+
+    job.codec = chunked_state_find_codec(load_leu32(file + 12));
+    job.compress = 0;
+    job.data = (unsigned char *)data;
+    job.data_size = load_leu32(file + 20);
+    job.chunk_size = load_leu32(file + 16);
+
+    if (job.codec == NULL || job.data_size != size ||
+        job.chunk_size == 0 || job.chunk_size > CHUNKED_STATE_MAX_CHUNK_SIZE)
+    {
+        DebugMessage(M64MSG_ERROR, "Unsupported chunked state: %s", filepath);
+        goto cleanup;
+    }
+
+    job.chunk_count = (job.data_size + job.chunk_size - 1) / job.chunk_size;
+    if (file_size - CHUNKED_STATE_HEADER_SIZE < job.chunk_count * 4)
+    {
+        DebugMessage(M64MSG_ERROR, "Truncated chunked state: %s", filepath);
+        goto cleanup;
+    }
+
+    job.chunks = file + CHUNKED_STATE_HEADER_SIZE + job.chunk_count * 4;
+    job.sizes = (uint32_t *)malloc(job.chunk_count * sizeof(uint32_t));
+    job.offsets = (size_t *)malloc(job.chunk_count * sizeof(size_t));
+    if (job.sizes == NULL || job.offsets == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Insufficient memory to decompress state");
+        goto cleanup;
+    }
+
+    /* the chunks are stored back to back, so the
+     * offsets are known before decompressing them */
+    offset = 0;
+    for (i = 0; i < job.chunk_count; i++)
+    {
+        job.sizes[i] = load_leu32(file + CHUNKED_STATE_HEADER_SIZE + i * 4);
+        job.offsets[i] = offset;
+        offset += job.sizes[i];
+    }
+
+    if (offset > file_size - CHUNKED_STATE_HEADER_SIZE - job.chunk_count * 4)
+    {
+        DebugMessage(M64MSG_ERROR, "Truncated chunked state: %s", filepath);
+        goto cleanup;
+    }
+
+    if (!chunked_state_run(&job))
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to decompress state: %s", filepath);
+        goto cleanup;
+    }
+
+    ret = 1;
+
+cleanup:
+    free(job.offsets);
+    free(job.sizes);
+    free(file);
+    return ret;
+}
@@ -0,0 +1,51 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - chunked_state.h                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_CHUNKED_STATE_H
+#define M64P_MAIN_CHUNKED_STATE_H
+
+#include <stddef.h>
+
+/* The chunked state container splits a serialized state into fixed
+ * size chunks which are compressed independently, so they can be
+ * compressed and decompressed in parallel. Chunks which only contain
+ * zeroes (i.e unused RDRAM) are not stored at all. */
+
+/* creates the worker pool which (de)compresses the chunks,
+ * its threads are started when the first state is processed */
+void chunked_state_init(void);
+
+/* stops the worker threads and destroys the worker pool */
+void chunked_state_deinit(void);
+
+/* returns 1 when the given file is a chunked state container */
+int chunked_state_probe(const char *filepath);
+
+/* compresses size bytes of data into the given file,
+ * returns 1 on success, 0 on failure */
+int chunked_state_write(const char *filepath, const void *data, size_t size);
+
+/* decompresses the given file into data, the uncompressed
+ * size of the container must be exactly size bytes,
+ * returns 1 on success, 0 on failure */
+int chunked_state_read(const char *filepath, void *data, size_t size);
+
+#endif /* M64P_MAIN_CHUNKED_STATE_H */
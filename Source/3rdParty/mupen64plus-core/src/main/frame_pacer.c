@@ -0,0 +1,213 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - frame_pacer.c                                           *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <SDL.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "api/m64p_types.h"
+#include "frame_pacer.h"
+
+enum { FRAME_PACER_NS_PER_SECOND = 1000000000 };
+
+/* the last part of the wait is spent spinning,
+ * because sleeping may overshoot by about a millisecond */
+static const int64_t frame_pacer_spin_ns = 2000000;
+/* when emulation falls further behind than this,
+ * the deadline is dropped instead of catching up */
+static const int64_t frame_pacer_max_lag_ns = 50000000;
+/* the host display is only locked to when its refresh rate
+ * is within 2% of the refresh rate of the emulated display */
+static const double frame_pacer_max_display_deviation = 0.02;
+
+static int l_DisplayLock = 0;
+static int l_DisplayRefreshRate = 0;
+
+static int l_Started = 0;
+static int64_t l_Period = 0;
+static int64_t l_Deadline = 0;
+static int64_t l_LastFrame = 0;
+
+static SDL_mutex *l_TimingLock = NULL;
+static m64p_frame_timing l_Timing;
+
+static int64_t now_ns(void)
+{
+    uint64_t counter = SDL_GetPerformanceCounter();
+    uint64_t frequency = SDL_GetPerformanceFrequency();
+
+    /* split the conversion to avoid overflowing */
+    return (int64_t)((counter / frequency) * FRAME_PACER_NS_PER_SECOND +
+                     ((counter % frequency) * FRAME_PACER_NS_PER_SECOND) / frequency);
+}
+
+static int64_t frame_period(unsigned int refresh_rate, int speed_factor)
+{
+    double period = (double)FRAME_PACER_NS_PER_SECOND / refresh_rate;
+    double display_period;
+
+    if (l_DisplayLock && l_DisplayRefreshRate > 0 && speed_factor == 100)
+    {
+        display_period = (double)FRAME_PACER_NS_PER_SECOND * 1000.0 / l_DisplayRefreshRate;
+        if (display_period > period * (1.0 - frame_pacer_max_display_deviation) &&
+            display_period < period * (1.0 + frame_pacer_max_display_deviation))
+        {
+            period = display_period;
+        }
+    }
+
+    return (int64_t)(period * 100.0 / speed_factor);
+}
+
+/* sleeps until shortly before the deadline and spins for the rest */
+static int64_t wait_until(int64_t deadline)
+{
+    int64_t now = now_ns();
+
+    while (now < deadline)
+    {
+        if (deadline - now > frame_pacer_spin_ns)
+            SDL_Delay((Uint32)((deadline - now - frame_pacer_spin_ns) / 1000000));
+
+        now = now_ns();
+    }
+
+    return now;
+}
+
+void frame_pacer_startup(void)
+{
+    l_TimingLock = SDL_CreateMutex();
+}
+
+void frame_pacer_shutdown(void)
+{
+    SDL_DestroyMutex(l_TimingLock);
+    l_TimingLock = NULL;
+}
+
+void frame_pacer_init(int display_lock)
+{
+    l_DisplayLock = display_lock;
+    l_Started = 0;
+
+    if (l_TimingLock != NULL)
+        SDL_LockMutex(l_TimingLock);
+    memset(&l_Timing, 0, sizeof(l_Timing));
+    if (l_TimingLock != NULL)
+        SDL_UnlockMutex(l_TimingLock);
+}
+
+void frame_pacer_reset(void)
+{
+    l_Started = 0;
+}
+
+void frame_pacer_new_frame(unsigned int refresh_rate, int speed_factor, int limit)
+{
+    int64_t period = frame_period(refresh_rate, speed_factor);
+    int64_t now = now_ns();
+    int64_t duration;
+    int64_t deviation;
+    int late = 0;
+    int resync = 0;
+
+    /* start over when the speed changes, so the
+     * new speed doesn't have to make up for the old one */
+    if (!l_Started || period != l_Period)
+    {
+        l_Started = 1;
+        l_Period = period;
+        l_Deadline = now + period;
+        l_LastFrame = now;
+        return;
+    }
+
+    if (!limit)
+    {
+        l_Deadline = now;
+    }
+    else if (now - l_Deadline > frame_pacer_max_lag_ns)
+    {
+        l_Deadline = now;
+        resync = 1;
+    }
+    else if (now > l_Deadline)
+    {
+        late = 1;
+    }
+    else
+    {
+        now = wait_until(l_Deadline);
+    }
+
+    duration = now - l_LastFrame;
+    deviation = duration > period ? duration - period : period - duration;
+
+    if (l_TimingLock != NULL)
+        SDL_LockMutex(l_TimingLock);
+
+    l_Timing.frame_count++;
+    l_Timing.late_frames += late;
+    l_Timing.resyncs += resync;
+    l_Timing.target_ns = (unsigned long long)period;
+    l_Timing.last_ns = (unsigned long long)duration;
+    l_Timing.error_ns = now - l_Deadline;
+    /* exponential moving averages over about 16 frames */
+    if (l_Timing.frame_count == 1)
+    {
+        l_Timing.average_ns = (unsigned long long)duration;
+        l_Timing.jitter_ns = (unsigned long long)deviation;
+    }
+    else
+    {
+        l_Timing.average_ns = (l_Timing.average_ns * 15 + (unsigned long long)duration) / 16;
+        l_Timing.jitter_ns = (l_Timing.jitter_ns * 15 + (unsigned long long)deviation) / 16;
+    }
+
+    if (l_TimingLock != NULL)
+        SDL_UnlockMutex(l_TimingLock);
+
+    /* deadlines are advanced by the period instead of
+     * being derived from the current time, so the
+     * error of one frame doesn't carry over to the next */
+    l_Deadline += period;
+    l_LastFrame = now;
+}
+
+void frame_pacer_set_display_refresh_rate(int millihertz)
+{
+    l_DisplayRefreshRate = millihertz;
+}
+
+int frame_pacer_get_display_refresh_rate(void)
+{
+    return l_DisplayRefreshRate;
+}
+
+void frame_pacer_get_timing(m64p_frame_timing *timing)
+{
+    if (l_TimingLock != NULL)
+        SDL_LockMutex(l_TimingLock);
+    *timing = l_Timing;
+    if (l_TimingLock != NULL)
+        SDL_UnlockMutex(l_TimingLock);
+}
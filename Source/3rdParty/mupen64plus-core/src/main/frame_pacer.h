@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - frame_pacer.h                                           *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_FRAME_PACER_H
+#define M64P_MAIN_FRAME_PACER_H
+
+#include "api/m64p_types.h"
+
+/* The frame pacer keeps emulation at the speed of the emulated display.
+ * It uses a monotonic nanosecond clock and sleeps until shortly before
+ * the deadline of a frame, the remaining time is spent spinning. */
+
+/* creates and destroys the lock of the timing statistics,
+ * which can be queried by the frontend at any time */
+void frame_pacer_startup(void);
+void frame_pacer_shutdown(void);
+
+/* resets the pacer and the timing statistics for a new run */
+void frame_pacer_init(int display_lock);
+
+/* drops the current deadline, i.e after pausing */
+void frame_pacer_reset(void);
+
+/* paces a frame, refresh_rate is the refresh rate of the emulated
+ * display and speed_factor the emulation speed in percent,
+ * when limit is 0, the frame is only measured */
+void frame_pacer_new_frame(unsigned int refresh_rate, int speed_factor, int limit);
+
+/* the refresh rate of the host display in millihertz,
+ * 0 when unknown. When locking to the display is enabled and the
+ * refresh rate is close to the emulated one, frames are paced at
+ * the refresh rate of the host display */
+void frame_pacer_set_display_refresh_rate(int millihertz);
+int frame_pacer_get_display_refresh_rate(void);
+
+void frame_pacer_get_timing(m64p_frame_timing *timing);
+
+#endif /* M64P_MAIN_FRAME_PACER_H */
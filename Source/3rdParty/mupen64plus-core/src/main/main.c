@@ -65,6 +65,7 @@
 #include "device/gb/gb_cart.h"
 #include "device/pif/bootrom_hle.h"
 #include "eventloop.h"
+#include "frame_pacer.h"
 #include "main.h"
 #include "osal/files.h"
 #include "osal/preproc.h"
@@ -74,6 +75,8 @@
 #include "profile.h"
 #endif
 #include "rom.h"
+#include "rollback.h"
+#include "runahead.h"
 #include "savestates.h"
 #include "screenshot.h"
 #include "util.h"
@@ -439,6 +442,9 @@ int main_set_core_defaults(void)
     ConfigSetDefaultString(g_CoreConfig, "GbCameraVideoCaptureBackend1", DEFAULT_VIDEO_CAPTURE_BACKEND, "Gameboy Camera Video Capture backend");
     ConfigSetDefaultInt(g_CoreConfig, "SaveDiskFormat", 1, "Disk Save Format (0: Full Disk Copy (*.ndr/*.d6r), 1: RAM Area Only (*.ram))");
     ConfigSetDefaultInt(g_CoreConfig, "SaveFilenameFormat", 1, "Save (SRAM/State) Filename Format (0: ROM Header Name, 1: Automatic (including partial MD5 hash))");
+    ConfigSetDefaultBool(g_CoreConfig, "FramePacingDisplayLock", 0, "Pace frames at the refresh rate of the display when it's within 2% of the refresh rate of the game");
+    ConfigSetDefaultInt(g_CoreConfig, "NetplayRollbackFrames", 0, "Amount of frames to roll back during netplay instead of waiting for late inputs (0: wait for inputs)");
+    ConfigSetDefaultInt(g_CoreConfig, "NetplaySyncHashInterval", 0, "Send hashes of the emulated state to the netplay server every this many VIs to detect desyncs (0: disabled)");
 
     /* handle upgrades */
     if (bUpgrade)
@@ -729,6 +735,9 @@ m64p_error main_core_state_query(m64p_core_param param, int *rval)
         case M64CORE_INPUT_GAMESHARK:
             *rval = event_gameshark_active();
             break;
+        case M64CORE_DISPLAY_REFRESH_RATE:
+            *rval = frame_pacer_get_display_refresh_rate();
+            break;
         // these are only used for callbacks; they cannot be queried or set
         case M64CORE_SCREENSHOT_CAPTURED:
         case M64CORE_STATE_LOADCOMPLETE:
@@ -825,6 +834,11 @@ m64p_error main_core_state_set(m64p_core_param param, int val)
                 return M64ERR_INVALID_STATE;
             event_set_gameshark(val);
             return M64ERR_SUCCESS;
+        case M64CORE_DISPLAY_REFRESH_RATE:
+            if (val < 0)
+                return M64ERR_INPUT_INVALID;
+            frame_pacer_set_display_refresh_rate(val);
+            return M64ERR_SUCCESS;
         // these are only used for callbacks; they cannot be queried or set
         case M64CORE_STATE_LOADCOMPLETE:
         case M64CORE_STATE_SAVECOMPLETE:
@@ -948,6 +962,11 @@ static void video_plugin_render_callback(int bScreenRedrawn)
 
 void new_frame(void)
 {
+    /* frames ahead are rolled back and resimulated
+     * frames have been counted already */
+    if (runahead_is_ahead() || rollback_is_resimulating())
+        return;
+
     if (g_FrameCallback != NULL)
         (*g_FrameCallback)(l_CurrentFrame);
 
@@ -963,32 +982,6 @@ void new_frame(void)
 
 static void apply_speed_limiter(void)
 {
-    static unsigned long totalVIs = 0;
-    static int resetOnce = 0;
-    static int lastSpeedFactor = 100;
-    static unsigned int StartFPSTime = 0;
-    static const double defaultSpeedFactor = 100.0;
-    unsigned int CurrentFPSTime = SDL_GetTicks();
-
-    // calculate frame duration based upon ROM setting (50/60hz) and mupen64plus speed adjustment
-    const double VILimitMilliseconds = 1000.0 / g_dev.vi.expected_refresh_rate;
-    const double SpeedFactorMultiple = defaultSpeedFactor/l_SpeedFactor;
-    const double AdjustedLimit = VILimitMilliseconds * SpeedFactorMultiple;
-
-    //if this is the first time or we are resuming from pause
-    if(StartFPSTime == 0 || !resetOnce || lastSpeedFactor != l_SpeedFactor)
-    {
-       StartFPSTime = CurrentFPSTime;
-       totalVIs = 0;
-       resetOnce = 1;
-    }
-    else
-    {
-        ++totalVIs;
-    }
-
-    lastSpeedFactor = l_SpeedFactor;
-
 #if defined(PROFILE)
     timed_section_start(TIMED_SECTION_IDLE);
 #endif
@@ -997,33 +990,7 @@ static void apply_speed_limiter(void)
     if(g_DebuggerActive) DebuggerCallback(DEBUG_UI_VI, 0);
 #endif
 
-    double totalElapsedGameTime = AdjustedLimit*totalVIs;
-    double elapsedRealTime = CurrentFPSTime - StartFPSTime;
-    double sleepTime = totalElapsedGameTime - elapsedRealTime;
-
-    //Reset if the sleep needed is an unreasonable value
-    static const double minSleepNeeded = -50;
-    static const double maxSleepNeeded = 50;
-    if(sleepTime < minSleepNeeded || sleepTime > (maxSleepNeeded*SpeedFactorMultiple))
-    {
-       resetOnce = 0;
-    }
-
-    if (sleepTime < minSleepNeeded) {
-        totalVIs += (unsigned long)(minSleepNeeded/AdjustedLimit);
-    }
-
-    if(l_MainSpeedLimit && sleepTime > 0 && sleepTime < maxSleepNeeded*SpeedFactorMultiple)
-    {
-        while(sleepTime >= 0) {
-            SDL_Delay((unsigned int) sleepTime);
-
-            CurrentFPSTime = SDL_GetTicks();
-            elapsedRealTime = CurrentFPSTime - StartFPSTime;
-            sleepTime = totalElapsedGameTime - elapsedRealTime;
-        }
-    }
-
+    frame_pacer_new_frame(g_dev.vi.expected_refresh_rate, l_SpeedFactor, l_MainSpeedLimit);
 
 #if defined(PROFILE)
     timed_section_end(TIMED_SECTION_IDLE);
@@ -1058,6 +1025,9 @@ static void pause_loop(void)
             SDL_Delay(10);
             main_check_inputs();
         }
+
+        /* don't make up for the time spent paused */
+        frame_pacer_reset();
     }
 }
 
@@ -1071,10 +1041,17 @@ void new_vi(void)
 
     gs_apply_cheats(&g_cheat_ctx);
 
-    apply_speed_limiter();
+    runahead_new_vi();
+    rollback_new_vi();
+
+    /* frames ahead and resimulated frames are emulated as fast
+     * as possible and only pause on frames which aren't rolled back */
+    if (!runahead_is_ahead() && !rollback_is_resimulating())
+        apply_speed_limiter();
     main_check_inputs();
 
-    pause_loop();
+    if (!runahead_is_ahead() && !rollback_is_resimulating())
+        pause_loop();
 
     netplay_check_sync(&g_dev.r4300.cp0);
 }
@@ -1352,6 +1329,7 @@ static int load_dd_disk(struct dd_disk* dd_disk, const struct storage_backend_in
         fstorage_save->data = fstorage->data;
         fstorage_save->size = fstorage->size;
         fstorage_save->first_access = 1;
+        fstorage_save->writer = NULL;
         break;
     case 1: /* RAM only */
         *dd_idisk = &g_istorage_disk_ram_only;
@@ -1359,6 +1337,7 @@ static int load_dd_disk(struct dd_disk* dd_disk, const struct storage_backend_in
         fstorage_save->data = &fstorage->data[offset_ram];
         fstorage_save->size = size_ram;
         fstorage_save->first_access = 1;
+        fstorage_save->writer = NULL;
         break;
     default: /* read only */
         *dd_idisk = &g_istorage_disk_read_only;
@@ -1425,6 +1404,7 @@ static void close_dd_disk(struct dd_disk* disk)
 {
     if (disk->save_storage != NULL) {
         /* no need to close save_storage as it is a child of disk->storage */
+        flush_file_storage(disk->save_storage);
         free(disk->save_storage);
         disk->save_storage = NULL;
     }
@@ -1766,7 +1746,6 @@ m64p_error main_run(void)
             cin_compats[i].last_pak_type = Controls[i].Plugin;
             cin_compats[i].last_input = 0;
             cin_compats[i].netplay_count = 0;
-            cin_compats[i].event_first = NULL;
 
             Controls[i].Plugin = PLUGIN_NONE;
 
@@ -1794,7 +1773,6 @@ m64p_error main_run(void)
             cin_compats[i].last_pak_type = Controls[i].Plugin;
             cin_compats[i].last_input = 0;
             cin_compats[i].netplay_count = 0;
-            cin_compats[i].event_first = NULL;
 
             l_gb_carts_data[i].control_id = (int)i;
 
@@ -1965,6 +1943,10 @@ m64p_error main_run(void)
     /* Startup message on the OSD */
     osd_new_message(OSD_MIDDLE_CENTER, "Mupen64Plus Started...");
 
+    runahead_init(ROM_SETTINGS.runahead);
+    rollback_init(ConfigGetParamInt(g_CoreConfig, "NetplayRollbackFrames"));
+    frame_pacer_init(ConfigGetParamBool(g_CoreConfig, "FramePacingDisplayLock"));
+
     g_EmulatorRunning = 1;
     StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
 
@@ -2013,6 +1995,11 @@ m64p_error main_run(void)
 
     // clean up
     g_EmulatorRunning = 0;
+    // discard pending memory state jobs, their buffers
+    // aren't guaranteed to be valid after this point
+    savestates_set_memory_job(savestates_job_nothing, NULL);
+    runahead_deinit();
+    rollback_deinit();
     StateChanged(M64CORE_EMU_STATE, M64EMU_STOPPED);
 
     return M64ERR_SUCCESS;
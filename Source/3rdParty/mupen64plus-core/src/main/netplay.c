@@ -23,13 +23,18 @@
 
 #define M64P_CORE_PROTOTYPES 1
 #include "api/callbacks.h"
+#include "api/m64p_config.h"
 #include "main.h"
 #include "util.h"
 #include "plugin/plugin.h"
 #include "backends/plugins_compat/plugins_compat.h"
 #include "netplay.h"
+#include "rollback.h"
 
+#include <inttypes.h>
 #include <SDL_net.h>
+#define XXH_INLINE_ALL
+#include <xxhash.h>
 #if !defined(WIN32)
 #include <netinet/ip.h>
 #endif
@@ -50,12 +55,71 @@ static uint8_t l_plugin[4];
 static uint8_t l_buffer_target;
 static uint8_t l_player_lag[4];
 
+//Events received from the server are stored at their count modulo the capacity,
+//events which don't fit yet are dropped, the server sends them again once we request them
+#define NETPLAY_EVENT_CAPACITY 256
+
+struct netplay_event {
+    uint32_t count;
+    uint32_t buttons;
+    uint8_t plugin;
+    uint8_t valid;
+};
+
+static struct netplay_event l_events[4][NETPLAY_EVENT_CAPACITY];
+static uint32_t l_event_count[4];
+
+//Rollback, inputs which haven't been confirmed by the server yet are predicted
+#define NETPLAY_HISTORY_SIZE 1024
+
+struct netplay_input {
+    uint32_t count;
+    uint32_t buttons;
+    uint8_t plugin;
+    uint8_t confirmed;
+};
+
+static struct netplay_input l_input_history[4][NETPLAY_HISTORY_SIZE];
+static uint32_t l_confirmed_count[4]; //oldest event count which hasn't been confirmed
+static uint32_t l_send_count[4]; //next event count to send our input for
+
+//State hashes, RDRAM is hashed in 1MB regions, followed by the other regions below
+#define NETPLAY_RDRAM_HASH_REGIONS 8
+enum {
+    NETPLAY_HASH_DMEM = NETPLAY_RDRAM_HASH_REGIONS,
+    NETPLAY_HASH_IMEM,
+    NETPLAY_HASH_R4300_REGS,
+    NETPLAY_HASH_RSP_REGS,
+    NETPLAY_HASH_RDP_REGS,
+    NETPLAY_HASH_INTERFACE_REGS,
+    NETPLAY_HASH_COUNT
+};
+
+static uint32_t l_sync_hash_interval;
+
+//with rollback, sync data is only sent once the inputs it depends on have been confirmed
+//pending sync data is kept in VI order, so it's sent in the order it was generated
+#define NETPLAY_PENDING_SYNC_CAPACITY 64
+struct netplay_sync {
+    uint32_t vi_counter;
+    uint32_t counts[4];
+    UDPpacket *packet;
+    int32_t len;
+    uint8_t data[(CP0_REGS_COUNT * 4) + 5];
+};
+
+static struct netplay_sync l_pending_syncs[NETPLAY_PENDING_SYNC_CAPACITY];
+static uint32_t l_pending_sync_head;
+static uint32_t l_pending_sync_count;
+
 //UDP packets
 static UDPpacket *l_request_input_packet;
 static UDPpacket *l_send_input_packet;
 static UDPpacket *l_process_packet;
 static UDPpacket *l_check_sync_packet;
+static UDPpacket *l_sync_hash_packet;
 static const int32_t l_check_sync_packet_size = (CP0_REGS_COUNT * 4) + 5;
+static const int32_t l_sync_hash_packet_size = (NETPLAY_HASH_COUNT * 8) + 6;
 
 //UDP packet formats
 #define UDP_SEND_KEY_INFO 0
@@ -63,6 +127,7 @@ static const int32_t l_check_sync_packet_size = (CP0_REGS_COUNT * 4) + 5;
 #define UDP_REQUEST_KEY_INFO 2
 #define UDP_RECEIVE_KEY_INFO_GRATUITOUS 3
 #define UDP_SYNC_DATA 4
+#define UDP_SYNC_HASH 5
 
 //TCP packet formats
 #define TCP_SEND_SAVE 1
@@ -126,10 +191,12 @@ m64p_error netplay_start(const char* host, int port)
     l_send_input_packet = SDLNet_AllocPacket(11);
     l_process_packet = SDLNet_AllocPacket(512);
     l_check_sync_packet = SDLNet_AllocPacket(l_check_sync_packet_size);
+    l_sync_hash_packet = SDLNet_AllocPacket(l_sync_hash_packet_size);
     if (l_request_input_packet == NULL ||
         l_send_input_packet == NULL ||
         l_process_packet == NULL ||
-        l_check_sync_packet == NULL)
+        l_check_sync_packet == NULL ||
+        l_sync_hash_packet == NULL)
     {
         DebugMessage(M64MSG_ERROR, "Netplay: could not allocate UDP packets");
         SDLNet_UDP_Close(l_udpSocket);
@@ -144,6 +211,8 @@ m64p_error netplay_start(const char* host, int port)
         l_process_packet = NULL;
         SDLNet_FreePacket(l_check_sync_packet);
         l_check_sync_packet = NULL;
+        SDLNet_FreePacket(l_sync_hash_packet);
+        l_sync_hash_packet = NULL;
         return M64ERR_NO_MEMORY;
     }
 
@@ -171,21 +240,6 @@ m64p_error netplay_stop()
         return M64ERR_INVALID_STATE;
     else
     {
-        if (l_cin_compats != NULL)
-        {
-            for (int i = 0; i < 4; ++i)
-            {
-                struct netplay_event* current = l_cin_compats[i].event_first;
-                struct netplay_event* next;
-                while (current != NULL)
-                {
-                    next = current->next;
-                    free(current);
-                    current = next;
-                }
-            }
-        }
-
         char output_data[5];
         output_data[0] = TCP_DISCONNECT_NOTICE;
         SDLNet_Write32(l_reg_id, &output_data[1]);
@@ -202,10 +256,12 @@ m64p_error netplay_stop()
         SDLNet_FreePacket(l_send_input_packet);
         SDLNet_FreePacket(l_process_packet);
         SDLNet_FreePacket(l_check_sync_packet);
+        SDLNet_FreePacket(l_sync_hash_packet);
         l_request_input_packet = NULL;
         l_send_input_packet = NULL;
         l_process_packet = NULL;
         l_check_sync_packet = NULL;
+        l_sync_hash_packet = NULL;
     
         l_netplay_is_init = 0;
         SDLNet_Quit();
@@ -221,14 +277,30 @@ int netplay_is_init()
 static uint8_t buffer_size(uint8_t control_id)
 {
     //This function returns the size of the local input buffer
-    uint8_t counter = 0;
-    struct netplay_event* current = l_cin_compats[control_id].event_first;
-    while (current != NULL)
-    {
-        current = current->next;
-        ++counter;
-    }
-    return counter;
+    if (l_event_count[control_id] > UINT8_MAX)
+        return UINT8_MAX;
+    return (uint8_t)l_event_count[control_id];
+}
+
+static int count_before(uint32_t count, uint32_t other)
+{
+    //Returns 1 if the event count comes before the other one
+    return (count - other) > (UINT32_MAX / 2);
+}
+
+static uint32_t needed_count(uint8_t control_id)
+{
+    //This function returns the oldest event count we still need from the server
+    //With rollback, predicted inputs are needed until they have been confirmed
+    if (rollback_is_enabled())
+        return l_confirmed_count[control_id];
+    return l_cin_compats[control_id].netplay_count;
+}
+
+static int is_confirmed(uint8_t control_id, uint32_t count)
+{
+    struct netplay_input* input = &l_input_history[control_id][count % NETPLAY_HISTORY_SIZE];
+    return rollback_is_enabled() && input->confirmed && input->count == count;
 }
 
 static void netplay_request_input(uint8_t control_id)
@@ -236,7 +308,7 @@ static void netplay_request_input(uint8_t control_id)
     l_request_input_packet->data[0] = UDP_REQUEST_KEY_INFO;
     l_request_input_packet->data[1] = control_id; //The player we need input for
     SDLNet_Write32(l_reg_id, &l_request_input_packet->data[2]); //our registration ID
-    SDLNet_Write32(l_cin_compats[control_id].netplay_count, &l_request_input_packet->data[6]); //the current event count
+    SDLNet_Write32(needed_count(control_id), &l_request_input_packet->data[6]); //the current event count
     l_request_input_packet->data[10] = l_spectator; //whether we are a spectator
     l_request_input_packet->data[11] = buffer_size(control_id); //our local buffer size
     l_request_input_packet->len = 12;
@@ -246,14 +318,8 @@ static void netplay_request_input(uint8_t control_id)
 static int check_valid(uint8_t control_id, uint32_t count)
 {
     //Check if we already have this event recorded locally, returns 1 if we do
-    struct netplay_event* current = l_cin_compats[control_id].event_first;
-    while (current != NULL)
-    {
-        if (current->count == count) //event already recorded
-            return 1;
-        current = current->next;
-    }
-    return 0;
+    struct netplay_event* event = &l_events[control_id][count % NETPLAY_EVENT_CAPACITY];
+    return event->valid && event->count == count;
 }
 
 static int netplay_require_response(void* opaque)
@@ -264,7 +330,7 @@ static int netplay_require_response(void* opaque)
     //After 10 seconds a timeout occurs, we assume we have lost connection to the server.
     uint8_t control_id = *(uint8_t*)opaque;
     uint32_t timeout = SDL_GetTicks() + 10000;
-    while (!check_valid(control_id, l_cin_compats[control_id].netplay_count))
+    while (!check_valid(control_id, needed_count(control_id)))
     {
         if (SDL_GetTicks() > timeout)
         {
@@ -306,14 +372,15 @@ static void netplay_process()
                     l_status = current_status;
                 }
                 curr = 5;
-                //this loop processes input data from the server, inserting new events into the linked list for each player
+                //this loop processes input data from the server, storing new events in the buffer of each player
                 //it skips events that we have already recorded, or if we receive data for an event that has already happened
                 for (uint8_t i = 0; i < l_process_packet->data[4]; ++i)
                 {
                     count = SDLNet_Read32(&l_process_packet->data[curr]);
                     curr += 4;
 
-                    if (((count - l_cin_compats[player].netplay_count) > (UINT32_MAX / 2)) || (check_valid(player, count))) //event doesn't need to be recorded
+                    if (count_before(count, needed_count(player)) || !count_before(count, needed_count(player) + NETPLAY_EVENT_CAPACITY) ||
+                        check_valid(player, count) || is_confirmed(player, count)) //event doesn't need to be recorded, or doesn't fit yet
                     {
                         curr += 5;
                         continue;
@@ -324,13 +391,14 @@ static void netplay_process()
                     plugin = l_process_packet->data[curr];
                     curr += 1;
 
-                    //insert new event at beginning of linked list
-                    struct netplay_event* new_event = (struct netplay_event*)malloc(sizeof(struct netplay_event));
-                    new_event->count = count;
-                    new_event->buttons = keys;
-                    new_event->plugin = plugin;
-                    new_event->next = l_cin_compats[player].event_first;
-                    l_cin_compats[player].event_first = new_event;
+                    //store the new event in its slot, any event left in there is outdated
+                    struct netplay_event* event = &l_events[player][count % NETPLAY_EVENT_CAPACITY];
+                    if (!event->valid)
+                        ++l_event_count[player];
+                    event->count = count;
+                    event->buttons = keys;
+                    event->plugin = plugin;
+                    event->valid = 1;
                 }
                 break;
             default:
@@ -344,7 +412,7 @@ static int netplay_ensure_valid(uint8_t control_id)
 {
     //This function makes sure we have data for a certain event
     //If we don't have the data, it will create a new thread that will request the data
-    if (check_valid(control_id, l_cin_compats[control_id].netplay_count))
+    if (check_valid(control_id, needed_count(control_id)))
         return 1;
 
     if (l_udpChannel == -1)
@@ -352,7 +420,7 @@ static int netplay_ensure_valid(uint8_t control_id)
 
     SDL_Thread* thread = SDL_CreateThread(netplay_require_response, "Netplay key request", &control_id);
 
-    while (!check_valid(control_id, l_cin_compats[control_id].netplay_count) && l_udpChannel != -1)
+    while (!check_valid(control_id, needed_count(control_id)) && l_udpChannel != -1)
         netplay_process();
     int success;
     SDL_WaitThread(thread, &success);
@@ -361,26 +429,201 @@ static int netplay_ensure_valid(uint8_t control_id)
 
 static void netplay_delete_event(struct netplay_event* current, uint8_t control_id)
 {
-    //This function deletes an event from the linked list
-    struct netplay_event* find = l_cin_compats[control_id].event_first;
-    while (find != NULL)
+    //This function removes an event from the buffer
+    current->valid = 0;
+    --l_event_count[control_id];
+}
+
+static struct netplay_event* netplay_find_event(uint8_t control_id, uint32_t count)
+{
+    if (!check_valid(control_id, count))
+        return NULL;
+    return &l_events[control_id][count % NETPLAY_EVENT_CAPACITY];
+}
+
+static void netplay_store_input(uint8_t control_id, uint32_t count, uint32_t buttons, uint8_t plugin, uint8_t confirmed)
+{
+    struct netplay_input* input = &l_input_history[control_id][count % NETPLAY_HISTORY_SIZE];
+    input->count = count;
+    input->buttons = buttons;
+    input->plugin = plugin;
+    input->confirmed = confirmed;
+}
+
+static int netplay_sync_confirmed(const struct netplay_sync* sync)
+{
+    for (int i = 0; i < 4; ++i)
     {
-        if (find->next == current)
-        {
-            find->next = current->next;
+        if (Controls[i].Present && count_before(l_confirmed_count[i], sync->counts[i]))
+            return 0;
+    }
+    return 1;
+}
+
+static struct netplay_sync* netplay_pending_sync(uint32_t index)
+{
+    return &l_pending_syncs[(l_pending_sync_head + index) % NETPLAY_PENDING_SYNC_CAPACITY];
+}
+
+static void netplay_queue_sync(UDPpacket* packet)
+{
+    struct netplay_sync* sync;
+
+    if (!rollback_is_enabled())
+    {
+        SDLNet_UDP_Send(l_udpSocket, l_udpChannel, packet);
+        return;
+    }
+
+    //After a rollback, the VIs since are emulated again, so drop what was queued for them
+    while (l_pending_sync_count > 0 && !count_before(netplay_pending_sync(l_pending_sync_count - 1)->vi_counter, l_vi_counter))
+        --l_pending_sync_count;
+
+    if (l_pending_sync_count == NETPLAY_PENDING_SYNC_CAPACITY)
+    {
+        DebugMessage(M64MSG_WARNING, "Netplay: dropping sync data of VI %u", netplay_pending_sync(0)->vi_counter);
+        l_pending_sync_head = (l_pending_sync_head + 1) % NETPLAY_PENDING_SYNC_CAPACITY;
+        --l_pending_sync_count;
+    }
+
+    //This VI might still be rolled back, so we hold on to the data until its inputs have been confirmed
+    sync = netplay_pending_sync(l_pending_sync_count++);
+    sync->vi_counter = l_vi_counter;
+    for (int i = 0; i < 4; ++i)
+        sync->counts[i] = l_cin_compats[i].netplay_count;
+    sync->packet = packet;
+    sync->len = packet->len;
+    memcpy(sync->data, packet->data, packet->len);
+}
+
+static void netplay_send_pending_sync()
+{
+    struct netplay_sync* sync;
+
+    //The event counts only increase with the VI, so the sync data is confirmed in order
+    while (l_pending_sync_count > 0)
+    {
+        sync = netplay_pending_sync(0);
+        if (!netplay_sync_confirmed(sync))
             break;
+
+        memcpy(sync->packet->data, sync->data, sync->len);
+        sync->packet->len = sync->len;
+        SDLNet_UDP_Send(l_udpSocket, l_udpChannel, sync->packet);
+
+        l_pending_sync_head = (l_pending_sync_head + 1) % NETPLAY_PENDING_SYNC_CAPACITY;
+        --l_pending_sync_count;
+    }
+}
+
+static void netplay_confirm_inputs(uint8_t control_id)
+{
+    //This function confirms the inputs we have used already, in order
+    //When the server disagrees with what we predicted, we roll back to the frame that used the input
+    struct netplay_input* input;
+    struct netplay_event* current;
+    uint32_t count;
+    while (count_before(l_confirmed_count[control_id], l_cin_compats[control_id].netplay_count))
+    {
+        count = l_confirmed_count[control_id];
+        input = &l_input_history[control_id][count % NETPLAY_HISTORY_SIZE];
+        if (!input->confirmed || input->count != count)
+        {
+            current = netplay_find_event(control_id, count);
+            if (current == NULL)
+                break;
+
+            if (input->count != count || input->buttons != current->buttons || input->plugin != current->plugin)
+            {
+                rollback_request(control_id, count);
+                //the states we were going to send from here on depend on the misprediction
+                while (l_pending_sync_count > 0 && count_before(count, netplay_pending_sync(l_pending_sync_count - 1)->counts[control_id]))
+                    --l_pending_sync_count;
+            }
+
+            netplay_store_input(control_id, count, current->buttons, current->plugin, 1);
+            netplay_delete_event(current, control_id);
+        }
+        ++l_confirmed_count[control_id];
+    }
+
+    netplay_send_pending_sync();
+}
+
+static int netplay_wait_confirmed_count(uint8_t control_id, uint32_t count)
+{
+    //This function waits until all inputs before the given event count have been confirmed
+    for (;;)
+    {
+        netplay_confirm_inputs(control_id);
+        if (!count_before(l_confirmed_count[control_id], count))
+            return 1;
+        if (!netplay_ensure_valid(control_id))
+            return 0;
+    }
+}
+
+static void netplay_lost_connection()
+{
+    DebugMessage(M64MSG_ERROR, "Netplay: lost connection to server");
+    main_core_state_set(M64CORE_EMU_STATE, M64EMU_STOPPED);
+}
+
+static uint32_t netplay_get_rollback_input(uint8_t control_id)
+{
+    uint32_t count = l_cin_compats[control_id].netplay_count;
+    struct netplay_input* input = &l_input_history[control_id][count % NETPLAY_HISTORY_SIZE];
+    struct netplay_input* previous;
+    struct netplay_event* current;
+
+    //We can only predict inputs when we're able to roll back to the frame using them,
+    //and while there's room to keep them around until they have been confirmed
+    if (!rollback_can_roll_back())
+    {
+        if (!netplay_wait_confirmed_count(control_id, count) || !netplay_ensure_valid(control_id))
+        {
+            netplay_lost_connection();
+            return 0;
         }
-        find = find->next;
     }
-    if (current == l_cin_compats[control_id].event_first)
-        l_cin_compats[control_id].event_first = l_cin_compats[control_id].event_first->next;
-    free(current);
+    else if (!netplay_wait_confirmed_count(control_id, count - NETPLAY_HISTORY_SIZE + 1))
+    {
+        netplay_lost_connection();
+        return 0;
+    }
+
+    //Confirmed inputs are used as is, this is the case when we're resimulating frames
+    if (!input->confirmed || input->count != count)
+    {
+        current = netplay_find_event(control_id, count);
+        if (current != NULL)
+        {
+            netplay_store_input(control_id, count, current->buttons, current->plugin, 1);
+            netplay_delete_event(current, control_id);
+        }
+        else if (input->count != count || l_netplay_control[control_id] == -1)
+        {
+            //We predict that remote players keep holding their previous input,
+            //our own input was stored when we sent it to the server
+            previous = &l_input_history[control_id][(count - 1) % NETPLAY_HISTORY_SIZE];
+            if (previous->count == count - 1)
+                netplay_store_input(control_id, count, previous->buttons, previous->plugin, 0);
+            else
+                netplay_store_input(control_id, count, 0, Controls[control_id].Plugin, 0);
+        }
+    }
+
+    Controls[control_id].Plugin = input->plugin;
+    ++l_cin_compats[control_id].netplay_count;
+    return input->buttons;
 }
 
 static uint32_t netplay_get_input(uint8_t control_id)
 {
     uint32_t keys;
     netplay_process();
+    if (rollback_is_enabled())
+        netplay_confirm_inputs(control_id);
     netplay_request_input(control_id);
 
     //l_buffer_target is set by the server upon registration
@@ -397,13 +640,14 @@ static uint32_t netplay_get_input(uint8_t control_id)
         l_canFF = 0;
     }
 
+    if (rollback_is_enabled())
+        return netplay_get_rollback_input(control_id);
+
     if (netplay_ensure_valid(control_id))
     {
-        //We grab the event from the linked list, the delete it once it has been used
+        //We grab the event from the buffer, then delete it once it has been used
         //Finally we increment the event counter
-        struct netplay_event* current = l_cin_compats[control_id].event_first;
-        while (current->count != l_cin_compats[control_id].netplay_count)
-            current = current->next;
+        struct netplay_event* current = netplay_find_event(control_id, l_cin_compats[control_id].netplay_count);
         keys = current->buttons;
         Controls[control_id].Plugin = current->plugin;
         netplay_delete_event(current, control_id);
@@ -411,8 +655,7 @@ static uint32_t netplay_get_input(uint8_t control_id)
     }
     else
     {
-        DebugMessage(M64MSG_ERROR, "Netplay: lost connection to server");
-        main_core_state_set(M64CORE_EMU_STATE, M64EMU_STOPPED);
+        netplay_lost_connection();
         keys = 0;
     }
 
@@ -421,9 +664,22 @@ static uint32_t netplay_get_input(uint8_t control_id)
 
 static void netplay_send_input(uint8_t control_id, uint32_t keys)
 {
+    uint32_t count = l_cin_compats[control_id].netplay_count;
+    if (rollback_is_enabled())
+    {
+        //Resimulated frames use the input we have sent already
+        if (count_before(count, l_send_count[control_id]))
+            return;
+        l_send_count[control_id] = count + 1;
+
+        //We predict that the server confirms our input as is
+        if (!is_confirmed(control_id, count))
+            netplay_store_input(control_id, count, keys, l_plugin[control_id], 0);
+    }
+
     l_send_input_packet->data[0] = UDP_SEND_KEY_INFO;
     l_send_input_packet->data[1] = control_id; //player number
-    SDLNet_Write32(l_cin_compats[control_id].netplay_count, &l_send_input_packet->data[2]); // current event count
+    SDLNet_Write32(count, &l_send_input_packet->data[2]); // current event count
     SDLNet_Write32(keys, &l_send_input_packet->data[6]); //key data
     l_send_input_packet->data[10] = l_plugin[control_id]; //current plugin
     l_send_input_packet->len = 11;
@@ -569,10 +825,57 @@ void netplay_sync_settings(uint32_t *count_per_op, uint32_t *count_per_op_denom_
     }
 }
 
+static void netplay_hash_state(uint64_t hashes[NETPLAY_HASH_COUNT])
+{
+    //This function hashes the parts of the emulated state that have to match between players
+    const size_t region_size = 0x100000;
+    const uint8_t* dram = (const uint8_t*)g_dev.rdram.dram;
+    XXH3_state_t state;
+
+    for (int i = 0; i < NETPLAY_RDRAM_HASH_REGIONS; ++i)
+    {
+        size_t offset = i * region_size;
+        if (offset + region_size <= g_dev.rdram.dram_size)
+            hashes[i] = XXH3_64bits(&dram[offset], region_size);
+        else
+            hashes[i] = 0; //without the expansion pak, only the first 4MB exist
+    }
+
+    hashes[NETPLAY_HASH_DMEM] = XXH3_64bits(&g_dev.sp.mem[0x0000 / 4], 0x1000);
+    hashes[NETPLAY_HASH_IMEM] = XXH3_64bits(&g_dev.sp.mem[0x1000 / 4], 0x1000);
+
+    XXH3_64bits_reset(&state);
+    XXH3_64bits_update(&state, r4300_regs(&g_dev.r4300), 32 * sizeof(int64_t));
+    XXH3_64bits_update(&state, r4300_mult_hi(&g_dev.r4300), sizeof(int64_t));
+    XXH3_64bits_update(&state, r4300_mult_lo(&g_dev.r4300), sizeof(int64_t));
+    XXH3_64bits_update(&state, r4300_cp0_regs(&g_dev.r4300.cp0), CP0_REGS_COUNT * sizeof(uint32_t));
+    hashes[NETPLAY_HASH_R4300_REGS] = XXH3_64bits_digest(&state);
+
+    XXH3_64bits_reset(&state);
+    XXH3_64bits_update(&state, g_dev.sp.regs, sizeof(g_dev.sp.regs));
+    XXH3_64bits_update(&state, g_dev.sp.regs2, sizeof(g_dev.sp.regs2));
+    hashes[NETPLAY_HASH_RSP_REGS] = XXH3_64bits_digest(&state);
+
+    XXH3_64bits_reset(&state);
+    XXH3_64bits_update(&state, g_dev.dp.dpc_regs, sizeof(g_dev.dp.dpc_regs));
+    XXH3_64bits_update(&state, g_dev.dp.dps_regs, sizeof(g_dev.dp.dps_regs));
+    hashes[NETPLAY_HASH_RDP_REGS] = XXH3_64bits_digest(&state);
+
+    XXH3_64bits_reset(&state);
+    XXH3_64bits_update(&state, g_dev.mi.regs, sizeof(g_dev.mi.regs));
+    XXH3_64bits_update(&state, g_dev.vi.regs, sizeof(g_dev.vi.regs));
+    XXH3_64bits_update(&state, g_dev.ai.regs, sizeof(g_dev.ai.regs));
+    XXH3_64bits_update(&state, g_dev.pi.regs, sizeof(g_dev.pi.regs));
+    XXH3_64bits_update(&state, g_dev.si.regs, sizeof(g_dev.si.regs));
+    XXH3_64bits_update(&state, g_dev.ri.regs, sizeof(g_dev.ri.regs));
+    hashes[NETPLAY_HASH_INTERFACE_REGS] = XXH3_64bits_digest(&state);
+}
+
 void netplay_check_sync(struct cp0* cp0)
 {
     //This function is used to check if games have desynced
     //Every 600 VIs, it sends the value of the CP0 registers to the server
+    //When enabled, it also sends hashes of the emulated state at the configured interval
     //The server will compare the values, and update the status byte if it detects a desync
     if (!netplay_is_init())
         return;
@@ -588,10 +891,65 @@ void netplay_check_sync(struct cp0* cp0)
             SDLNet_Write32(cp0_regs[i], &l_check_sync_packet->data[(i * 4) + 5]);
         }
         l_check_sync_packet->len = l_check_sync_packet_size;
-        SDLNet_UDP_Send(l_udpSocket, l_udpChannel, l_check_sync_packet);
+        netplay_queue_sync(l_check_sync_packet);
+    }
+
+    if (l_sync_hash_interval != 0 && l_vi_counter % l_sync_hash_interval == 0)
+    {
+        uint64_t hashes[NETPLAY_HASH_COUNT];
+        netplay_hash_state(hashes);
+
+        l_sync_hash_packet->data[0] = UDP_SYNC_HASH;
+        SDLNet_Write32(l_vi_counter, &l_sync_hash_packet->data[1]); //current VI count
+        l_sync_hash_packet->data[5] = NETPLAY_HASH_COUNT; //number of hashes
+        for (int i = 0; i < NETPLAY_HASH_COUNT; ++i)
+        {
+            SDLNet_Write32((uint32_t)(hashes[i] >> 32), &l_sync_hash_packet->data[(i * 8) + 6]);
+            SDLNet_Write32((uint32_t)hashes[i], &l_sync_hash_packet->data[(i * 8) + 10]);
+        }
+        l_sync_hash_packet->len = l_sync_hash_packet_size;
+        netplay_queue_sync(l_sync_hash_packet);
+
+        DebugMessage(M64MSG_VERBOSE, "Netplay: state hashes at VI %u: "
+                     "%016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " "
+                     "%016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64,
+                     l_vi_counter,
+                     hashes[0], hashes[1], hashes[2], hashes[3], hashes[4], hashes[5], hashes[6],
+                     hashes[7], hashes[8], hashes[9], hashes[10], hashes[11], hashes[12], hashes[13]);
     }
 
     ++l_vi_counter;
+
+    netplay_send_pending_sync();
+}
+
+void netplay_get_rollback_context(uint32_t counts[4], uint32_t* vi_counter)
+{
+    for (int i = 0; i < 4; ++i)
+        counts[i] = l_cin_compats[i].netplay_count;
+    *vi_counter = l_vi_counter;
+}
+
+void netplay_set_rollback_context(const uint32_t counts[4], uint32_t vi_counter)
+{
+    for (int i = 0; i < 4; ++i)
+        l_cin_compats[i].netplay_count = counts[i];
+    l_vi_counter = vi_counter;
+}
+
+int netplay_wait_confirmed(const uint32_t counts[4])
+{
+    netplay_process();
+
+    for (int i = 0; i < 4; ++i)
+    {
+        if (Controls[i].Present && !netplay_wait_confirmed_count(i, counts[i]))
+        {
+            netplay_lost_connection();
+            return 0;
+        }
+    }
+    return 1;
 }
 
 void netplay_read_registration(struct controller_input_compat* cin_compats)
@@ -603,6 +961,18 @@ void netplay_read_registration(struct controller_input_compat* cin_compats)
 
     l_cin_compats = cin_compats;
 
+    memset(l_events, 0, sizeof(l_events));
+    memset(l_event_count, 0, sizeof(l_event_count));
+    memset(l_input_history, 0, sizeof(l_input_history));
+    memset(l_confirmed_count, 0, sizeof(l_confirmed_count));
+    memset(l_send_count, 0, sizeof(l_send_count));
+    memset(l_pending_syncs, 0, sizeof(l_pending_syncs));
+    l_pending_sync_head = 0;
+    l_pending_sync_count = 0;
+
+    int sync_hash_interval = ConfigGetParamInt(g_CoreConfig, "NetplaySyncHashInterval");
+    l_sync_hash_interval = sync_hash_interval > 0 ? (uint32_t)sync_hash_interval : 0;
+
     uint32_t reg_id;
     char output_data = TCP_GET_REGISTRATION;
     char input_data[24];
@@ -28,13 +28,6 @@
 
 #define NETPLAY_CORE_VERSION 1
 
-struct netplay_event {
-    uint32_t buttons;
-    uint8_t plugin;
-    uint32_t count;
-    struct netplay_event* next;
-};
-
 struct controller_input_compat;
 
 #ifdef M64P_NETPLAY
@@ -54,6 +47,9 @@ void netplay_read_registration(struct controller_input_compat* cin_compats);
 void netplay_update_input(struct pif* pif);
 m64p_error netplay_send_config(char* data, int size);
 m64p_error netplay_receive_config(char* data, int size);
+void netplay_get_rollback_context(uint32_t counts[4], uint32_t* vi_counter);
+void netplay_set_rollback_context(const uint32_t counts[4], uint32_t vi_counter);
+int netplay_wait_confirmed(const uint32_t counts[4]);
 
 #else
 
@@ -131,6 +127,19 @@ static osal_inline m64p_error netplay_receive_config(char* data, int size)
     return M64ERR_INCOMPATIBLE;
 }
 
+static osal_inline void netplay_get_rollback_context(uint32_t counts[4], uint32_t* vi_counter)
+{
+}
+
+static osal_inline void netplay_set_rollback_context(const uint32_t counts[4], uint32_t vi_counter)
+{
+}
+
+static osal_inline int netplay_wait_confirmed(const uint32_t counts[4])
+{
+    return 0;
+}
+
 #endif
 
 #endif
@@ -0,0 +1,255 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rollback.c                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdlib.h>
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main/netplay.h"
+#include "rollback.h"
+#include "savestates.h"
+
+/* every saved frame is a full savestate, so keep the window small */
+#define ROLLBACK_MAX_FRAMES 16
+
+struct rollback_frame
+{
+    void *state;
+    /* netplay context at the start of the frame */
+    uint32_t counts[4];
+    uint32_t vi_counter;
+};
+
+/* frames + 1, 0 when disabled, frame n is stored at n % l_size */
+static unsigned int l_size = 0;
+static struct rollback_frame *l_frames = NULL;
+
+static int l_has_frames = 0;
+/* oldest and newest saved frame */
+static uint32_t l_oldest = 0;
+static uint32_t l_newest = 0;
+/* frame being emulated */
+static uint32_t l_frame = 0;
+
+static int l_vi_pending = 0;
+static int l_load_pending = 0;
+static uint32_t l_load_frame = 0;
+
+static int l_resimulating = 0;
+/* frame which was being emulated before rolling back */
+static uint32_t l_resimulate_until = 0;
+
+void rollback_init(int frames)
+{
+    unsigned int i;
+    size_t state_size;
+
+    rollback_deinit();
+
+    /* rollback only makes sense with netplay */
+    if (frames <= 0 || !netplay_is_init())
+        return;
+
+    if (frames > ROLLBACK_MAX_FRAMES)
+    {
+        DebugMessage(M64MSG_WARNING, "Netplay: limiting rollback to %u frames", ROLLBACK_MAX_FRAMES);
+        frames = ROLLBACK_MAX_FRAMES;
+    }
+
+    state_size = savestates_get_memory_size();
+
+    l_frames = calloc(frames + 1, sizeof(struct rollback_frame));
+    if (l_frames == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Insufficient memory for rollback");
+        return;
+    }
+
+    l_size = frames + 1;
+
+    for (i = 0; i < l_size; ++i)
+    {
+        l_frames[i].state = malloc(state_size);
+        if (l_frames[i].state == NULL)
+        {
+            DebugMessage(M64MSG_ERROR, "Insufficient memory for rollback");
+            rollback_deinit();
+            return;
+        }
+    }
+
+    DebugMessage(M64MSG_INFO, "Netplay: rolling back up to %d frame(s)", frames);
+}
+
+void rollback_deinit(void)
+{
+    unsigned int i;
+
+    if (l_frames != NULL)
+    {
+        for (i = 0; i < l_size; ++i)
+            free(l_frames[i].state);
+        free(l_frames);
+    }
+
+    l_frames = NULL;
+    l_size = 0;
+
+    l_has_frames = 0;
+    l_oldest = 0;
+    l_newest = 0;
+    l_frame = 0;
+    l_vi_pending = 0;
+    l_load_pending = 0;
+    l_load_frame = 0;
+    l_resimulating = 0;
+    l_resimulate_until = 0;
+}
+
+int rollback_is_enabled(void)
+{
+    return l_size != 0;
+}
+
+int rollback_can_roll_back(void)
+{
+    return l_has_frames;
+}
+
+void rollback_new_vi(void)
+{
+    if (l_size != 0)
+        l_vi_pending = 1;
+}
+
+int rollback_load(void)
+{
+    struct rollback_frame *frame;
+
+    if (!l_load_pending)
+        return 0;
+
+    l_load_pending = 0;
+    /* the frame is saved again once it has finished */
+    l_vi_pending = 0;
+
+    frame = &l_frames[l_load_frame % l_size];
+
+    if (!savestates_load_from_buffer(frame->state))
+    {
+        /* the games will desync from here on */
+        DebugMessage(M64MSG_ERROR, "Netplay: failed to roll back to frame %u", l_load_frame);
+        return 0;
+    }
+
+    netplay_set_rollback_context(frame->counts, frame->vi_counter);
+
+    /* when rolling back while resimulating,
+     * the frame to catch up with stays the same */
+    if (!l_resimulating)
+        l_resimulate_until = l_frame;
+
+    l_frame = l_load_frame;
+    l_resimulating = (l_frame != l_resimulate_until);
+    return 1;
+}
+
+void rollback_save(void)
+{
+    struct rollback_frame *frame;
+    uint32_t next_frame;
+
+    if (!l_vi_pending)
+        return;
+
+    l_vi_pending = 0;
+
+    /* the frame is about to be replaced */
+    if (l_load_pending)
+        return;
+
+    next_frame = l_has_frames ? l_frame + 1 : 0;
+
+    if (l_has_frames && next_frame > l_newest && (next_frame - l_oldest) == l_size)
+    {
+        /* the oldest frame is about to be dropped, so wait until
+         * the inputs which might still have to be rolled back to
+         * it have been confirmed */
+        netplay_wait_confirmed(l_frames[(l_oldest + 1) % l_size].counts);
+        if (l_load_pending)
+            return;
+        l_oldest++;
+    }
+
+    l_frame = next_frame;
+    if (!l_has_frames || l_frame > l_newest)
+        l_newest = l_frame;
+    l_has_frames = 1;
+
+    frame = &l_frames[l_frame % l_size];
+    savestates_save_to_buffer(frame->state);
+    netplay_get_rollback_context(frame->counts, &frame->vi_counter);
+
+    if (l_resimulating && l_frame == l_resimulate_until)
+        l_resimulating = 0;
+}
+
+void rollback_request(uint8_t control_id, uint32_t count)
+{
+    uint32_t frame;
+
+    if (!l_has_frames)
+        return;
+
+    /* find the last frame which started before the input was used */
+    frame = l_frame;
+    while ((count - l_frames[frame % l_size].counts[control_id]) > (UINT32_MAX / 2))
+    {
+        if (frame == l_oldest)
+        {
+            DebugMessage(M64MSG_ERROR, "Netplay: input %u of player %u arrived too late to roll back", count, control_id + 1);
+            return;
+        }
+        frame--;
+    }
+
+    if (!l_load_pending || frame < l_load_frame)
+        l_load_frame = frame;
+    l_load_pending = 1;
+}
+
+int rollback_is_resimulating(void)
+{
+    return l_resimulating;
+}
+
+int rollback_is_video_silent(void)
+{
+    /* the last resimulated frame replaces the frame
+     * which was shown before rolling back */
+    return l_resimulating && (l_frame + 1) != l_resimulate_until;
+}
+
+int rollback_is_audio_silent(void)
+{
+    return l_resimulating;
+}
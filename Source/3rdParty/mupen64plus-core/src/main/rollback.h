@@ -0,0 +1,61 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rollback.h                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_ROLLBACK_H
+#define M64P_MAIN_ROLLBACK_H
+
+#include <stdint.h>
+
+/* Rollback lets netplay predict inputs which haven't arrived yet instead
+ * of waiting for them. Every frame is saved, when the server disagrees
+ * with a prediction, the state of the frame which used the input is
+ * loaded and the frames since are emulated again without output.
+ * At most the given amount of frames are rolled back, netplay waits
+ * for inputs which would need to roll back further. */
+void rollback_init(int frames);
+void rollback_deinit(void);
+
+int rollback_is_enabled(void);
+/* returns whether there's a saved frame to roll back to */
+int rollback_can_roll_back(void);
+
+/* called on every vertical interrupt */
+void rollback_new_vi(void);
+
+/* called where savestate jobs are loaded, returns 1 when the state
+ * has been rolled back */
+int rollback_load(void);
+/* called where savestate jobs are saved */
+void rollback_save(void);
+
+/* rolls back to the frame which used the given input count
+ * of the given controller at the next opportunity */
+void rollback_request(uint8_t control_id, uint32_t count);
+
+/* returns whether the emulated frame is emulated again after a rollback */
+int rollback_is_resimulating(void);
+
+/* resimulated frames don't produce any audio and only the
+ * last one produces video */
+int rollback_is_video_silent(void);
+int rollback_is_audio_silent(void);
+
+#endif
@@ -136,11 +136,78 @@ static void swap_copy_rom(void* dst, const void* src, size_t len, unsigned char*
     }
 }
 
+/* Fills in the settings for the given ROM header and MD5 digest from the
+ * ROM database, when the ROM isn't in the database, the defaults are used.
+ * This function doesn't touch any global state other than reading the
+ * ROM database, so it can be used without opening the ROM.
+ *
+ * IN: header: The ROM header in native (.z64) byte order.
+ *     headername: The ROM name from the header, without trailing whitespace.
+ *     digest: The MD5 digest of the whole ROM image in native (.z64) byte order.
+ * OUT: settings: The ROM settings, the MD5 field is left untouched.
+ *      cheats: The cheats from the ROM database entry, may be NULL.
+ */
+static void rom_settings_from_database(const m64p_rom_header* header, const char* headername, md5_byte_t* digest,
+                                       m64p_rom_settings* settings, char** cheats)
+{
+    romdatabase_entry* entry;
+
+    if ((entry=ini_search_by_md5(digest)) != NULL ||
+        (entry=ini_search_by_crc(tohl(header->CRC1),tohl(header->CRC2))) != NULL)
+    {
+        strncpy(settings->goodname, entry->goodname, 255);
+        settings->goodname[255] = '\0';
+        settings->savetype = entry->savetype;
+        settings->status = entry->status;
+        settings->players = entry->players;
+        settings->rumble = entry->rumble;
+        settings->transferpak = entry->transferpak;
+        settings->mempak = entry->mempak;
+        settings->biopak = entry->biopak;
+        settings->countperop = entry->countperop;
+        settings->disableextramem = entry->disableextramem;
+        settings->sidmaduration = entry->sidmaduration;
+        settings->aidmamodifier = entry->aidmamodifier;
+        settings->runahead = 0;
+        if (cheats != NULL)
+            *cheats = entry->cheats;
+    }
+    else
+    {
+        strcpy(settings->goodname, headername);
+        strcat(settings->goodname, " (unknown rom)");
+        settings->status = 0;
+        settings->players = 4;
+        settings->rumble = 1;
+        settings->transferpak = 0;
+        settings->mempak = 1;
+        settings->biopak = 0;
+        settings->countperop = DEFAULT_COUNT_PER_OP;
+        settings->disableextramem = DEFAULT_DISABLE_EXTRA_MEM;
+        settings->sidmaduration = DEFAULT_SI_DMA_DURATION;
+        settings->aidmamodifier = DEFAULT_AI_DMA_MODIFIER;
+        settings->runahead = 0;
+        if (cheats != NULL)
+            *cheats = NULL;
+
+        /* check if ROM has the Advanced Homebrew ROM Header (see https://n64brew.dev/wiki/ROM_Header) */
+        if (header->Cartridge_ID == 0x4445)
+        {
+            /* When current ROM has the Advanced Homebrew ROM Header, use the save type */
+            settings->savetype = rom_homebrew_savetype_to_savetype(header->Version >> 4);
+        }
+        else
+        {
+            /* There's no way to guess the save type, but 4K EEPROM is better than nothing */
+            settings->savetype = SAVETYPE_EEPROM_4K;
+        }
+    }
+}
+
 m64p_error open_rom(const unsigned char* romimage, unsigned int size)
 {
     md5_state_t state;
     md5_byte_t digest[16];
-    romdatabase_entry* entry;
     char buffer[256];
     unsigned char imagetype;
     int i;
@@ -183,52 +250,7 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
     trim(ROM_PARAMS.headername); /* Remove trailing whitespace from ROM name. */
 
     /* Look up this ROM in the .ini file and fill in goodname, etc */
-    if ((entry=ini_search_by_md5(digest)) != NULL ||
-        (entry=ini_search_by_crc(tohl(ROM_HEADER.CRC1),tohl(ROM_HEADER.CRC2))) != NULL)
-    {
-        strncpy(ROM_SETTINGS.goodname, entry->goodname, 255);
-        ROM_SETTINGS.goodname[255] = '\0';
-        ROM_SETTINGS.savetype = entry->savetype;
-        ROM_SETTINGS.status = entry->status;
-        ROM_SETTINGS.players = entry->players;
-        ROM_SETTINGS.rumble = entry->rumble;
-        ROM_SETTINGS.transferpak = entry->transferpak;
-        ROM_SETTINGS.mempak = entry->mempak;
-        ROM_SETTINGS.biopak = entry->biopak;
-        ROM_SETTINGS.countperop = entry->countperop;
-        ROM_SETTINGS.disableextramem = entry->disableextramem;
-        ROM_SETTINGS.sidmaduration = entry->sidmaduration;
-        ROM_SETTINGS.aidmamodifier = entry->aidmamodifier;
-        ROM_PARAMS.cheats = entry->cheats;
-    }
-    else
-    {
-        strcpy(ROM_SETTINGS.goodname, ROM_PARAMS.headername);
-        strcat(ROM_SETTINGS.goodname, " (unknown rom)");
-        ROM_SETTINGS.status = 0;
-        ROM_SETTINGS.players = 4;
-        ROM_SETTINGS.rumble = 1;
-        ROM_SETTINGS.transferpak = 0;
-        ROM_SETTINGS.mempak = 1;
-        ROM_SETTINGS.biopak = 0;
-        ROM_SETTINGS.countperop = DEFAULT_COUNT_PER_OP;
-        ROM_SETTINGS.disableextramem = DEFAULT_DISABLE_EXTRA_MEM;
-        ROM_SETTINGS.sidmaduration = DEFAULT_SI_DMA_DURATION;
-        ROM_SETTINGS.aidmamodifier = DEFAULT_AI_DMA_MODIFIER;
-        ROM_PARAMS.cheats = NULL;
-
-        /* check if ROM has the Advanced Homebrew ROM Header (see https://n64brew.dev/wiki/ROM_Header) */
-        if (ROM_HEADER.Cartridge_ID == 0x4445)
-        {
-            /* When current ROM has the Advanced Homebrew ROM Header, use the save type */
-            ROM_SETTINGS.savetype = rom_homebrew_savetype_to_savetype(ROM_HEADER.Version >> 4);
-        }
-        else
-        {
-            /* There's no way to guess the save type, but 4K EEPROM is better than nothing */
-            ROM_SETTINGS.savetype = SAVETYPE_EEPROM_4K;
-        }
-    }
+    rom_settings_from_database(&ROM_HEADER, ROM_PARAMS.headername, digest, &ROM_SETTINGS, &ROM_PARAMS.cheats);
 
     /* print out a bunch of info about the ROM */
     DebugMessage(M64MSG_INFO, "Goodname: %s", ROM_SETTINGS.goodname);
@@ -262,6 +284,26 @@ m64p_error close_rom(void)
     return M64ERR_SUCCESS;
 }
 
+m64p_error lookup_rom_database(m64p_rom_database_lookup* lookup)
+{
+    char headername[21];
+    int i;
+
+    memcpy(headername, lookup->header.Name, 20);
+    headername[20] = '\0';
+    trim(headername); /* Remove trailing whitespace from ROM name. */
+    /* Return a clean ROM name like M64CMD_ROM_GET_HEADER does */
+    memcpy(lookup->header.Name, headername, 20);
+
+    for ( i = 0; i < 16; ++i )
+        sprintf(lookup->settings.MD5+i*2, "%02X", lookup->md5[i]);
+    lookup->settings.MD5[32] = '\0';
+
+    rom_settings_from_database(&lookup->header, headername, lookup->md5, &lookup->settings, NULL);
+
+    return M64ERR_SUCCESS;
+}
+
 m64p_error open_disk(void)
 {
     md5_state_t state;
@@ -336,6 +378,7 @@ m64p_error open_disk(void)
         ROM_SETTINGS.disableextramem = entry->disableextramem;
         ROM_SETTINGS.sidmaduration = entry->sidmaduration;
         ROM_SETTINGS.aidmamodifier = entry->aidmamodifier;
+        ROM_SETTINGS.runahead = 0;
         ROM_PARAMS.cheats = entry->cheats;
     }
     else
@@ -353,6 +396,7 @@ m64p_error open_disk(void)
         ROM_SETTINGS.disableextramem = DEFAULT_DISABLE_EXTRA_MEM;
         ROM_SETTINGS.sidmaduration = DEFAULT_SI_DMA_DURATION;
         ROM_SETTINGS.aidmamodifier = DEFAULT_AI_DMA_MODIFIER;
+        ROM_SETTINGS.runahead = 0;
         ROM_PARAMS.cheats = NULL;
     }
 
@@ -44,6 +44,9 @@ m64p_error close_rom(void);
 m64p_error open_disk(void);
 m64p_error close_disk(void);
 
+/* Looks up a ROM in the ROM database without opening it */
+m64p_error lookup_rom_database(m64p_rom_database_lookup* lookup);
+
 extern int g_rom_size;
 
 typedef struct _rom_params
@@ -0,0 +1,157 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - runahead.c                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdlib.h>
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main/netplay.h"
+#include "runahead.h"
+#include "savestates.h"
+
+/* amount of frames to run ahead, 0 when disabled */
+static unsigned int l_frames = 0;
+/* amount of frames emulated ahead since the state was saved */
+static unsigned int l_phase = 0;
+
+static int l_vi_pending = 0;
+static int l_load_pending = 0;
+
+static int l_video_silent = 0;
+static int l_audio_silent = 0;
+
+static void *l_state = NULL;
+
+void runahead_init(unsigned int frames)
+{
+    runahead_deinit();
+
+    if (frames == 0)
+        return;
+
+    /* rolling back would desync netplay */
+    if (netplay_is_init())
+    {
+        DebugMessage(M64MSG_WARNING, "Run-ahead isn't supported with netplay");
+        return;
+    }
+
+    l_state = malloc(savestates_get_memory_size());
+    if (l_state == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Insufficient memory for run-ahead");
+        return;
+    }
+
+    l_frames = frames;
+    /* the video of the frame with fresh input
+     * is replaced by the last frame ahead */
+    l_video_silent = 1;
+
+    DebugMessage(M64MSG_INFO, "Running %u frame(s) ahead", frames);
+}
+
+void runahead_deinit(void)
+{
+    free(l_state);
+    l_state = NULL;
+
+    l_frames = 0;
+    l_phase = 0;
+    l_vi_pending = 0;
+    l_load_pending = 0;
+    l_video_silent = 0;
+    l_audio_silent = 0;
+}
+
+void runahead_new_vi(void)
+{
+    if (l_frames != 0)
+        l_vi_pending = 1;
+}
+
+int runahead_load(void)
+{
+    if (!l_load_pending)
+        return 0;
+
+    l_load_pending = 0;
+
+    if (!savestates_load_from_buffer(l_state))
+    {
+        /* something went horribly wrong,
+         * so continue without run-ahead */
+        runahead_deinit();
+        return 0;
+    }
+
+    l_phase = 0;
+    l_video_silent = 1;
+    l_audio_silent = 0;
+    return 1;
+}
+
+void runahead_save(void)
+{
+    if (!l_vi_pending)
+        return;
+
+    l_vi_pending = 0;
+
+    if (l_phase == 0)
+    {
+        /* the frame with fresh input has finished */
+        savestates_save_to_buffer(l_state);
+        l_phase = 1;
+    }
+    else if (l_phase < l_frames)
+    {
+        l_phase++;
+    }
+    else
+    {
+        /* the last frame ahead has been shown,
+         * roll back at the next opportunity */
+        l_load_pending = 1;
+        l_video_silent = 1;
+        return;
+    }
+
+    /* only the last frame ahead is shown */
+    l_video_silent = (l_phase != l_frames);
+    l_audio_silent = 1;
+}
+
+int runahead_is_ahead(void)
+{
+    return l_phase != 0 || l_load_pending;
+}
+
+int runahead_is_video_silent(void)
+{
+    return l_video_silent;
+}
+
+int runahead_is_audio_silent(void)
+{
+    return l_audio_silent;
+}
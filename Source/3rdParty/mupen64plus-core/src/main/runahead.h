@@ -0,0 +1,49 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - runahead.h                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_RUNAHEAD_H
+#define M64P_MAIN_RUNAHEAD_H
+
+/* Run-ahead emulates each frame with fresh input, saves the state,
+ * emulates the given amount of frames ahead without output except
+ * for the last one and then loads the saved state again. This hides
+ * the given amount of frames of input latency built into the game. */
+void runahead_init(unsigned int frames);
+void runahead_deinit(void);
+
+/* called on every vertical interrupt */
+void runahead_new_vi(void);
+
+/* called where savestate jobs are loaded, returns 1 when the state
+ * has been rolled back */
+int runahead_load(void);
+/* called where savestate jobs are saved */
+void runahead_save(void);
+
+/* returns whether the emulated frame is a frame ahead
+ * which will be rolled back */
+int runahead_is_ahead(void);
+
+/* silent frames mustn't produce any video or audio output */
+int runahead_is_video_silent(void);
+int runahead_is_audio_silent(void);
+
+#endif
@@ -40,6 +40,7 @@
 #include "api/m64p_config.h"
 #include "api/m64p_types.h"
 #include "backends/api/storage_backend.h"
+#include "chunked_state.h"
 #include "device/device.h"
 #include "main/list.h"
 #include "main/main.h"
@@ -57,6 +58,10 @@ enum { GB_CART_FINGERPRINT_OFFSET = 0x134 };
 
 enum { DD_DISK_ID_OFFSET = 0x43670 };
 
+/* header, device state, event queue, using_tlb flags and extra state */
+enum { SAVESTATE_M64P_HEADER_SIZE = 44 };
+enum { SAVESTATE_M64P_SIZE = 16788288 + 1024 + 4 + 4096 };
+
 static const char* savestate_magic = "M64+SAVE";
 static const int savestate_latest_version = 0x00010900;  /* 1.9 */
 static const unsigned char pj64_magic[4] = { 0xC8, 0xA6, 0xD8, 0x23 };
@@ -65,6 +70,9 @@ static savestates_job job = savestates_job_nothing;
 static savestates_type type = savestates_type_unknown;
 static char *fname = NULL;
 
+static savestates_job memory_job = savestates_job_nothing;
+static m64p_state_memory memory_state;
+
 static unsigned int slot = 0;
 static int autoinc_save_slot = 0;
 
@@ -170,6 +178,43 @@ static void savestates_clear_job(void)
     savestates_set_job(savestates_job_nothing, savestates_type_unknown, NULL);
 }
 
+savestates_job savestates_get_memory_job(void)
+{
+    return memory_job;
+}
+
+int savestates_set_memory_job(savestates_job j, const m64p_state_memory *mem)
+{
+    /* only a single memory job can be pending */
+    if (j != savestates_job_nothing && memory_job != savestates_job_nothing)
+        return 0;
+
+    if (mem != NULL)
+        memory_state = *mem;
+    else
+        memset(&memory_state, 0, sizeof(memory_state));
+
+    memory_job = j;
+    return 1;
+}
+
+size_t savestates_get_memory_size(void)
+{
+    return SAVESTATE_M64P_SIZE;
+}
+
+static void savestates_finish_memory_job(int result)
+{
+    m64p_state_memory mem = memory_state;
+
+    /* clear the job before calling the callback,
+     * so it is able to queue the next job */
+    savestates_set_memory_job(savestates_job_nothing, NULL);
+
+    if (mem.callback != NULL)
+        mem.callback(mem.context, result);
+}
+
 #define GETARRAY(buff, type, count) \
     (to_little_endian_buffer(buff, sizeof(type),count), \
      buff += count*sizeof(type), \
@@ -185,126 +230,14 @@ static void savestates_clear_job(void)
 #define PUTDATA(buff, type, value) \
     do { type x = value; PUTARRAY(&x, buff, type, 1); } while(0)
 
-static int savestates_load_m64p(struct device* dev, char *filepath)
+static void savestates_parse_m64p(struct device* dev, unsigned int version, unsigned char *curr,
+                                  char *queue, unsigned char *using_tlb_data, unsigned char *data_0001_0200)
 {
-    unsigned char header[44];
-    gzFile f;
-    unsigned int version;
     int i;
     uint32_t FCR31;
 
-    size_t savestateSize;
-    unsigned char *savestateData, *curr;
-    char queue[1024];
-    unsigned char using_tlb_data[4];
-    unsigned char data_0001_0200[4096]; // 4k for extra state from v1.2
-
     uint32_t* cp0_regs = r4300_cp0_regs(&dev->r4300.cp0);
 
-    SDL_LockMutex(savestates_lock);
-
-    f = osal_gzopen(filepath, "rb");
-    if(f==NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-
-    /* Read and check Mupen64Plus magic number. */
-    if (gzread(f, header, 44) != 44)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr = header;
-
-    if(strncmp((char *)curr, savestate_magic, 8)!=0)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file: %s is not a valid Mupen64plus savestate.", filepath);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr += 8;
-
-    version = *curr++;
-    version = (version << 8) | *curr++;
-    version = (version << 8) | *curr++;
-    version = (version << 8) | *curr++;
-    if((version >> 16) != (savestate_latest_version >> 16))
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", version);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-
-    if(memcmp((char *)curr, ROM_SETTINGS.MD5, 32))
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State ROM MD5 does not match current ROM.");
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr += 32;
-
-    /* Read the rest of the savestate */
-    savestateSize = 16788244;
-    savestateData = curr = (unsigned char *)malloc(savestateSize);
-    if (savestateData == NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    if (version == 0x00010000) /* original savestate version */
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            (gzread(f, queue, sizeof(queue)) % 4) != 0)
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.0 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-    else if (version == 0x00010100) // saves entire eventqueue plus 4-byte using_tlb flags
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
-            gzread(f, using_tlb_data, sizeof(using_tlb_data)) != sizeof(using_tlb_data))
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.1 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-    else // version >= 0x00010200  saves entire eventqueue, 4-byte using_tlb flags and extra state
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
-            gzread(f, using_tlb_data, sizeof(using_tlb_data)) != sizeof(using_tlb_data) ||
-            gzread(f, data_0001_0200, sizeof(data_0001_0200)) != sizeof(data_0001_0200))
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.2+ data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-
-    gzclose(f);
-    SDL_UnlockMutex(savestates_lock);
-
-    // Parse savestate
     dev->rdram.regs[0][RDRAM_CONFIG_REG]       = GETDATA(curr, uint32_t);
     dev->rdram.regs[0][RDRAM_DEVICE_ID_REG]    = GETDATA(curr, uint32_t);
     dev->rdram.regs[0][RDRAM_DELAY_REG]        = GETDATA(curr, uint32_t);
@@ -953,6 +886,183 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     dev->r4300.cp0.interrupt_unsafe_state = 0;
 
     *r4300_cp0_last_addr(&dev->r4300.cp0) = *r4300_pc(&dev->r4300);
+}
+
+/* Checks the magic number, version and ROM MD5 of a Mupen64Plus savestate header */
+static int savestates_check_m64p_header(const unsigned char *header, const char *filepath, unsigned int *version)
+{
+    const unsigned char *curr = header;
+
+    if(strncmp((const char *)curr, savestate_magic, 8)!=0)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file: %s is not a valid Mupen64plus savestate.", filepath);
+        return 0;
+    }
+    curr += 8;
+
+    *version = *curr++;
+    *version = (*version << 8) | *curr++;
+    *version = (*version << 8) | *curr++;
+    *version = (*version << 8) | *curr++;
+    if((*version >> 16) != (savestate_latest_version >> 16))
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", *version);
+        return 0;
+    }
+
+    if(memcmp((const char *)curr, ROM_SETTINGS.MD5, 32))
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State ROM MD5 does not match current ROM.");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parses a savestate in the layout written by savestates_serialize_m64p,
+ * on big endian hosts the data is swapped in place */
+static void savestates_parse_m64p_buffer(struct device* dev, unsigned int version, unsigned char *data)
+{
+    savestates_parse_m64p(dev, version, data + SAVESTATE_M64P_HEADER_SIZE,
+                          (char *)data + SAVESTATE_M64P_SIZE - 4096 - 4 - 1024,
+                          data + SAVESTATE_M64P_SIZE - 4096 - 4,
+                          data + SAVESTATE_M64P_SIZE - 4096);
+}
+
+static int savestates_load_m64p_chunked(struct device* dev, char *filepath)
+{
+    unsigned char *savestateData;
+    unsigned int version;
+
+    savestateData = (unsigned char *)malloc(SAVESTATE_M64P_SIZE);
+    if (savestateData == NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
+        return 0;
+    }
+
+    SDL_LockMutex(savestates_lock);
+
+    if (!chunked_state_read(filepath, savestateData, SAVESTATE_M64P_SIZE))
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate data from %s", filepath);
+        free(savestateData);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    SDL_UnlockMutex(savestates_lock);
+
+    if (!savestates_check_m64p_header(savestateData, filepath, &version))
+    {
+        free(savestateData);
+        return 0;
+    }
+
+    savestates_parse_m64p_buffer(dev, version, savestateData);
+
+    free(savestateData);
+    main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
+    return 1;
+}
+
+static int savestates_load_m64p(struct device* dev, char *filepath)
+{
+    unsigned char header[44];
+    gzFile f;
+    unsigned int version;
+
+    size_t savestateSize;
+    unsigned char *savestateData, *curr;
+    char queue[1024];
+    unsigned char using_tlb_data[4];
+    unsigned char data_0001_0200[4096]; // 4k for extra state from v1.2
+
+    /* states are saved as chunked containers,
+     * older states are a single GZIP stream */
+    if (chunked_state_probe(filepath))
+        return savestates_load_m64p_chunked(dev, filepath);
+
+    SDL_LockMutex(savestates_lock);
+
+    f = osal_gzopen(filepath, "rb");
+    if(f==NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    /* Read and check Mupen64Plus magic number. */
+    if (gzread(f, header, 44) != 44)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
+        gzclose(f);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+    if (!savestates_check_m64p_header(header, filepath, &version))
+    {
+        gzclose(f);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    /* Read the rest of the savestate */
+    savestateSize = 16788244;
+    savestateData = curr = (unsigned char *)malloc(savestateSize);
+    if (savestateData == NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
+        gzclose(f);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+    if (version == 0x00010000) /* original savestate version */
+    {
+        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
+            (gzread(f, queue, sizeof(queue)) % 4) != 0)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.0 data from %s", filepath);
+            free(savestateData);
+            gzclose(f);
+            SDL_UnlockMutex(savestates_lock);
+            return 0;
+        }
+    }
+    else if (version == 0x00010100) // saves entire eventqueue plus 4-byte using_tlb flags
+    {
+        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
+            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
+            gzread(f, using_tlb_data, sizeof(using_tlb_data)) != sizeof(using_tlb_data))
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.1 data from %s", filepath);
+            free(savestateData);
+            gzclose(f);
+            SDL_UnlockMutex(savestates_lock);
+            return 0;
+        }
+    }
+    else // version >= 0x00010200  saves entire eventqueue, 4-byte using_tlb flags and extra state
+    {
+        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
+            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
+            gzread(f, using_tlb_data, sizeof(using_tlb_data)) != sizeof(using_tlb_data) ||
+            gzread(f, data_0001_0200, sizeof(data_0001_0200)) != sizeof(data_0001_0200))
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.2+ data from %s", filepath);
+            free(savestateData);
+            gzclose(f);
+            SDL_UnlockMutex(savestates_lock);
+            return 0;
+        }
+    }
+
+    gzclose(f);
+    SDL_UnlockMutex(savestates_lock);
+
+    // Parse savestate
+    savestates_parse_m64p(dev, version, savestateData, queue, using_tlb_data, data_0001_0200);
 
     free(savestateData);
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
@@ -1387,6 +1497,8 @@ static savestates_type savestates_detect_type(char *filepath)
 
     if (magic[0] == 0x1f && magic[1] == 0x8b) // GZIP header
         return savestates_type_m64p;
+    else if (chunked_state_probe(filepath)) // chunked header
+        return savestates_type_m64p;
     else if (memcmp(magic, "PK\x03\x04", 4) == 0) // ZIP header
         return savestates_type_pj64_zip;
     else if (memcmp(magic, pj64_magic, 4) == 0) // PJ64 header
@@ -1480,83 +1592,39 @@ int savestates_load(void)
 
 static void savestates_save_m64p_work(struct work_struct *work)
 {
-    gzFile f;
-    int gzres;
+    int ret;
     struct savestate_work *save = container_of(work, struct savestate_work, work);
 
     SDL_LockMutex(savestates_lock);
 
-    // Write the state to a GZIP file
-    f = osal_gzopen(save->filepath, "wb");
-
-    if (f==NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
-        free(save->data);
-        StateChanged(M64CORE_STATE_SAVECOMPLETE, 0);
-        return;
-    }
-
-    gzres = gzwrite(f, save->data, save->size);
-    if ((gzres < 0) || ((size_t)gzres != save->size))
-    {
+    // Write the state to a chunked container
+    ret = chunked_state_write(save->filepath, save->data, save->size);
+    if (ret)
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
+    else
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
-        gzclose(f);
-        free(save->data);
-        StateChanged(M64CORE_STATE_SAVECOMPLETE, 0);
-        return;
-    }
 
-    gzclose(f);
-    main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
     free(save->data);
     free(save->filepath);
     free(save);
 
     SDL_UnlockMutex(savestates_lock);
-    StateChanged(M64CORE_STATE_SAVECOMPLETE, 1);
+    StateChanged(M64CORE_STATE_SAVECOMPLETE, ret);
 }
 
-static int savestates_save_m64p(const struct device* dev, char *filepath)
+static void savestates_serialize_m64p(const struct device* dev, char *curr)
 {
     unsigned char outbuf[4];
     int i;
 
     char queue[1024];
 
-    struct savestate_work *save;
-    char *curr;
-
     /* OK to cast away const qualifier */
     const uint32_t* cp0_regs = r4300_cp0_regs((struct cp0*)&dev->r4300.cp0);
 
-    save = malloc(sizeof(*save));
-    if (!save) {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        StateChanged(M64CORE_STATE_SAVECOMPLETE, 0);
-        return 0;
-    }
-
-    save->filepath = strdup(filepath);
-
-    if(autoinc_save_slot)
-        savestates_inc_slot();
-
     save_eventqueue_infos(&dev->r4300.cp0, queue);
 
-    // Allocate memory for the save state data
-    save->size = 16788288 + sizeof(queue) + 4 + 4096;
-    save->data = curr = malloc(save->size);
-    if (save->data == NULL)
-    {
-        free(save->filepath);
-        free(save);
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        StateChanged(M64CORE_STATE_SAVECOMPLETE, 0);
-        return 0;
-    }
-
-    memset(save->data, 0, save->size);
+    memset(curr, 0, SAVESTATE_M64P_SIZE);
 
     // Write the save state data to memory
     PUTARRAY(savestate_magic, curr, unsigned char, 8);
@@ -1914,6 +1982,37 @@ static int savestates_save_m64p(const struct device* dev, char *filepath)
     /* cp0 and cp2 latch (since 1.9) */
     PUTDATA(curr, uint64_t, *r4300_cp0_latch((struct cp0*)&dev->r4300.cp0));
     PUTDATA(curr, uint64_t, *r4300_cp2_latch((struct cp2*)&dev->r4300.cp2));
+}
+
+static int savestates_save_m64p(const struct device* dev, char *filepath)
+{
+    struct savestate_work *save;
+
+    save = malloc(sizeof(*save));
+    if (!save) {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        StateChanged(M64CORE_STATE_SAVECOMPLETE, 0);
+        return 0;
+    }
+
+    save->filepath = strdup(filepath);
+
+    if(autoinc_save_slot)
+        savestates_inc_slot();
+
+    // Allocate memory for the save state data
+    save->size = SAVESTATE_M64P_SIZE;
+    save->data = malloc(save->size);
+    if (save->data == NULL)
+    {
+        free(save->filepath);
+        free(save);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        StateChanged(M64CORE_STATE_SAVECOMPLETE, 0);
+        return 0;
+    }
+
+    savestates_serialize_m64p(dev, save->data);
 
     init_work(&save->work, savestates_save_m64p_work);
     queue_work(&save->work);
@@ -2199,6 +2298,86 @@ int savestates_save(void)
     return ret;
 }
 
+int savestates_load_from_buffer(const void *buffer)
+{
+    struct device* dev = &g_dev;
+    const unsigned char *data = (const unsigned char *)buffer;
+    unsigned char *curr;
+    unsigned int version;
+
+    version = ((unsigned int)data[8] << 24) | ((unsigned int)data[9] << 16) |
+              ((unsigned int)data[10] << 8) | (unsigned int)data[11];
+
+    /* memory states are never persisted,
+     * so only the latest version is supported */
+    if (strncmp((const char *)data, savestate_magic, 8) != 0 ||
+        version != (unsigned int)savestate_latest_version ||
+        memcmp(data + 12, ROM_SETTINGS.MD5, 32) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Memory state isn't compatible with the current ROM");
+        return 0;
+    }
+
+#if defined(M64P_BIG_ENDIAN)
+    /* parsing swaps the data in place,
+     * so parse a copy to keep the caller's buffer intact */
+    curr = (unsigned char *)malloc(SAVESTATE_M64P_SIZE);
+    if (curr == NULL)
+        return 0;
+    memcpy(curr, data, SAVESTATE_M64P_SIZE);
+#else
+    /* OK to cast away const qualifier, nothing is written on little endian hosts */
+    curr = (unsigned char *)data;
+#endif
+
+    savestates_parse_m64p_buffer(dev, version, curr);
+
+#if defined(M64P_BIG_ENDIAN)
+    free(curr);
+#endif
+    return 1;
+}
+
+void savestates_save_to_buffer(void *buffer)
+{
+    savestates_serialize_m64p(&g_dev, (char *)buffer);
+}
+
+int savestates_load_memory(void)
+{
+    int ret = 0;
+
+    if (memory_state.data == NULL || memory_state.size < SAVESTATE_M64P_SIZE)
+    {
+        DebugMessage(M64MSG_ERROR, "Invalid buffer for loading state from memory");
+    }
+    else
+    {
+        ret = savestates_load_from_buffer(memory_state.data);
+    }
+
+    savestates_finish_memory_job(ret);
+    return ret;
+}
+
+int savestates_save_memory(void)
+{
+    int ret = 0;
+
+    if (memory_state.data == NULL || memory_state.size < SAVESTATE_M64P_SIZE)
+    {
+        DebugMessage(M64MSG_ERROR, "Invalid buffer for saving state to memory");
+    }
+    else
+    {
+        savestates_save_to_buffer(memory_state.data);
+        ret = 1;
+    }
+
+    savestates_finish_memory_job(ret);
+    return ret;
+}
+
 void savestates_init(void)
 {
     savestates_lock = SDL_CreateMutex();
@@ -2206,10 +2385,14 @@ void savestates_init(void)
         DebugMessage(M64MSG_ERROR, "Could not create savestates list lock");
         return;
     }
+
+    chunked_state_init();
 }
 
 void savestates_deinit(void)
 {
     SDL_DestroyMutex(savestates_lock);
+    chunked_state_deinit();
     savestates_clear_job();
+    savestates_set_memory_job(savestates_job_nothing, NULL);
 }
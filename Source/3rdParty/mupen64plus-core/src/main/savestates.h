@@ -25,6 +25,10 @@
 #ifndef __SAVESTAVES_H__
 #define __SAVESTAVES_H__
 
+#include <stddef.h>
+
+#include "api/m64p_types.h"
+
 typedef enum _savestates_job
 {
     savestates_job_nothing,
@@ -53,5 +57,19 @@ unsigned int savestates_get_slot(void);
 void savestates_set_autoinc_slot(int b);
 void savestates_inc_slot(void);
 
+/* memory jobs are independent of the file jobs above,
+ * they never compress the state nor touch the filesystem */
+size_t savestates_get_memory_size(void);
+savestates_job savestates_get_memory_job(void);
+int savestates_set_memory_job(savestates_job j, const m64p_state_memory *mem);
+
+int savestates_load_memory(void);
+int savestates_save_memory(void);
+
+/* saves to or loads from a buffer of savestates_get_memory_size() bytes
+ * right away, only call these where a savestate job would be run */
+void savestates_save_to_buffer(void *buffer);
+int savestates_load_from_buffer(const void *buffer);
+
 #endif /* __SAVESTAVES_H__ */
 
@@ -83,6 +83,47 @@ file_status_t write_to_file(const char *filename, const void *data, size_t size)
     return file_ok;
 }
 
+file_status_t write_to_file_safely(const char *filename, const void *data, size_t size)
+{
+    char *tmp_filename;
+    FILE *f;
+
+    tmp_filename = formatstr("%s.tmp", filename);
+    if (tmp_filename == NULL)
+    {
+        return file_open_error;
+    }
+
+    f = osal_file_open(tmp_filename, "wb");
+    if (f == NULL)
+    {
+        free(tmp_filename);
+        return file_open_error;
+    }
+
+    if (fwrite(data, 1, size, f) != size ||
+        fflush(f) != 0 ||
+        osal_file_sync(f) != 0)
+    {
+        fclose(f);
+        remove(tmp_filename);
+        free(tmp_filename);
+        return file_write_error;
+    }
+
+    fclose(f);
+
+    if (osal_file_replace(tmp_filename, filename) != 0)
+    {
+        remove(tmp_filename);
+        free(tmp_filename);
+        return file_write_error;
+    }
+
+    free(tmp_filename);
+    return file_ok;
+}
+
 
 file_status_t write_chunk_to_file(const char *filename, const void *data, size_t size, size_t offset)
 {
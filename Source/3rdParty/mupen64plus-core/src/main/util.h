@@ -61,6 +61,14 @@ file_status_t read_from_file(const char *filename, void *data, size_t size);
  */
 file_status_t write_to_file(const char *filename, const void *data, size_t size);
 
+/** write_to_file_safely
+ *    writes the specified number of bytes to a temporary file,
+ *    flushes it to disk and then replaces the file with it,
+ *    so the file is never left partially written.
+ *    returns zero on success, nonzero on failure
+ */
+file_status_t write_to_file_safely(const char *filename, const void *data, size_t size);
+
 /** write_chunk_to_file
  *    opens a file, seek to offset and writes the specified number of bytes.
  *    returns zero on success, nonzero on failure
@@ -65,6 +65,15 @@ extern const char * osal_get_user_datapath(void);
 extern const char * osal_get_user_cachepath(void);
 
 extern FILE * osal_file_open (const char *filename, const char *mode);
+/* Flushes the written data of the file to disk.
+ * Returns zero on success, nonzero on failure.
+ */
+extern int osal_file_sync(FILE *file);
+/* Replaces the destination file with the source file,
+ * when supported by the OS this is done atomically.
+ * Returns zero on success, nonzero on failure.
+ */
+extern int osal_file_replace(const char *src, const char *dst);
 extern gzFile osal_gzopen(const char *filename, const char *mode);
 
 #endif /* OSAL_FILES_H */
@@ -237,6 +237,16 @@ FILE * osal_file_open(const char *filename, const char *mode)
     return fopen (filename, mode);
 }
 
+int osal_file_sync(FILE *file)
+{
+    return fsync(fileno(file));
+}
+
+int osal_file_replace(const char *src, const char *dst)
+{
+    return rename(src, dst);
+}
+
 gzFile osal_gzopen(const char *filename, const char *mode)
 {
     return gzopen(filename, mode);
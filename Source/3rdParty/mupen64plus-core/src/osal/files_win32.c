@@ -24,6 +24,7 @@
  */
 
 #include <direct.h>
+#include <io.h>
 #include <shlobj.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -214,6 +215,20 @@ FILE * osal_file_open ( const char * filename, const char * mode )
     return _wfopen (wstr_filename, wstr_mode);
 }
 
+int osal_file_sync(FILE *file)
+{
+    return _commit(_fileno(file));
+}
+
+int osal_file_replace(const char *src, const char *dst)
+{
+    wchar_t wstr_src[PATH_MAX];
+    wchar_t wstr_dst[PATH_MAX];
+    MultiByteToWideChar(CP_UTF8, 0, src, -1, wstr_src, PATH_MAX);
+    MultiByteToWideChar(CP_UTF8, 0, dst, -1, wstr_dst, PATH_MAX);
+    return MoveFileExW(wstr_src, wstr_dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+}
+
 gzFile osal_gzopen(const char *filename, const char *mode)
 {
     wchar_t wstr_filename[PATH_MAX];
@@ -0,0 +1,270 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - interrupt_bench.c                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2025 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Microbenchmark of the r4300 interrupt queue.
+ *
+ * It compares the interrupt queue against a plain sorted linked list, which
+ * looks up events by walking the list, using a workload similar to what
+ * games generate:
+ * the first event is handled and rescheduled, and some events are
+ * removed by type and added again. Events are looked up by type before
+ * they are added, like add_interrupt_event_count does to warn about
+ * duplicate events. Both queues have to handle the events in the same order.
+ *
+ * Build with:
+ *   cc -O3 -flto -I../src -o interrupt_bench interrupt_bench.c ../src/device/r4300/interrupt_queue.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "device/r4300/interrupt_queue.h"
+
+#define BENCH_TYPES      15
+#define BENCH_ITERATIONS 20000000
+
+static const int event_types[BENCH_TYPES] = {
+    0x0001, 0x0002, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080, 0x0100, 0x0800,
+    0x0004, 0x0200, 0x0400, 0x1000, 0x2000, 0x4000
+};
+
+/***************************************************************************
+ * Sorted linked list without type buckets
+ **************************************************************************/
+
+struct list_node
+{
+    struct interrupt_event data;
+    struct list_node* next;
+};
+
+struct list_queue
+{
+    struct list_node nodes[INTERRUPT_NODES_POOL_CAPACITY];
+    struct list_node* stack[INTERRUPT_NODES_POOL_CAPACITY];
+    size_t index;
+    struct list_node* first;
+    unsigned int base;
+};
+
+static void list_clear(struct list_queue* q)
+{
+    size_t i;
+
+    for (i = 0; i < INTERRUPT_NODES_POOL_CAPACITY; ++i) {
+        q->stack[i] = &q->nodes[i];
+    }
+
+    q->index = 0;
+    q->first = NULL;
+    q->base = 0;
+}
+
+static int list_before(const struct list_queue* q, unsigned int evt1, unsigned int evt2)
+{
+    return (evt1 - q->base) < (evt2 - q->base);
+}
+
+static void list_push(struct list_queue* q, int type, unsigned int count)
+{
+    struct list_node* event = q->stack[q->index++];
+    struct list_node* e;
+
+    event->data.type = type;
+    event->data.count = count;
+
+    if (q->first == NULL || list_before(q, count, q->first->data.count))
+    {
+        event->next = q->first;
+        q->first = event;
+        return;
+    }
+
+    for (e = q->first; e->next != NULL && !list_before(q, count, e->next->data.count); e = e->next);
+
+    event->next = e->next;
+    e->next = event;
+}
+
+static void list_pop(struct list_queue* q)
+{
+    struct list_node* e = q->first;
+    q->first = e->next;
+    q->stack[--q->index] = e;
+}
+
+static unsigned int* list_find(const struct list_queue* q, int type)
+{
+    struct list_node* e;
+
+    for (e = q->first; e != NULL && e->data.type != type; e = e->next);
+
+    return (e != NULL) ? &e->data.count : NULL;
+}
+
+static void list_remove(struct list_queue* q, int type)
+{
+    struct list_node** link;
+
+    for (link = &q->first; *link != NULL; link = &(*link)->next)
+    {
+        if ((*link)->data.type == type)
+        {
+            struct list_node* e = *link;
+            *link = e->next;
+            q->stack[--q->index] = e;
+            return;
+        }
+    }
+}
+
+/***************************************************************************
+ * Benchmark
+ **************************************************************************/
+
+static unsigned int next_random(unsigned int* state)
+{
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+static double elapsed_ns(clock_t start)
+{
+    return (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / BENCH_ITERATIONS;
+}
+
+static unsigned int bench_list(size_t types, double* ns)
+{
+    static struct list_queue q;
+    unsigned int random = 1;
+    unsigned int checksum = 0;
+    const struct interrupt_event* first;
+    clock_t start;
+    size_t i;
+    int type;
+
+    list_clear(&q);
+    for (i = 0; i < types; ++i) {
+        list_push(&q, event_types[i], next_random(&random) % 100000);
+    }
+
+    start = clock();
+
+    for (i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        first = &q.first->data;
+        type = first->type;
+        q.base = first->count;
+        checksum = checksum * 31 + (unsigned int)type;
+
+        list_pop(&q);
+        if (list_find(&q, type) == NULL) {
+            list_push(&q, type, q.base + 1 + next_random(&random) % 100000);
+        }
+
+        /* reschedule a random event, like AI and VI register writes do */
+        type = event_types[next_random(&random) % types];
+        if (list_find(&q, type) != NULL)
+        {
+            list_remove(&q, type);
+            if (list_find(&q, type) == NULL) {
+                list_push(&q, type, q.base + next_random(&random) % 100000);
+            }
+        }
+    }
+
+    *ns = elapsed_ns(start);
+    return checksum;
+}
+
+static unsigned int bench_queue(size_t types, double* ns)
+{
+    static struct interrupt_queue q;
+    unsigned int random = 1;
+    unsigned int checksum = 0;
+    const struct interrupt_event* first;
+    struct node* e;
+    clock_t start;
+    size_t i;
+    int type;
+
+    clear_interrupt_queue(&q);
+    for (i = 0; i < types; ++i) {
+        push_interrupt_queue(&q, event_types[i], next_random(&random) % 100000);
+    }
+
+    start = clock();
+
+    for (i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        first = first_interrupt_queue(&q);
+        type = first->type;
+        q.base = first->count;
+        checksum = checksum * 31 + (unsigned int)type;
+
+        pop_interrupt_queue(&q);
+        if (find_interrupt_queue(&q, type) == NULL) {
+            push_interrupt_queue(&q, type, q.base + 1 + next_random(&random) % 100000);
+        }
+
+        /* reschedule a random event, like AI and VI register writes do */
+        type = event_types[next_random(&random) % types];
+        if ((e = find_interrupt_queue(&q, type)) != NULL)
+        {
+            remove_interrupt_queue(&q, e);
+            if (find_interrupt_queue(&q, type) == NULL) {
+                push_interrupt_queue(&q, type, q.base + next_random(&random) % 100000);
+            }
+        }
+    }
+
+    *ns = elapsed_ns(start);
+    return checksum;
+}
+
+int main(void)
+{
+    static const size_t event_counts[] = { 4, 9, BENCH_TYPES };
+    double list_ns, queue_ns;
+    unsigned int list_checksum, queue_checksum;
+    size_t i;
+
+    printf("%d iterations\n", BENCH_ITERATIONS);
+    printf("events   sorted list   interrupt queue\n");
+
+    for (i = 0; i < sizeof(event_counts) / sizeof(event_counts[0]); ++i)
+    {
+        list_checksum = bench_list(event_counts[i], &list_ns);
+        queue_checksum = bench_queue(event_counts[i], &queue_ns);
+
+        printf("%6u   %8.1f ns   %12.1f ns\n", (unsigned int)event_counts[i], list_ns, queue_ns);
+
+        if (list_checksum != queue_checksum)
+        {
+            printf("error: events were handled in a different order\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
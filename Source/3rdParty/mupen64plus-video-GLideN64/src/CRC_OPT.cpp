@@ -1,7 +1,13 @@
+#include <string.h>
 #include "CRC.h"
 #define XXH_INLINE_ALL
 #include "xxHash/xxhash.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CRC_OPT_SSE2
+#include <emmintrin.h>
+#endif
+
 #define CRC32_POLYNOMIAL     0x04C11DB7
 
 unsigned int CRCTable[ 256 ];
@@ -51,12 +57,42 @@ u64 CRC_Calculate( u64 crc, const void * buffer, u32 count )
 	return XXH3_64bits_withSeed(buffer, count, crc);
 }
 
+#ifdef CRC_OPT_SSE2
+// Gathers the first 16-bit word of 4 consecutive 64-bit palette entries
+static inline __m128i GatherPaletteEntries(const u8 * p)
+{
+	const __m128i lo = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)p), _MM_SHUFFLE(3, 1, 2, 0));
+	const __m128i hi = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(p + 16)), _MM_SHUFFLE(3, 1, 2, 0));
+	const __m128i entries = _mm_unpacklo_epi64(lo, hi);
+	// sign extend so packs_epi32 doesn't saturate
+	return _mm_srai_epi32(_mm_slli_epi32(entries, 16), 16);
+}
+#endif // CRC_OPT_SSE2
+
+// Palette entries are 64-bit apart in TMEM, only their first 16-bit word
+// is hashed. The words are gathered into a contiguous buffer first,
+// so a palette of 16 entries is hashed with a single call.
 u64 CRC_CalculatePalette( u64 crc, const void * buffer, u32 count )
 {
-	u8 *p = (u8*) buffer;
-	while (count--) {
-		crc = XXH3_64bits_withSeed(p, 2, crc);
-		p += 8;
+	const u8 *p = (const u8*) buffer;
+	u16 entries[16];
+
+	while (count > 0) {
+		u32 n = 0;
+#ifdef CRC_OPT_SSE2
+		for (; n + 8 <= count && n < 16; n += 8) {
+			const __m128i packed = _mm_packs_epi32(GatherPaletteEntries(p), GatherPaletteEntries(p + 32));
+			_mm_storeu_si128((__m128i*)&entries[n], packed);
+			p += 64;
+		}
+#endif // CRC_OPT_SSE2
+		for (; n < count && n < 16; ++n) {
+			memcpy(&entries[n], p, sizeof(u16));
+			p += 8;
+		}
+
+		crc = XXH3_64bits_withSeed(entries, n * sizeof(u16), crc);
+		count -= n;
 	}
 	return crc;
 }
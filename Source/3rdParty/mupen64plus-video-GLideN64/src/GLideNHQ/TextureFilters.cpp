@@ -814,3 +814,75 @@ void filter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, u
 	return;
 	}
 }
+
+static uint32 filter_8888_scale(uint32 filter)
+{
+	switch (filter & ENHANCEMENT_MASK) {
+	case NO_ENHANCEMENT:
+		return 1;
+	case BRZ3X_ENHANCEMENT:
+		return 3;
+	case HQ4X_ENHANCEMENT:
+	case BRZ4X_ENHANCEMENT:
+		return 4;
+	case BRZ5X_ENHANCEMENT:
+		return 5;
+	case BRZ6X_ENHANCEMENT:
+		return 6;
+	}
+	return 2;
+}
+
+/* rows above and below a tile which filter_8888 looks at */
+static uint32 filter_8888_halo(uint32 filter)
+{
+	uint32 halo = 1;
+
+	switch (filter & ENHANCEMENT_MASK) {
+	case X2SAI_ENHANCEMENT:
+	case BRZ2X_ENHANCEMENT:
+	case BRZ3X_ENHANCEMENT:
+	case BRZ4X_ENHANCEMENT:
+	case BRZ5X_ENHANCEMENT:
+	case BRZ6X_ENHANCEMENT:
+		halo = 2;
+	break;
+	case NO_ENHANCEMENT:
+		/* these filter every other row, so the tile has to start on an even row */
+		if ((filter & SMOOTH_FILTER_MASK) == SMOOTH_FILTER_1 || (filter & SMOOTH_FILTER_MASK) == SMOOTH_FILTER_2)
+			halo = 2;
+	break;
+	}
+
+	if (filter & DEPOSTERIZE)
+		halo += 2;
+
+	return halo;
+}
+
+void filter_8888_tile(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter, uint32 threadId, uint32 top, uint32 height)
+{
+	const uint32 scale = filter_8888_scale(filter);
+	const uint32 destRow = srcwidth * scale * scale;
+
+	/* xBRZ scales slices of the texture by itself */
+	if ((filter & ENHANCEMENT_MASK) >= BRZ2X_ENHANCEMENT && (filter & ENHANCEMENT_MASK) <= BRZ6X_ENHANCEMENT && !(filter & DEPOSTERIZE)) {
+		xbrz::scale(scale, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR,
+					xbrz::ScalerCfg(), top, top + height);
+		return;
+	}
+
+	/* the other filters treat the tile edges as texture edges, so the tile
+	 * is filtered together with the rows around it and only its rows are kept */
+	const uint32 halo = filter_8888_halo(filter);
+	const uint32 first = (top > halo) ? top - halo : 0;
+	const uint32 last = (top + height + halo < srcheight) ? top + height + halo : srcheight;
+	uint32 *tile = TxMemBuf::getInstance()->getThreadBuf(threadId, 2, destRow * (last - first));
+	if (tile == nullptr) {
+		filter_8888(src + srcwidth * top, srcwidth, height, dest + destRow * top, filter, threadId);
+		return;
+	}
+
+	filter_8888(src + srcwidth * first, srcwidth, last - first, tile, filter, threadId);
+	memcpy(dest + destRow * top, tile + destRow * (top - first), (destRow * height) << 2);
+}
@@ -55,6 +55,10 @@ void SmoothFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *d
 /* helper */
 void filter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter, uint32 threadId);
 
+/* filters rows top to top + height - 1 of src into the same rows of dest,
+ * with the same result as filtering the whole texture with filter_8888 */
+void filter_8888_tile(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter, uint32 threadId, uint32 top, uint32 height);
+
 #if !_16BPP_HACK
 void hq4x_init(void);
 void hq4x_4444(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int SrcPPL, int BpL);
@@ -26,7 +26,9 @@
 #endif
 
 #include <fstream>
+#include <new>
 #include <unordered_map>
+#include <vector>
 #include <zlib.h>
 #include <memory.h>
 #include <stdlib.h>
@@ -58,9 +60,55 @@ public:
 	virtual uint64 size() const = 0;
 	virtual uint64 totalSize() const = 0;
 	virtual uint64 cacheLimit() const = 0;
+	virtual GHQCacheStats stats() const = 0;
 };
 
 
+/************************** TxArena *************************************/
+
+/* Hands out texture data from large blocks, which are only released
+ * all at once. Used for caches without a size limit, where textures
+ * are never evicted one by one.
+ */
+class TxArena
+{
+public:
+	uint8 *alloc(uint32 size);
+	void clear();
+
+private:
+	static const uint32 _blockSize = 32 * 1024 * 1024;
+	std::vector<std::unique_ptr<uint8[]>> _blocks;
+	uint32 _used = _blockSize;
+};
+
+uint8 *TxArena::alloc(uint32 size)
+{
+	/* large textures would waste too much of a block */
+	if (size > _blockSize / 16)
+		return nullptr;
+
+	size = (size + 15) & ~15;
+	if (_used + size > _blockSize) {
+		uint8 *block = new (std::nothrow) uint8[_blockSize];
+		if (block == nullptr)
+			return nullptr;
+		_blocks.emplace_back(block);
+		_used = 0;
+	}
+
+	uint8 *data = _blocks.back().get() + _used;
+	_used += size;
+	return data;
+}
+
+void TxArena::clear()
+{
+	_blocks.clear();
+	_used = _blockSize;
+}
+
+
 /************************** TxMemoryCache *************************************/
 
 class TxMemoryCache : public TxCacheImpl
@@ -84,14 +132,19 @@ public:
 	uint64 size() const  override { return _cache.size(); }
 	uint64 totalSize() const  override { return _totalSize; }
 	uint64 cacheLimit() const  override { return _cacheLimit; }
+	GHQCacheStats stats() const override { return _stats; }
 	uint32 getOptions() const override { return _options; }
 	void setOptions(uint32 options) override { _options = options; }
 
 private:
 	struct TXCACHE {
+		uint64 checksum;
 		int size;
 		GHQTexInfo info;
-		std::list<uint64>::iterator it;
+		bool inArena;
+		/* links in the LRU list */
+		TXCACHE *prev;
+		TXCACHE *next;
 	};
 
 	uint32 _options;
@@ -102,10 +155,19 @@ private:
 	uint64 _cacheLimit;
 	uint64 _totalSize;
 
-	using Cache = std::multimap<uint64, TXCACHE*>;
+	using Cache = std::unordered_multimap<uint64, TXCACHE*>;
 	Cache _cache;
 	Cache::const_iterator find(Checksum checksum, N64FormatSize n64FmtSz) const;
-	std::list<uint64> _cachelist;
+	void remove(Cache::const_iterator itMap);
+
+	/* least recently used texture at the head, most recently used at the tail */
+	TXCACHE *_lruHead = nullptr;
+	TXCACHE *_lruTail = nullptr;
+	void lruLink(TXCACHE *txCache);
+	void lruUnlink(TXCACHE *txCache);
+
+	TxArena _arena;
+	GHQCacheStats _stats;
 
 	uint8 *_gzdest0 = nullptr;
 	uint8 *_gzdest1 = nullptr;
@@ -190,27 +252,16 @@ bool TxMemoryCache::add(Checksum checksum, GHQTexInfo* info, int dataSize)
 	/* if cache size exceeds limit, remove old cache */
 	if (_cacheLimit != 0) {
 		_totalSize += dataSize;
-		if ((_totalSize > _cacheLimit) && !_cachelist.empty()) {
-			/* _cachelist is arranged so that frequently used textures are in the back */
-			std::list<uint64>::iterator itList = _cachelist.begin();
-			while (itList != _cachelist.end()) {
-				/* find it in _cache */
-				auto itMap = _cache.find(*itList);
-				if (itMap != _cache.end()) {
-					/* yep we have it. remove it. */
-					_totalSize -= (*itMap).second->size;
-					free((*itMap).second->info.data);
-					delete (*itMap).second;
-					_cache.erase(itMap);
-				}
-				itList++;
-
-				/* check if memory cache has enough space */
-				if (_totalSize <= _cacheLimit)
-					break;
+		if (_totalSize > _cacheLimit) {
+			while (_lruHead != nullptr && _totalSize > _cacheLimit) {
+				/* find the exact entry, there may be several for one checksum */
+				auto range = _cache.equal_range(_lruHead->checksum);
+				auto itMap = range.first;
+				while (itMap->second != _lruHead)
+					++itMap;
+				remove(itMap);
+				++_stats.evictions;
 			}
-			/* remove from _cachelist */
-			_cachelist.erase(_cachelist.begin(), itList);
 
 			DBG_INFO(80, wst("+++++++++\n"));
 		}
@@ -218,7 +269,14 @@ bool TxMemoryCache::add(Checksum checksum, GHQTexInfo* info, int dataSize)
 	}
 
 	/* cache it */
-	uint8 *tmpdata = (uint8*)malloc(dataSize);
+	bool inArena = false;
+	uint8 *tmpdata = nullptr;
+	if (_cacheLimit == 0) {
+		tmpdata = _arena.alloc(dataSize);
+		inArena = tmpdata != nullptr;
+	}
+	if (tmpdata == nullptr)
+		tmpdata = (uint8*)malloc(dataSize);
 	if (tmpdata == nullptr)
 		return false;
 
@@ -229,31 +287,24 @@ bool TxMemoryCache::add(Checksum checksum, GHQTexInfo* info, int dataSize)
 	memcpy(tmpdata, dest, dataSize);
 
 	/* copy it */
+	txCache->checksum = checksum;
 	txCache->info = *info;
 	txCache->info.data = tmpdata;
 	txCache->info.format = format;
 	txCache->size = dataSize;
+	txCache->inArena = inArena;
 
 	/* add to cache */
-	if (_cacheLimit != 0) {
-		_cachelist.push_back(checksum);
-		txCache->it = --(_cachelist.end());
-	}
-	/* _cache[checksum] = txCache; */
-	_cache.insert(std::map<uint64, TXCACHE*>::value_type(checksum, txCache));
+	lruLink(txCache);
+	_cache.insert(Cache::value_type(checksum, txCache));
 
 #ifdef DEBUG
 	DBG_INFO(80, wst("[%5d] added!! crc:%08X %08X %d x %d gfmt:%x total:%.02fmb\n"),
 		_cache.size(), checksum._palette, checksum._texture,
 		info->width, info->height, info->format & 0xffff, (double)_totalSize / 1000000);
 
-	if (_cacheLimit != 0) {
+	if (_cacheLimit != 0)
 		DBG_INFO(80, wst("cache max config:%.02fmb\n"), (double)_cacheLimit / 1000000);
-
-		if (_cache.size() != _cachelist.size()) {
-			DBG_INFO(80, wst("Error: cache/cachelist mismatch! (%d/%d)\n"), _cache.size(), _cachelist.size());
-		}
-	}
 #endif
 
 	/* total cache size */
@@ -275,24 +326,65 @@ TxMemoryCache::Cache::const_iterator TxMemoryCache::find(Checksum checksum, N64F
 	return _cache.cend();
 }
 
+void TxMemoryCache::remove(Cache::const_iterator itMap)
+{
+	TXCACHE *txCache = itMap->second;
+	lruUnlink(txCache);
+	/* arena memory is only released by clear(), so the data of
+	 * removed arena entries stays allocated until then. Only
+	 * uncapped caches (_cacheLimit == 0) use the arena, and
+	 * those never evict, so only del() (i.e. replacing hires
+	 * textures while loading a pack) leaves such holes */
+	if (!txCache->inArena)
+		free(txCache->info.data);
+	_totalSize -= txCache->size;
+	delete txCache;
+	_cache.erase(itMap);
+}
+
+void TxMemoryCache::lruLink(TXCACHE *txCache)
+{
+	txCache->prev = _lruTail;
+	txCache->next = nullptr;
+	if (_lruTail != nullptr)
+		_lruTail->next = txCache;
+	else
+		_lruHead = txCache;
+	_lruTail = txCache;
+}
+
+void TxMemoryCache::lruUnlink(TXCACHE *txCache)
+{
+	if (txCache->prev != nullptr)
+		txCache->prev->next = txCache->next;
+	else
+		_lruHead = txCache->next;
+	if (txCache->next != nullptr)
+		txCache->next->prev = txCache->prev;
+	else
+		_lruTail = txCache->prev;
+}
+
 bool TxMemoryCache::get(Checksum checksum, N64FormatSize n64FmtSz, GHQTexInfo *info)
 {
-	if (!checksum || _cache.empty())
+	if (!checksum)
 		return false;
 
 	/* find a match in cache */
 	auto itMap = find(checksum, n64FmtSz);
-	if (itMap == _cache.end())
+	if (itMap == _cache.end()) {
+		++_stats.misses;
 		return false;
+	}
 
 	/* yep, we've got it. */
 	*info = ((*itMap).second)->info;
+	++_stats.hits;
 
-	/* push it to the back of the list */
-	if (_cacheLimit != 0) {
-		_cachelist.erase(((*itMap).second)->it);
-		_cachelist.push_back(checksum);
-		((*itMap).second)->it = --(_cachelist.end());
+	/* move it to the tail of the list */
+	if (_lruTail != itMap->second) {
+		lruUnlink(itMap->second);
+		lruLink(itMap->second);
 	}
 
 	/* zlib decompress it */
@@ -419,6 +511,8 @@ bool TxMemoryCache::load(const wchar_t *path, const wchar_t *filename, int confi
 		}
 
 		if (tmpconfig == config || force) {
+			/* add() copies the data, so one read buffer serves all textures */
+			std::vector<uint8> buffer;
 			do {
 				GHQTexInfo tmpInfo;
 
@@ -435,17 +529,15 @@ bool TxMemoryCache::load(const wchar_t *path, const wchar_t *filename, int confi
 
 				gzread(gzfp, &dataSize, 4);
 
-				tmpInfo.data = (uint8*)malloc(dataSize);
-				if (tmpInfo.data) {
-					gzread(gzfp, tmpInfo.data, dataSize);
+				if (dataSize <= 0)
+					break;
 
-					/* add to memory cache */
-					add(checksum, &tmpInfo, (tmpInfo.format & GL_TEXFMT_GZ) ? dataSize : 0);
+				buffer.resize(dataSize);
+				tmpInfo.data = buffer.data();
+				gzread(gzfp, tmpInfo.data, dataSize);
 
-					free(tmpInfo.data);
-				} else {
-					gzseek(gzfp, dataSize, SEEK_CUR);
-				}
+				/* add to memory cache */
+				add(checksum, &tmpInfo, (tmpInfo.format & GL_TEXFMT_GZ) ? dataSize : 0);
 
 				/* skip in between to prevent the loop from being tied down to vsync */
 				if (_callback && (!(_cache.size() % 100) || gzeof(gzfp)))
@@ -466,16 +558,8 @@ bool TxMemoryCache::del(Checksum checksum)
 
 	auto itMap = _cache.find(checksum);
 	if (itMap != _cache.end()) {
-
-		/* for texture cache (not hi-res cache) */
-		if (!_cachelist.empty())
-			_cachelist.erase(((*itMap).second)->it);
-
 		/* remove from cache */
-		free((*itMap).second->info.data);
-		_totalSize -= (*itMap).second->size;
-		delete (*itMap).second;
-		_cache.erase(itMap);
+		remove(itMap);
 
 		DBG_INFO(80, wst("removed from cache: checksum = %08X %08X\n"), checksum._palette, checksum._texture);
 
@@ -495,16 +579,17 @@ void TxMemoryCache::clear()
 	if (!_cache.empty()) {
 		auto itMap = _cache.begin();
 		while (itMap != _cache.end()) {
-			free((*itMap).second->info.data);
+			if (!(*itMap).second->inArena)
+				free((*itMap).second->info.data);
 			delete (*itMap).second;
 			itMap++;
 		}
 		_cache.clear();
 	}
 
-	if (!_cachelist.empty())
-		_cachelist.clear();
-
+	_lruHead = nullptr;
+	_lruTail = nullptr;
+	_arena.clear();
 	_totalSize = 0;
 }
 
@@ -529,6 +614,7 @@ public:
 	uint64 size() const override { return _storage.size(); }
 	uint64 totalSize() const override { return _totalSize; }
 	uint64 cacheLimit() const override { return 0UL; }
+	GHQCacheStats stats() const override { return _stats; }
 	uint32 getOptions() const override { return _options; }
 	void setOptions(uint32 options) override { _options = options; }
 
@@ -544,6 +630,7 @@ private:
 	std::string _fullPath;
 	dispInfoFuncExt _callback;
 	uint64 _totalSize = 0;
+	GHQCacheStats _stats;
 
 	union StorageOffset
 	{
@@ -815,20 +902,26 @@ TxFileStorage::StorageMap::const_iterator TxFileStorage::find(Checksum checksum,
 
 bool TxFileStorage::get(Checksum checksum, N64FormatSize n64FmtSz, GHQTexInfo *info)
 {
-	if (!checksum || _storage.empty())
+	if (!checksum)
 		return false;
 
 	/* find a match in storage */
 	auto itMap = find(checksum, n64FmtSz);
-	if (itMap == _storage.end())
+	if (itMap == _storage.end()) {
+		++_stats.misses;
 		return false;
+	}
 
 	if (_outfile.is_open() || !_infile.is_open())
 		if (!open(true))
 			return false;
 
 	_infile.seekg(itMap->second._offset, std::ifstream::beg);
-	return readData(*info);
+	if (!readData(*info))
+		return false;
+
+	++_stats.hits;
+	return true;
 }
 
 bool TxFileStorage::save(const wchar_t *path, const wchar_t *filename, int config)
@@ -997,6 +1090,11 @@ uint64 TxCache::cacheLimit() const
 	return _pImpl->cacheLimit();
 }
 
+GHQCacheStats TxCache::stats() const
+{
+	return _pImpl->stats();
+}
+
 bool TxCache::save()
 {
 	return _pImpl->save(_cachePath.c_str(), _getFileName().c_str(), _getConfig());
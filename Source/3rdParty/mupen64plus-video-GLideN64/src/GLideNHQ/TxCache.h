@@ -63,6 +63,7 @@ public:
 	bool add(Checksum checksum, GHQTexInfo *info, int dataSize = 0);
 	bool get(Checksum checksum, N64FormatSize n64FmtSz, GHQTexInfo *info);
 	bool empty() const;
+	GHQCacheStats stats() const;
 };
 
 #endif /* __TXCACHE_H__ */
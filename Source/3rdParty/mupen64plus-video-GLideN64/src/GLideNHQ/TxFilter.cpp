@@ -25,8 +25,6 @@
 #pragma warning(disable: 4786)
 #endif
 
-#include <functional>
-#include <thread>
 #include <stdlib.h>
 #include <assert.h>
 
@@ -43,6 +41,9 @@ void TxFilter::clear()
 	/* clear texture cache */
 	delete _txTexCache;
 
+	/* stop worker threads */
+	TxThreadPool::getInstance()->shutdown();
+
 	/* free memory */
 	TxMemBuf::getInstance()->shutdown();
 
@@ -309,40 +310,13 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 				uint8 *_texture = texture;
 				uint8 *_tmptex  = tmptex;
 
-				unsigned int numcore = _numcore;
-				unsigned int blkrow = 0;
-				while (numcore > 1 && blkrow == 0) {
-					blkrow = (srcheight >> 2) / numcore;
-					numcore--;
-				}
-				if (blkrow > 0 && numcore > 1) {
-					std::thread *thrd[MAX_NUMCORE];
-					unsigned int i;
-					int blkheight = blkrow << 2;
-					unsigned int srcStride = (srcwidth * blkheight) << 2;
-					unsigned int destStride = srcStride * scale * scale;
-					for (i = 0; i < numcore - 1; i++) {
-						thrd[i] = new std::thread(std::bind(filter_8888,
-																(uint32*)_texture,
-																srcwidth,
-																blkheight,
-																(uint32*)_tmptex,
-																filter,
-																i));
-						_texture += srcStride;
-						_tmptex  += destStride;
-					}
-					thrd[i] = new std::thread(std::bind(filter_8888,
-															(uint32*)_texture,
-															srcwidth,
-															srcheight - blkheight * i,
-															(uint32*)_tmptex,
-															filter,
-															i));
-					for (i = 0; i < numcore; i++) {
-						thrd[i]->join();
-						delete thrd[i];
-					}
+				const unsigned int numtiles = (srcheight + TX_TILE_HEIGHT - 1) / TX_TILE_HEIGHT;
+				if (_numcore > 1 && numtiles > 1) {
+					TxThreadPool::getInstance()->run(numtiles, [&](uint32 i, uint32 slot) {
+						const int top = TX_TILE_HEIGHT * i;
+						filter_8888_tile((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter, slot,
+										 top, (srcheight - top < TX_TILE_HEIGHT) ? srcheight - top : TX_TILE_HEIGHT);
+					});
 				} else {
 					filter_8888((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter, 0);
 				}
@@ -673,3 +647,18 @@ TxFilter::dumpcache()
 	_txHiResLoader->dump();
 #endif
 }
+
+void
+TxFilter::cachestats(GHQCacheStats *texCache, GHQCacheStats *hiresCache) const
+{
+	if (texCache)
+		*texCache = _txTexCache->stats();
+
+	if (hiresCache) {
+#if HIRES_TEXTURE
+		*hiresCache = _txHiResLoader->stats();
+#else
+		*hiresCache = GHQCacheStats();
+#endif
+	}
+}
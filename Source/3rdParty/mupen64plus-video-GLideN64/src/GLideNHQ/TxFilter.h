@@ -83,6 +83,7 @@ public:
 				ColorFormat gfmt, N64FormatSize n64FmtSz, Checksum r_crc64, boolean isStrongCrc);
   boolean reloadhirestex();
   void dumpcache();
+  void cachestats(GHQCacheStats *texCache, GHQCacheStats *hiresCache) const;
 };
 
 #endif /* __TXFILTER_H__ */
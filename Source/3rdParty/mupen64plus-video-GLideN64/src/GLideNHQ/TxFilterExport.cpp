@@ -127,6 +127,13 @@ txfilter_dumpcache(void)
 	  txFilter->dumpcache();
 }
 
+TAPI void TAPIENTRY
+txfilter_cachestats(GHQCacheStats *texCache, GHQCacheStats *hiresCache)
+{
+	if (txFilter)
+	  txFilter->cachestats(texCache, hiresCache);
+}
+
 
 #ifdef __cplusplus
 }
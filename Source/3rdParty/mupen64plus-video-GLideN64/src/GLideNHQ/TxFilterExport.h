@@ -165,6 +165,13 @@ struct GHQTexInfo
   N64FormatSize n64_format_size{ 0u, 0u };
 };
 
+struct GHQCacheStats
+{
+  uint64 hits{ 0u };
+  uint64 misses{ 0u };
+  uint64 evictions{ 0u };
+};
+
 /* Callback to display hires texture info.
  * Gonetz <gonetz(at)ngs.ru>
  *
@@ -240,6 +247,9 @@ txfilter_reloadhirestex();
 TAPI void TAPIENTRY
 txfilter_dumpcache(void);
 
+TAPI void TAPIENTRY
+txfilter_cachestats(GHQCacheStats *texCache, GHQCacheStats *hiresCache);
+
 #ifdef __cplusplus
 }
 #endif
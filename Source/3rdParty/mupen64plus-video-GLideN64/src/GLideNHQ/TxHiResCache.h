@@ -63,6 +63,7 @@ public:
   bool get(Checksum checksum, N64FormatSize n64FmtSz, GHQTexInfo *info) override;
   bool reload() override;
   void dump() override;
+  GHQCacheStats stats() const override { return TxCache::stats(); }
 };
 
 #endif /* __TXHIRESCACHE_H__ */
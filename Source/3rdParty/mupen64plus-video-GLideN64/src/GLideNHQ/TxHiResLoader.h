@@ -54,6 +54,7 @@ public:
 	virtual bool get(Checksum checksum, N64FormatSize n64FmtSz, GHQTexInfo *info) = 0;
 	virtual bool reload() = 0;
 	virtual void dump() = 0;
+	virtual GHQCacheStats stats() const { return GHQCacheStats(); }
 };
 
 #endif /* TXHIRESLOADER_H */
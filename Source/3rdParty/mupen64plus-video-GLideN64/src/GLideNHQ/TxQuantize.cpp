@@ -27,8 +27,6 @@
 
 /* NOTE: The codes are not optimized. They can be made faster. */
 
-#include <functional>
-#include <thread>
 #include <assert.h>
 
 #include "TxQuantize.h"
@@ -853,38 +851,17 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat
 		} else
 			return 0;
 
-		unsigned int numcore = _numcore;
-		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
-			blkrow = (height >> 2) / numcore;
-			numcore--;
-		}
-		if (blkrow > 0 && numcore > 1) {
-			std::thread *thrd[MAX_NUMCORE];
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << (2 - bpp_shift);
-			unsigned int destStride = srcStride << bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-				thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));
-				src  += srcStride;
-				dest += destStride;
-			}
-			thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));
-			for (i = 0; i < numcore; i++) {
-				thrd[i]->join();
-				delete thrd[i];
-			}
+		const unsigned int numtiles = (height + TX_TILE_HEIGHT - 1) / TX_TILE_HEIGHT;
+		if (_numcore > 1 && numtiles > 1) {
+			const unsigned int srcRow = width << (2 - bpp_shift);
+			const unsigned int destRow = srcRow << bpp_shift;
+			TxThreadPool::getInstance()->run(numtiles, [&](uint32 i, uint32) {
+				const int top = TX_TILE_HEIGHT * i;
+				(this->*quantizer)((uint32*)(src + srcRow * top),
+								   (uint32*)(dest + destRow * top),
+								   width,
+								   (height - top < TX_TILE_HEIGHT) ? height - top : TX_TILE_HEIGHT);
+			});
 		} else {
 			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
 		}
@@ -902,38 +879,19 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat
 		} else
 			return 0;
 
-		unsigned int numcore = _numcore;
-		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
-			blkrow = (height >> 2) / numcore;
-			numcore--;
-		}
-		if (blkrow > 0 && numcore > 1) {
-			std::thread *thrd[MAX_NUMCORE];
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << 2;
-			unsigned int destStride = srcStride >> bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-				thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));
-				src  += srcStride;
-				dest += destStride;
-			}
-			thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));
-			for (i = 0; i < numcore; i++) {
-				thrd[i]->join();
-				delete thrd[i];
-			}
+		/* the error diffusion quantizers carry the error over
+		 * to the next row, so they can't be split into tiles */
+		const unsigned int numtiles = (height + TX_TILE_HEIGHT - 1) / TX_TILE_HEIGHT;
+		if (_numcore > 1 && numtiles > 1 && fastQuantizer) {
+			const unsigned int srcRow = width << 2;
+			const unsigned int destRow = srcRow >> bpp_shift;
+			TxThreadPool::getInstance()->run(numtiles, [&](uint32 i, uint32) {
+				const int top = TX_TILE_HEIGHT * i;
+				(this->*quantizer)((uint32*)(src + srcRow * top),
+								   (uint32*)(dest + destRow * top),
+								   width,
+								   (height - top < TX_TILE_HEIGHT) ? height - top : TX_TILE_HEIGHT);
+			});
 		} else {
 			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
 		}
@@ -623,7 +623,7 @@ TxMemBuf::init(int maxwidth, int maxheight)
 
 		if (_bufs.empty()) {
 			const int numcore = TxUtil::getNumberofProcessors();
-			const size_t numBuffers = numcore*2;
+			const size_t numBuffers = numcore*3;
 			_bufs.resize(numBuffers);
 		}
 	} catch(std::bad_alloc) {
@@ -664,8 +664,8 @@ TxMemBuf::size_of(uint32 num)
 uint32*
 TxMemBuf::getThreadBuf(uint32 threadIdx, uint32 num, uint32 size)
 {
-	assert(num < 2);
-	const auto idx = threadIdx * 2 + num;
+	assert(num < 3);
+	const auto idx = threadIdx * 3 + num;
 	auto& buf = _bufs[idx];
 
 	if (buf.size() < size) {
@@ -679,6 +679,97 @@ TxMemBuf::getThreadBuf(uint32 threadIdx, uint32 num, uint32 size)
 	return buf.data();
 }
 
+/*
+ * Worker threads for texture manipulations
+ ******************************************************************************/
+TxThreadPool::TxThreadPool()
+	: _job(nullptr)
+	, _numJobs(0)
+	, _nextJob(0)
+	, _pendingJobs(0)
+	, _stop(false)
+{
+}
+
+TxThreadPool::~TxThreadPool()
+{
+	shutdown();
+}
+
+void
+TxThreadPool::init()
+{
+	if (!_threads.empty())
+		return;
+
+	_stop = false;
+	const uint32 numcore = TxUtil::getNumberofProcessors();
+	for (uint32 i = 1; i < numcore; i++)
+		_threads.emplace_back(&TxThreadPool::worker, this, i);
+}
+
+void
+TxThreadPool::shutdown()
+{
+	std::lock_guard<std::mutex> runLock(_runMutex);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_jobAvailable.notify_all();
+
+	for (auto& thread : _threads)
+		thread.join();
+	_threads.clear();
+}
+
+void
+TxThreadPool::runJobs(std::unique_lock<std::mutex>& lock, uint32 slot)
+{
+	while (_nextJob < _numJobs) {
+		const uint32 job = _nextJob++;
+		lock.unlock();
+		(*_job)(job, slot);
+		lock.lock();
+		if (--_pendingJobs == 0)
+			_jobsDone.notify_all();
+	}
+}
+
+void
+TxThreadPool::worker(uint32 slot)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_jobAvailable.wait(lock, [this] { return _stop || _nextJob < _numJobs; });
+		if (_stop)
+			return;
+		runJobs(lock, slot);
+	}
+}
+
+void
+TxThreadPool::run(uint32 numJobs, const std::function<void(uint32, uint32)>& job)
+{
+	std::lock_guard<std::mutex> runLock(_runMutex);
+	init();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_job = &job;
+	_numJobs = numJobs;
+	_nextJob = 0;
+	_pendingJobs = numJobs;
+	_jobAvailable.notify_all();
+
+	runJobs(lock, 0);
+	_jobsDone.wait(lock, [this] { return _pendingJobs == 0; });
+
+	_job = nullptr;
+	_numJobs = 0;
+	_nextJob = 0;
+}
+
 void setTextureFormat(ColorFormat internalFormat, GHQTexInfo * info)
 {
 	info->format = u32(internalFormat);
@@ -27,6 +27,9 @@
 /* maximum number of CPU cores allowed */
 #define MAX_NUMCORE 8
 
+/* number of rows filtered or quantized by one worker job */
+#define TX_TILE_HEIGHT 32
+
 #include "TxInternal.h"
 
 /* extension for cache files */
@@ -34,6 +37,10 @@
 #define TEXSTREAM_EXT wst("hts")
 
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
 
 class TxUtil
 {
@@ -73,9 +80,45 @@ public:
 	void shutdown();
 	uint8 *get(uint32 num);
 	uint32 size_of(uint32 num);
+	/* each worker slot of TxThreadPool has 3 buffers */
 	uint32 *getThreadBuf(uint32 threadIdx, uint32 num, uint32 size);
 };
 
+/*
+ * Persistent worker threads for texture filtering and quantization.
+ * A batch of jobs is shared by the workers and the calling thread,
+ * every thread takes the next unprocessed job until none are left.
+ * Jobs are passed the slot of the thread running them, the calling
+ * thread has slot 0 and the workers have slots 1 to numcore - 1.
+ */
+class TxThreadPool
+{
+private:
+	std::vector<std::thread> _threads;
+	std::mutex _runMutex;
+	std::mutex _mutex;
+	std::condition_variable _jobAvailable;
+	std::condition_variable _jobsDone;
+	const std::function<void(uint32, uint32)> *_job;
+	uint32 _numJobs;
+	uint32 _nextJob;
+	uint32 _pendingJobs;
+	bool _stop;
+	TxThreadPool();
+	void init();
+	void worker(uint32 slot);
+	void runJobs(std::unique_lock<std::mutex>& lock, uint32 slot);
+public:
+	static TxThreadPool* getInstance() {
+		static TxThreadPool txThreadPool;
+		return &txThreadPool;
+	}
+	~TxThreadPool();
+	void shutdown();
+	/* calls job(0, slot) to job(numJobs - 1, slot) and returns when all have finished */
+	void run(uint32 numJobs, const std::function<void(uint32, uint32)>& job);
+};
+
 void setTextureFormat(ColorFormat internalFormat, GHQTexInfo * info);
 
 #endif /* __TXUTIL_H__ */
@@ -2,6 +2,7 @@
 #define XXH_INLINE_ALL
 #include "xxHash/xxhash.h"
 #include <arm_neon.h>
+#include <string.h>
 
 #define CRC32_POLYNOMIAL	 0x04C11DB7
 
@@ -118,11 +119,28 @@ u64 CRC_Calculate(u64 crc, const void *buffer, u32 count) {
 	return ReliableHash32NEON(buffer, count, crc);
 }
 
+// Palette entries are 64-bit apart in TMEM, only their first 16-bit word
+// is hashed. The words are gathered into a contiguous buffer first,
+// so a palette of 16 entries is hashed with a single call.
 u64 CRC_CalculatePalette(u64 crc, const void *buffer, u32 count) {
-	u8 *p = (u8 *) buffer;
-	while (count--) {
-		crc = ReliableHash32NEON(p, 2, crc);
-		p += 8;
+	const u8 *p = (const u8 *) buffer;
+	u16 entries[16] __attribute__((aligned(16)));
+
+	while (count > 0) {
+		u32 n = 0;
+		for (; n + 8 <= count && n < 16; n += 8) {
+			// lane 0 of every group of 4 halfwords is the first word of an entry
+			const uint16x8x4_t words = vld4q_u16((const u16 *) p);
+			vst1q_u16(&entries[n], words.val[0]);
+			p += 64;
+		}
+		for (; n < count && n < 16; ++n) {
+			memcpy(&entries[n], p, sizeof(u16));
+			p += 8;
+		}
+
+		crc = ReliableHash32NEON(entries, n * sizeof(u16), crc);
+		count -= n;
 	}
 	return crc;
 }
@@ -0,0 +1,18 @@
+#include "Types.h"
+#include <emmintrin.h>
+
+// Evaluates the expressions in the same order as
+// gSPTransformVector_default, so the results are identical.
+void gSPTransformVector_SSE(float vtx[4], float mtx[4][4])
+{
+	const __m128 x = _mm_set1_ps(vtx[0]);
+	const __m128 y = _mm_set1_ps(vtx[1]);
+	const __m128 z = _mm_set1_ps(vtx[2]);
+
+	__m128 out = _mm_mul_ps(x, _mm_loadu_ps(mtx[0]));
+	out = _mm_add_ps(out, _mm_mul_ps(y, _mm_loadu_ps(mtx[1])));
+	out = _mm_add_ps(out, _mm_mul_ps(z, _mm_loadu_ps(mtx[2])));
+	out = _mm_add_ps(out, _mm_loadu_ps(mtx[3]));
+
+	_mm_storeu_ps(vtx, out);
+}
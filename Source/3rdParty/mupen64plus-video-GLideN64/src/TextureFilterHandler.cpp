@@ -12,6 +12,7 @@
 #include "DisplayWindow.h"
 #include "DisplayLoadProgress.h"
 #include "wst.h"
+#include "Log.h"
 
 static
 u32 textureFilters[] = {
@@ -128,6 +129,12 @@ void TextureFilterHandler::init()
 void TextureFilterHandler::shutdown()
 {
 	if (isInited()) {
+		GHQCacheStats texCache, hiresCache;
+		txfilter_cachestats(&texCache, &hiresCache);
+		LOG(LOG_MINIMAL, "Texture cache: %llu hits, %llu misses, %llu evictions",
+			(unsigned long long)texCache.hits, (unsigned long long)texCache.misses, (unsigned long long)texCache.evictions);
+		LOG(LOG_MINIMAL, "Hires texture cache: %llu hits, %llu misses, %llu evictions",
+			(unsigned long long)hiresCache.hits, (unsigned long long)hiresCache.misses, (unsigned long long)hiresCache.evictions);
 		txfilter_shutdown();
 		m_inited = m_options = 0;
 	}
@@ -21,6 +21,11 @@
 #include "Graphics/Parameters.h"
 #include "DisplayWindow.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURES_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 using namespace graphics;
 
@@ -279,6 +284,173 @@ void GetYUV_RGBA8888(u64 * src, u32 * dst, u16 x)
 	*(dst++) = c;
 }
 
+/*
+ * Row decoders, they convert a whole row of texels per call
+ * instead of calling the texel getter through a pointer for
+ * every texel, the scalar ones are instantiated per getter
+ * so the getter is inlined into the loop
+*/
+typedef void (*GetTexelRowFunc)(u16 offset, u16 i, u8 palette, u16 width, u16 clamp, u16 mask, void* pDest);
+
+template <GetTexelFunc GetTexel, typename T>
+static inline void GetTexels(u16 offset, u16 i, u8 palette, u16 x, u16 width, u16 clamp, u16 mask, T* pDest)
+{
+	for (; x < width; ++x)
+		pDest[x] = static_cast<T>(GetTexel(offset, min(x, clamp) & mask, i, palette));
+}
+
+template <GetTexelFunc GetTexel, typename T>
+static void GetTexelRow(u16 offset, u16 i, u8 palette, u16 width, u16 clamp, u16 mask, void* pDest)
+{
+	GetTexels<GetTexel, T>(offset, i, palette, 0, width, clamp, mask, static_cast<T*>(pDest));
+}
+
+#ifdef TEXTURES_SSE2
+
+// Returns the amount of texels at the start of the row which are neither
+// clamped, masked nor wrapped around TMEM, rounded down to a multiple of 8
+static inline u16 GetContiguous16BitTexels(u32 address, u16 width, u16 clamp, u16 mask)
+{
+	u32 count = min<u32>(width, 0x800 - address);
+	count = min<u32>(count, u32(clamp) + 1);
+	count = min<u32>(count, u32(mask) + 1);
+	return static_cast<u16>(count & ~7U);
+}
+
+// Odd rows have their 32-bit words swapped in TMEM
+static inline __m128i Load16BitTexels(u32 address, u16 i)
+{
+	const u16* tmem16 = reinterpret_cast<const u16*>(TMEM);
+	const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tmem16 + address));
+	return i != 0 ? _mm_shuffle_epi32(texels, _MM_SHUFFLE(2, 3, 0, 1)) : texels;
+}
+
+static inline __m128i swapwordSSE2(__m128i color)
+{
+	return _mm_or_si128(_mm_slli_epi16(color, 8), _mm_srli_epi16(color, 8));
+}
+
+// Same result as Five2Eight for 0..31
+static inline __m128i Five2EightSSE2(__m128i color)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(color, _mm_set1_epi16(527)), _mm_set1_epi16(23)), 6);
+}
+
+static inline void StoreRGBA8888SSE2(__m128i rg, __m128i ba, u32* pDest)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), _mm_unpacklo_epi16(rg, ba));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 4), _mm_unpackhi_epi16(rg, ba));
+}
+
+static inline void RGBA5551_RGBA8888_SSE2(__m128i color, u32* pDest)
+{
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	color = swapwordSSE2(color);
+	const __m128i r = Five2EightSSE2(_mm_srli_epi16(color, 11));
+	const __m128i g = Five2EightSSE2(_mm_and_si128(_mm_srli_epi16(color, 6), mask5));
+	const __m128i b = Five2EightSSE2(_mm_and_si128(_mm_srli_epi16(color, 1), mask5));
+	const __m128i a = _mm_and_si128(_mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(color, _mm_set1_epi16(1))), _mm_set1_epi16(0xFF));
+	StoreRGBA8888SSE2(_mm_or_si128(r, _mm_slli_epi16(g, 8)), _mm_or_si128(b, _mm_slli_epi16(a, 8)), pDest);
+}
+
+static inline void RGBA5551_RGBA5551_SSE2(__m128i color, u16* pDest)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), swapwordSSE2(color));
+}
+
+static inline void IA88_RGBA8888_SSE2(__m128i color, u32* pDest)
+{
+	const __m128i i = _mm_and_si128(color, _mm_set1_epi16(0xFF));
+	const __m128i a = _mm_srli_epi16(color, 8);
+	StoreRGBA8888SSE2(_mm_or_si128(i, _mm_slli_epi16(i, 8)), _mm_or_si128(i, _mm_slli_epi16(a, 8)), pDest);
+}
+
+static inline void IA88_RGBA4444_SSE2(__m128i color, u16* pDest)
+{
+	const __m128i i = _mm_and_si128(_mm_srli_epi16(color, 4), _mm_set1_epi16(0xF));
+	const __m128i a = _mm_srli_epi16(color, 12);
+	const __m128i ii = _mm_or_si128(i, _mm_slli_epi16(i, 4));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest),
+		_mm_or_si128(_mm_or_si128(_mm_slli_epi16(ii, 8), _mm_slli_epi16(i, 4)), a));
+}
+
+template <GetTexelFunc GetTexel, typename T, void (*Convert)(__m128i, T*)>
+static void Get16BitTexelRowSSE2(u16 offset, u16 i, u8 palette, u16 width, u16 clamp, u16 mask, void* pDest)
+{
+	T* pRow = static_cast<T*>(pDest);
+	const u32 address = (offset << 2) & 0x7FF;
+	const u16 count = GetContiguous16BitTexels(address, width, clamp, mask);
+
+	for (u16 x = 0; x < count; x += 8)
+		Convert(Load16BitTexels(address + x, i), pRow + x);
+
+	GetTexels<GetTexel, T>(offset, i, palette, count, width, clamp, mask, pRow);
+}
+#endif // TEXTURES_SSE2
+
+struct TexelRowFuncs
+{
+	GetTexelFunc GetTexel;
+	GetTexelRowFunc Get16;
+	GetTexelRowFunc Get32;
+};
+
+#define TEXEL_ROW_FUNCS(GetTexel) { GetTexel, GetTexelRow<GetTexel, u16>, GetTexelRow<GetTexel, u32> }
+
+static const TexelRowFuncs texelRowFuncs[] =
+{
+	TEXEL_ROW_FUNCS(GetNone),
+	TEXEL_ROW_FUNCS(GetCI4_RGBA8888),
+	TEXEL_ROW_FUNCS(GetCI4_RGBA4444),
+	TEXEL_ROW_FUNCS(GetCI4IA_RGBA4444),
+	TEXEL_ROW_FUNCS(GetCI4IA_RGBA8888),
+	TEXEL_ROW_FUNCS(GetCI4RGBA_RGBA5551),
+	TEXEL_ROW_FUNCS(GetCI4RGBA_RGBA8888),
+	TEXEL_ROW_FUNCS(GetIA31_RGBA8888),
+	TEXEL_ROW_FUNCS(GetIA31_RGBA4444),
+	TEXEL_ROW_FUNCS(GetI4_RGBA8888),
+	TEXEL_ROW_FUNCS(GetI4_RGBA4444),
+	TEXEL_ROW_FUNCS(GetCI8IA_RGBA4444),
+	TEXEL_ROW_FUNCS(GetCI8IA_RGBA8888),
+	TEXEL_ROW_FUNCS(GetCI8RGBA_RGBA5551),
+	TEXEL_ROW_FUNCS(GetCI8RGBA_RGBA8888),
+	TEXEL_ROW_FUNCS(GetIA44_RGBA8888),
+	TEXEL_ROW_FUNCS(GetIA44_RGBA4444),
+	TEXEL_ROW_FUNCS(GetI8_RGBA8888),
+	TEXEL_ROW_FUNCS(GetI8_RGBA4444),
+	TEXEL_ROW_FUNCS(GetI16_RGBA8888),
+	TEXEL_ROW_FUNCS(GetI16_RGBA4444),
+	TEXEL_ROW_FUNCS(GetCI16IA_RGBA8888),
+	TEXEL_ROW_FUNCS(GetCI16IA_RGBA4444),
+	TEXEL_ROW_FUNCS(GetCI16RGBA_RGBA8888),
+	TEXEL_ROW_FUNCS(GetCI16RGBA_RGBA5551),
+#ifdef TEXTURES_SSE2
+	{ GetRGBA5551_RGBA8888, GetTexelRow<GetRGBA5551_RGBA8888, u16>, Get16BitTexelRowSSE2<GetRGBA5551_RGBA8888, u32, RGBA5551_RGBA8888_SSE2> },
+	{ GetRGBA5551_RGBA5551, Get16BitTexelRowSSE2<GetRGBA5551_RGBA5551, u16, RGBA5551_RGBA5551_SSE2>, GetTexelRow<GetRGBA5551_RGBA5551, u32> },
+	{ GetIA88_RGBA8888, GetTexelRow<GetIA88_RGBA8888, u16>, Get16BitTexelRowSSE2<GetIA88_RGBA8888, u32, IA88_RGBA8888_SSE2> },
+	{ GetIA88_RGBA4444, Get16BitTexelRowSSE2<GetIA88_RGBA4444, u16, IA88_RGBA4444_SSE2>, GetTexelRow<GetIA88_RGBA4444, u32> },
+#else // TEXTURES_SSE2
+	TEXEL_ROW_FUNCS(GetRGBA5551_RGBA8888),
+	TEXEL_ROW_FUNCS(GetRGBA5551_RGBA5551),
+	TEXEL_ROW_FUNCS(GetIA88_RGBA8888),
+	TEXEL_ROW_FUNCS(GetIA88_RGBA4444),
+#endif // TEXTURES_SSE2
+	TEXEL_ROW_FUNCS(GetRGBA8888_RGBA8888),
+	TEXEL_ROW_FUNCS(GetRGBA8888_RGBA4444)
+};
+
+#undef TEXEL_ROW_FUNCS
+
+static GetTexelRowFunc GetTexelRowFor(GetTexelFunc GetTexel, bool dest32)
+{
+	for (const TexelRowFuncs & funcs : texelRowFuncs) {
+		if (funcs.GetTexel == GetTexel)
+			return dest32 ? funcs.Get32 : funcs.Get16;
+	}
+	assert(false && "No row decoder for texel getter");
+	return dest32 ? GetTexelRow<GetNone, u32> : GetTexelRow<GetNone, u16>;
+}
+
 u32 GetNoneBG(u64 *src, u16 x, u16 i, u8 palette)
 {
 	return 0x00000000;
@@ -1356,20 +1528,19 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 	} else {
 		j = 0;
 		const u32 tMemMask = gDP.otherMode.textureLUT == G_TT_NONE ? 0x1FF : 0xFF;
+		const bool dest32 = glInternalFormat == internalcolorFormat::RGBA8;
+		const GetTexelRowFunc GetRow = GetTexelRowFor(GetTexel, dest32);
 		for (y = 0; y < tmptex.height; ++y) {
 			ty = min(y, clampTClamp) & maskTMask;
 
 			u16 tmemOffset = (tmptex.tMem + *pLine * ty) & tMemMask;
 
 			i = (ty & 1) << 1;
-			for (x = 0; x < tmptex.width; ++x) {
-				tx = min(x, clampSClamp) & maskSMask;
-
-				if (glInternalFormat == internalcolorFormat::RGBA8)
-					pDest[j++] = GetTexel(tmemOffset, tx, i, tmptex.palette);
-				else
-					((u16*)pDest)[j++] = GetTexel(tmemOffset, tx, i, tmptex.palette);
-			}
+			if (dest32)
+				GetRow(tmemOffset, i, tmptex.palette, tmptex.width, clampSClamp, maskSMask, pDest + j);
+			else
+				GetRow(tmemOffset, i, tmptex.palette, tmptex.width, clampSClamp, maskSMask, reinterpret_cast<u16*>(pDest) + j);
+			j += tmptex.width;
 		}
 	}
 }
@@ -58,3 +58,12 @@ txfilter_reloadhirestex()
 TAPI void TAPIENTRY
 txfilter_dumpcache(void)
 {}
+
+TAPI void TAPIENTRY
+txfilter_cachestats(GHQCacheStats *texCache, GHQCacheStats *hiresCache)
+{
+	if (texCache)
+		*texCache = GHQCacheStats();
+	if (hiresCache)
+		*hiresCache = GHQCacheStats();
+}
@@ -824,6 +824,13 @@ void gSPClipVertex(u32 v, SPVertex * spVtx)
 template <u32 VNUM>
 void gSPTransformVertex(u32 v, SPVertex * spVtx, float mtx[4][4])
 {
+#if defined(__SSE_OPT)
+	if (VNUM == 1) {
+		void gSPTransformVector_SSE(float vtx[4], float mtx[4][4]);
+		gSPTransformVector_SSE(&spVtx[v].x, mtx);
+		return;
+	}
+#endif //__SSE_OPT
 #ifndef __NEON_OPT
 	float x, y, z;
 	for (int i = 0; i < VNUM; ++i) {
@@ -2173,7 +2180,11 @@ void gSPSprite2DBase(u32 _base)
 	} while (RSP.nextCmd == 0xBD || RSP.nextCmd == 0xBE);
 }
 
-#ifndef __NEON_OPT
+#if defined(__SSE_OPT)
+void gSPTransformVector_SSE(float vtx[4], float mtx[4][4]);
+void(*gSPInverseTransformVector)(float vec[3], float mtx[4][4]) = gSPInverseTransformVector_default;
+void(*gSPTransformVector)(float vtx[4], float mtx[4][4]) = gSPTransformVector_SSE;
+#elif !defined(__NEON_OPT)
 void(*gSPInverseTransformVector)(float vec[3], float mtx[4][4]) = gSPInverseTransformVector_default;
 void(*gSPTransformVector)(float vtx[4], float mtx[4][4]) = gSPTransformVector_default;
 #else
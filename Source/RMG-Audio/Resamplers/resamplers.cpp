@@ -38,7 +38,8 @@ const struct resampler_interface* get_iresampler(const char* resampler_id, void*
     } resamplers[] = {
         { &g_trivial_iresampler, "trivial" },
         { &g_speex_iresampler, "speex-" },
-        { &g_src_iresampler, "src-" }
+        { &g_src_iresampler, "src-" },
+        { &g_simd_iresampler, "simd-" }
     };
 
     /* search matching resampler */
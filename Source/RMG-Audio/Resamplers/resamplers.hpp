@@ -42,5 +42,6 @@ const struct resampler_interface* get_iresampler(const char* resampler_id, void*
 extern const struct resampler_interface g_trivial_iresampler;
 extern const struct resampler_interface g_speex_iresampler;
 extern const struct resampler_interface g_src_iresampler;
+extern const struct resampler_interface g_simd_iresampler;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,306 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "resamplers.hpp"
+#include "main.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_RESAMPLER_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <RMG-Core/m64p/api/m64p_types.h>
+
+//
+// Local Defines
+//
+
+/* assume 2x16bit interleaved channels */
+#define BYTES_PER_SAMPLE 4
+
+/* positions are in 32.32 fixed point */
+#define POSITION_FRACTION_BITS 32
+#define POSITION_FRACTION_MASK 0xffffffffULL
+
+//
+// Local Structures
+//
+
+struct simd_resampler
+{
+    bool cubic;
+
+    /* fractional position of the next
+     * output sample after the first
+     * source sample of the next call */
+    uint64_t position;
+
+    /* last consumed source sample, needed
+     * by cubic interpolation */
+    uint32_t history;
+};
+
+//
+// Local Functions
+//
+
+/* returns the source sample at the given index, index -1
+ * is the last consumed sample, indexes past the end
+ * return the last source sample */
+static inline uint32_t get_sample(const uint32_t* src, size_t src_samples, uint32_t history, ptrdiff_t index)
+{
+    if (index < 0 || src_samples == 0)
+    {
+        return history;
+    }
+
+    if ((size_t)index >= src_samples)
+    {
+        index = src_samples - 1;
+    }
+
+    return src[index];
+}
+
+static inline float get_fraction(uint64_t position)
+{
+    return (float)(position & POSITION_FRACTION_MASK) * (1.0f / 4294967296.0f);
+}
+
+static inline int16_t clamp_sample(float sample)
+{
+    long value = lrintf(sample);
+
+    if (value > INT16_MAX) { return INT16_MAX; }
+    if (value < INT16_MIN) { return INT16_MIN; }
+
+    return (int16_t)value;
+}
+
+static inline float linear(float p1, float p2, float t)
+{
+    return p1 + (p2 - p1) * t;
+}
+
+/* Catmull-Rom spline through p1 and p2 */
+static inline float cubic(float p0, float p1, float p2, float p3, float t)
+{
+    return p1 + 0.5f * t * (p2 - p0 + t * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3 + t * (3.0f * (p1 - p2) + p3 - p0)));
+}
+
+static void resample_scalar(const struct simd_resampler* resampler, const uint32_t* src, size_t src_samples,
+                            int16_t* dst, size_t start, size_t end, uint64_t step)
+{
+    for (size_t i = start; i < end; i++)
+    {
+        uint64_t position = resampler->position + i * step;
+        ptrdiff_t index   = (ptrdiff_t)(position >> POSITION_FRACTION_BITS);
+        float t           = get_fraction(position);
+
+        uint32_t s1 = get_sample(src, src_samples, resampler->history, index);
+        uint32_t s2 = get_sample(src, src_samples, resampler->history, index + 1);
+
+        for (int channel = 0; channel < 2; channel++)
+        {
+            float p1 = (float)(int16_t)(s1 >> (16 * channel));
+            float p2 = (float)(int16_t)(s2 >> (16 * channel));
+            float sample;
+
+            if (resampler->cubic)
+            {
+                uint32_t s0 = get_sample(src, src_samples, resampler->history, index - 1);
+                uint32_t s3 = get_sample(src, src_samples, resampler->history, index + 2);
+                float p0 = (float)(int16_t)(s0 >> (16 * channel));
+                float p3 = (float)(int16_t)(s3 >> (16 * channel));
+                sample = cubic(p0, p1, p2, p3, t);
+            }
+            else
+            {
+                sample = linear(p1, p2, t);
+            }
+
+            dst[i * 2 + channel] = clamp_sample(sample);
+        }
+    }
+}
+
+#ifdef SIMD_RESAMPLER_SSE2
+/* converts 4 stereo samples to 2 vectors
+ * of 2 stereo samples in float */
+static inline void load_samples(uint32_t a, uint32_t b, uint32_t c, uint32_t d, __m128& low, __m128& high)
+{
+    __m128i samples = _mm_set_epi32((int)d, (int)c, (int)b, (int)a);
+
+    /* sign extend by shifting the duplicated 16 bit values */
+    low  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+    high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+}
+
+/* resamples 4 output samples per iteration, the source samples
+ * are gathered with scalar loads, the interpolation itself is done
+ * on both channels of 2 samples at a time */
+static size_t resample_sse2(const struct simd_resampler* resampler, const uint32_t* src, size_t src_samples,
+                            int16_t* dst, size_t dst_samples, uint64_t step)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 two  = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 five = _mm_set1_ps(5.0f);
+    size_t i;
+
+    for (i = 0; i + 4 <= dst_samples; i += 4)
+    {
+        uint64_t position[4];
+        ptrdiff_t index[4];
+        float t[4];
+        uint32_t s[4][4];
+
+        for (int j = 0; j < 4; j++)
+        {
+            position[j] = resampler->position + (i + j) * step;
+            index[j]    = (ptrdiff_t)(position[j] >> POSITION_FRACTION_BITS);
+            t[j]        = get_fraction(position[j]);
+
+            for (int k = 0; k < 4; k++)
+            {
+                s[k][j] = get_sample(src, src_samples, resampler->history, index[j] + k - 1);
+            }
+        }
+
+        __m128 t_low  = _mm_set_ps(t[1], t[1], t[0], t[0]);
+        __m128 t_high = _mm_set_ps(t[3], t[3], t[2], t[2]);
+        __m128 p0_low, p0_high, p1_low, p1_high, p2_low, p2_high, p3_low, p3_high;
+        __m128 result_low, result_high;
+
+        load_samples(s[1][0], s[1][1], s[1][2], s[1][3], p1_low, p1_high);
+        load_samples(s[2][0], s[2][1], s[2][2], s[2][3], p2_low, p2_high);
+
+        if (resampler->cubic)
+        {
+            load_samples(s[0][0], s[0][1], s[0][2], s[0][3], p0_low, p0_high);
+            load_samples(s[3][0], s[3][1], s[3][2], s[3][3], p3_low, p3_high);
+
+            __m128 p[2][4] = { { p0_low, p1_low, p2_low, p3_low }, { p0_high, p1_high, p2_high, p3_high } };
+            __m128 tv[2]   = { t_low, t_high };
+            __m128 result[2];
+
+            for (int h = 0; h < 2; h++)
+            {
+                /* a = 3 * (p1 - p2) + p3 - p0 */
+                __m128 a = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(three, _mm_sub_ps(p[h][1], p[h][2])), p[h][3]), p[h][0]);
+                /* b = 2 * p0 - 5 * p1 + 4 * p2 - p3 */
+                __m128 b = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, p[h][0]), _mm_mul_ps(five, p[h][1])),
+                                                 _mm_mul_ps(four, p[h][2])), p[h][3]);
+                /* c = p2 - p0 */
+                __m128 c = _mm_sub_ps(p[h][2], p[h][0]);
+                /* p1 + 0.5 * t * (c + t * (b + t * a)) */
+                __m128 r = _mm_add_ps(b, _mm_mul_ps(tv[h], a));
+                r = _mm_add_ps(c, _mm_mul_ps(tv[h], r));
+                result[h] = _mm_add_ps(p[h][1], _mm_mul_ps(_mm_mul_ps(half, tv[h]), r));
+            }
+
+            result_low  = result[0];
+            result_high = result[1];
+        }
+        else
+        {
+            result_low  = _mm_add_ps(p1_low, _mm_mul_ps(_mm_sub_ps(p2_low, p1_low), t_low));
+            result_high = _mm_add_ps(p1_high, _mm_mul_ps(_mm_sub_ps(p2_high, p1_high), t_high));
+        }
+
+        /* round, saturate and interleave back to 16 bit */
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(result_low), _mm_cvtps_epi32(result_high));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), packed);
+    }
+
+    return i;
+}
+#endif // SIMD_RESAMPLER_SSE2
+
+static void* simd_init_from_id(const char* resampler_id)
+{
+    struct simd_resampler* resampler = (struct simd_resampler*)calloc(1, sizeof(struct simd_resampler));
+    if (resampler == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (strcmp(resampler_id, "simd-cubic") == 0)
+    {
+        resampler->cubic = true;
+    }
+    else if (strcmp(resampler_id, "simd-linear") != 0)
+    {
+        DebugMessage(M64MSG_WARNING, "Unknown RESAMPLE configuration %s; use simd-linear resampler", resampler_id);
+    }
+
+    return resampler;
+}
+
+static void simd_release(void* resampler)
+{
+    free(resampler);
+}
+
+static size_t simd_resample(void* opaque,
+                            const void* src, size_t src_size, unsigned int src_freq,
+                            void* dst, size_t dst_size, unsigned int dst_freq)
+{
+    struct simd_resampler* resampler = (struct simd_resampler*)opaque;
+    const uint32_t* src_samples = (const uint32_t*)src;
+    size_t src_count = src_size / BYTES_PER_SAMPLE;
+    size_t dst_count = dst_size / BYTES_PER_SAMPLE;
+    uint64_t step = ((uint64_t)src_freq << POSITION_FRACTION_BITS) / dst_freq;
+    uint64_t end_position;
+    size_t consumed;
+    size_t i = 0;
+
+#ifdef SIMD_RESAMPLER_SSE2
+    i = resample_sse2(resampler, src_samples, src_count, (int16_t*)dst, dst_count, step);
+#endif
+    resample_scalar(resampler, src_samples, src_count, (int16_t*)dst, i, dst_count, step);
+
+    /* keep the fractional position and the
+     * last consumed sample for the next call,
+     * when the source ran out, the output past
+     * it repeated the last sample, so only the
+     * fractional phase carries over */
+    end_position = resampler->position + dst_count * step;
+    consumed = (size_t)(end_position >> POSITION_FRACTION_BITS);
+    if (consumed > src_count)
+    {
+        consumed = src_count;
+    }
+    resampler->position = end_position & POSITION_FRACTION_MASK;
+
+    if (consumed > 0)
+    {
+        resampler->history = src_samples[consumed - 1];
+    }
+
+    return consumed * BYTES_PER_SAMPLE;
+}
+
+//
+// Exported Structures
+//
+
+const struct resampler_interface g_simd_iresampler = {
+    "simd",
+    simd_init_from_id,
+    simd_release,
+    simd_resample
+};
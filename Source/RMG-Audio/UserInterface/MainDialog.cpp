@@ -31,6 +31,8 @@ MainDialog::MainDialog(QWidget* parent) : QDialog(parent)
     this->resamplerComboBox->setCurrentText(QString::fromStdString(CoreSettingsGetStringValue(SettingsID::Audio_Resampler)));
     this->swapChannelsCheckBox->setChecked(CoreSettingsGetBoolValue(SettingsID::Audio_SwapChannels));
     this->synchronizeAudioCheckBox->setChecked(CoreSettingsGetBoolValue(SettingsID::Audio_Synchronize));
+    this->dynamicRateControlCheckBox->setChecked(CoreSettingsGetBoolValue(SettingsID::Audio_DynamicRateControl));
+    this->lowLatencyOutputCheckBox->setChecked(CoreSettingsGetBoolValue(SettingsID::Audio_LowLatencyOutput));
 
     if (!CoreIsEmulationRunning() && !CoreIsEmulationPaused())
     {
@@ -94,6 +96,8 @@ void MainDialog::on_buttonBox_clicked(QAbstractButton* button)
         CoreSettingsSetValue(SettingsID::Audio_Resampler, this->resamplerComboBox->currentText().toStdString());
         CoreSettingsSetValue(SettingsID::Audio_SwapChannels, this->swapChannelsCheckBox->isChecked());
         CoreSettingsSetValue(SettingsID::Audio_Synchronize, this->synchronizeAudioCheckBox->isChecked());
+        CoreSettingsSetValue(SettingsID::Audio_DynamicRateControl, this->dynamicRateControlCheckBox->isChecked());
+        CoreSettingsSetValue(SettingsID::Audio_LowLatencyOutput, this->lowLatencyOutputCheckBox->isChecked());
         CoreSettingsSave();
     }
     else if (pushButton == defaultButton)
@@ -112,6 +116,8 @@ void MainDialog::on_buttonBox_clicked(QAbstractButton* button)
             this->resamplerComboBox->setCurrentText(QString::fromStdString(CoreSettingsGetDefaultStringValue(SettingsID::Audio_Resampler)));
             this->swapChannelsCheckBox->setChecked(CoreSettingsGetDefaultBoolValue(SettingsID::Audio_SwapChannels));
             this->synchronizeAudioCheckBox->setChecked(CoreSettingsGetDefaultBoolValue(SettingsID::Audio_Synchronize));
+            this->dynamicRateControlCheckBox->setChecked(CoreSettingsGetDefaultBoolValue(SettingsID::Audio_DynamicRateControl));
+            this->lowLatencyOutputCheckBox->setChecked(CoreSettingsGetDefaultBoolValue(SettingsID::Audio_LowLatencyOutput));
         }
     }
 }
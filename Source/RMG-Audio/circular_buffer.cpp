@@ -28,7 +28,7 @@
 
 int init_cbuff(struct circular_buffer* cbuff, size_t capacity)
 {
-    void* data = malloc(capacity);
+    unsigned char* data = (unsigned char*)calloc(2, capacity);
 
     if (data == nullptr)
     {
@@ -37,7 +37,8 @@ int init_cbuff(struct circular_buffer* cbuff, size_t capacity)
 
     cbuff->data = data;
     cbuff->size = capacity;
-    cbuff->head = 0;
+    cbuff->head.store(0, std::memory_order_relaxed);
+    cbuff->tail.store(0, std::memory_order_relaxed);
 
     return 0;
 }
@@ -45,39 +46,76 @@ int init_cbuff(struct circular_buffer* cbuff, size_t capacity)
 void release_cbuff(struct circular_buffer* cbuff)
 {
     free(cbuff->data);
-    memset(cbuff, 0, sizeof(*cbuff));
+    cbuff->data = nullptr;
+    cbuff->size = 0;
+    cbuff->head.store(0, std::memory_order_relaxed);
+    cbuff->tail.store(0, std::memory_order_relaxed);
 }
 
 
 void* cbuff_head(const struct circular_buffer* cbuff, size_t* available)
 {
-    assert(cbuff->head <= cbuff->size);
+    size_t head = cbuff->head.load(std::memory_order_relaxed);
+    size_t tail = cbuff->tail.load(std::memory_order_acquire);
 
-    *available = cbuff->size - cbuff->head;
-    return (unsigned char*)cbuff->data + cbuff->head;
+    assert(head - tail <= cbuff->size);
+
+    *available = cbuff->size - (head - tail);
+    return cbuff->data + (cbuff->size == 0 ? 0 : head % cbuff->size);
 }
 
 
-void* cbuff_tail(const struct circular_buffer* cbuff, size_t* available)
+void produce_cbuff_data(struct circular_buffer* cbuff, size_t amount)
 {
-    *available = cbuff->head;
-    return cbuff->data;
+    size_t head = cbuff->head.load(std::memory_order_relaxed);
+    size_t offset;
+    size_t first;
+
+    assert(head - cbuff->tail.load(std::memory_order_relaxed) + amount <= cbuff->size);
+
+    if (amount == 0)
+    {
+        return;
+    }
+
+    /* mirror the new data into the other half,
+     * the part before the end of the first half is
+     * copied to the second half and the rest back
+     * to the start of the first half */
+    offset = head % cbuff->size;
+    first = (offset + amount <= cbuff->size) ? amount : (cbuff->size - offset);
+
+    memcpy(cbuff->data + cbuff->size + offset, cbuff->data + offset, first);
+    memcpy(cbuff->data, cbuff->data + cbuff->size, amount - first);
+
+    cbuff->head.store(head + amount, std::memory_order_release);
 }
 
 
-void produce_cbuff_data(struct circular_buffer* cbuff, size_t amount)
+const void* cbuff_tail(const struct circular_buffer* cbuff, size_t* available)
 {
-    assert(cbuff->head + amount <= cbuff->size);
+    size_t head = cbuff->head.load(std::memory_order_acquire);
+    size_t tail = cbuff->tail.load(std::memory_order_relaxed);
 
-    cbuff->head += amount;
+    *available = head - tail;
+    return cbuff->data + (cbuff->size == 0 ? 0 : tail % cbuff->size);
 }
 
 
 void consume_cbuff_data(struct circular_buffer* cbuff, size_t amount)
 {
-    assert(cbuff->head >= amount);
+    size_t tail = cbuff->tail.load(std::memory_order_relaxed);
 
-    memmove(cbuff->data, (unsigned char*)cbuff->data + amount, cbuff->head - amount);
-    cbuff->head -= amount;
+    assert(cbuff->head.load(std::memory_order_relaxed) - tail >= amount);
+
+    cbuff->tail.store(tail + amount, std::memory_order_release);
 }
 
+
+size_t cbuff_level(const struct circular_buffer* cbuff)
+{
+    size_t tail = cbuff->tail.load(std::memory_order_acquire);
+    size_t head = cbuff->head.load(std::memory_order_acquire);
+
+    return head - tail;
+}
@@ -23,24 +23,44 @@
 #define M64P_CIRCULAR_BUFFER_H
 
 #include <cstdlib>
+#include <atomic>
 
+/* Wait-free single producer, single consumer ring buffer.
+ *
+ * The data is allocated twice and the second half mirrors the first,
+ * so both the producer and the consumer always have their whole
+ * region available as one contiguous block, even when it wraps around.
+ */
 struct circular_buffer
 {
-    void* data;
+    unsigned char* data;
     size_t size;
-    size_t head;
+
+    /* total amount of bytes produced & consumed,
+     * head is only written by the producer and
+     * tail is only written by the consumer */
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
 };
 
+/* not thread safe, neither the producer
+ * nor the consumer may access the buffer */
 int init_cbuff(struct circular_buffer* cbuff, size_t capacity);
 
 void release_cbuff(struct circular_buffer* cbuff);
 
+/* producer side, returns where new data can be written */
 void* cbuff_head(const struct circular_buffer* cbuff, size_t* available);
 
-void* cbuff_tail(const struct circular_buffer* cbuff, size_t* available);
-
 void produce_cbuff_data(struct circular_buffer* cbuff, size_t amount);
 
+/* consumer side, returns where the oldest data can be read */
+const void* cbuff_tail(const struct circular_buffer* cbuff, size_t* available);
+
 void consume_cbuff_data(struct circular_buffer* cbuff, size_t amount);
 
+/* returns the amount of bytes which can be consumed,
+ * this can be called from any thread */
+size_t cbuff_level(const struct circular_buffer* cbuff);
+
 #endif
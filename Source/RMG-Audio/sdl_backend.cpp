@@ -23,6 +23,14 @@
 #include <SDL_audio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDL_BACKEND_SSE2
+#include <emmintrin.h>
+#endif
 
 #include "Resamplers/resamplers.hpp"
 #include "circular_buffer.hpp"
@@ -37,6 +45,20 @@
 #define N64_SAMPLE_BYTES 4
 #define SDL_SAMPLE_BYTES 4
 
+/* range of the speed factor in percent */
+#define MIN_SPEED_FACTOR 10
+#define MAX_SPEED_FACTOR 300
+
+/* maximum deviation of the resampling ratio
+ * when dynamic rate control is enabled */
+#define DRC_MAX_DEVIATION 0.005
+/* weight of a new buffer level in the
+ * smoothed buffer level */
+#define DRC_LEVEL_SMOOTHING 0.0625
+
+/* interval of the latency estimate reports (in ms) */
+#define LATENCY_REPORT_INTERVAL 5000
+
 #define SDL_LockAudio() SDL_LockAudioDevice(sdl_backend->device)
 #define SDL_UnlockAudio() SDL_UnlockAudioDevice(sdl_backend->device)
 #define SDL_PauseAudio(A) SDL_PauseAudioDevice(sdl_backend->device, A)
@@ -61,8 +83,14 @@ struct sdl_backend
 
     /* Mixing buffer used for volume control */
     unsigned char* mix_buffer;
+    size_t mix_buffer_size;
 
-    unsigned int last_cb_time;
+    /* Output buffer which is queued to the
+     * audio device in low latency mode */
+    unsigned char* queue_buffer;
+    size_t queue_buffer_size;
+
+    std::atomic<unsigned int> last_cb_time;
     unsigned int input_frequency;
     unsigned int output_frequency;
     unsigned int speed_factor;
@@ -71,10 +99,32 @@ struct sdl_backend
 
     unsigned int audio_sync;
 
+    unsigned int dynamic_rate_control;
+
+    unsigned int low_latency_output;
+
+    /* whether the audio device has been opened without
+     * a callback, samples are then queued to the device
+     * directly when they're pushed, this can differ from
+     * low_latency_output until the device is re-opened */
+    unsigned int queue_output;
+
+    /* smoothed primary buffer fullness (in output samples),
+     * only accessed from the audio callback */
+    double drc_level;
+
     unsigned int paused_for_sync;
 
     unsigned int underrun_count;
 
+    /* estimated latency statistics (in output samples) */
+    uint64_t latency_estimate_sum;
+    size_t latency_estimate_min;
+    size_t latency_estimate_max;
+    unsigned int latency_estimate_count;
+    unsigned int latency_estimate_underruns;
+    unsigned int last_latency_estimate_report;
+
     unsigned int error;
 
     /* Resampler */
@@ -90,6 +140,36 @@ struct sdl_backend
         SDL_AUDIO_ISBIGENDIAN(x) ? "BE" : "LE"
 
 
+/* returns the amount of output samples the given
+ * amount of bytes in the primary buffer will produce */
+static size_t primary_level_in_output_samples(const struct sdl_backend* sdl_backend, size_t available)
+{
+    return (size_t)(((int64_t)(available/N64_SAMPLE_BYTES) * sdl_backend->output_frequency * 100) / (sdl_backend->input_frequency * sdl_backend->speed_factor));
+}
+
+/* returns the amount of output samples queued to the audio device */
+static size_t queued_level(const struct sdl_backend* sdl_backend)
+{
+    return SDL_GetQueuedAudioSize(sdl_backend->device) / SDL_SAMPLE_BYTES;
+}
+
+/* nudges the input frequency passed to the resampler,
+ * so the buffer fullness (in output samples) converges to
+ * the target, when the buffer is fuller than the target,
+ * input is consumed slightly faster and vice versa */
+static unsigned int dynamic_rate_control(struct sdl_backend* sdl_backend, unsigned int input_frequency, size_t level)
+{
+    double deviation;
+
+    sdl_backend->drc_level += (level - sdl_backend->drc_level) * DRC_LEVEL_SMOOTHING;
+
+    deviation = (sdl_backend->drc_level - sdl_backend->target) / sdl_backend->target;
+    if (deviation > 1.0) { deviation = 1.0; }
+    else if (deviation < -1.0) { deviation = -1.0; }
+
+    return (unsigned int)(input_frequency * (1.0 + deviation * DRC_MAX_DEVIATION) + 0.5);
+}
+
 static void my_audio_callback(void* userdata, unsigned char* stream, int len)
 {
     struct sdl_backend* sdl_backend = (struct sdl_backend*)userdata;
@@ -97,13 +177,18 @@ static void my_audio_callback(void* userdata, unsigned char* stream, int len)
     /* mark the time, for synchronization on the input side */
     sdl_backend->last_cb_time = SDL_GetTicks();
 
+    size_t available;
+    const void* src = cbuff_tail(&sdl_backend->primary_buffer, &available);
+
     unsigned int newsamplerate = sdl_backend->output_frequency * 100 / sdl_backend->speed_factor;
     unsigned int oldsamplerate = sdl_backend->input_frequency;
+    if (sdl_backend->dynamic_rate_control) {
+        oldsamplerate = dynamic_rate_control(sdl_backend, oldsamplerate,
+                                             primary_level_in_output_samples(sdl_backend, available));
+    }
     size_t needed = (len * oldsamplerate) / newsamplerate;
-    size_t available;
     size_t consumed;
 
-    const void* src = cbuff_tail(&sdl_backend->primary_buffer, &available);
     if ((available > 0) && (available >= needed))
     {
         consumed = ResampleAndMix(sdl_backend->resampler, sdl_backend->iresampler,
@@ -120,21 +205,125 @@ static void my_audio_callback(void* userdata, unsigned char* stream, int len)
     }
 }
 
+/* resamples all samples in the primary buffer
+ * and queues them to the audio device */
+static void queue_primary_buffer(struct sdl_backend* sdl_backend)
+{
+    size_t available;
+    const void* src = cbuff_tail(&sdl_backend->primary_buffer, &available);
+
+    size_t queued = queued_level(sdl_backend);
+
+    unsigned int newsamplerate = sdl_backend->output_frequency * 100 / sdl_backend->speed_factor;
+    unsigned int oldsamplerate = sdl_backend->input_frequency;
+    if (sdl_backend->dynamic_rate_control) {
+        oldsamplerate = dynamic_rate_control(sdl_backend, oldsamplerate, queued);
+    }
+
+    /* produce as many output samples as the available input allows */
+    size_t len = (size_t)(((uint64_t)(available / N64_SAMPLE_BYTES) * newsamplerate) / oldsamplerate) * SDL_SAMPLE_BYTES;
+    if (len == 0) {
+        return;
+    }
+
+    if (len > sdl_backend->queue_buffer_size)
+    {
+        unsigned char* mix_buffer = (unsigned char*)realloc(sdl_backend->mix_buffer, len);
+        if (mix_buffer != nullptr) {
+            sdl_backend->mix_buffer = mix_buffer;
+            sdl_backend->mix_buffer_size = len;
+        }
+        unsigned char* queue_buffer = (unsigned char*)realloc(sdl_backend->queue_buffer, len);
+        if (queue_buffer != nullptr) {
+            sdl_backend->queue_buffer = queue_buffer;
+            sdl_backend->queue_buffer_size = len;
+        }
+        if (mix_buffer == nullptr || queue_buffer == nullptr) {
+            DebugMessage(M64MSG_ERROR, "Failed to allocate audio queue buffer.");
+            sdl_backend->error = 1;
+            return;
+        }
+    }
+
+    size_t consumed = ResampleAndMix(sdl_backend->resampler, sdl_backend->iresampler,
+            sdl_backend->mix_buffer,
+            src, available, oldsamplerate,
+            sdl_backend->queue_buffer, len, newsamplerate);
+
+    consume_cbuff_data(&sdl_backend->primary_buffer, consumed);
+
+    /* when the queue is already full, i.e when audio
+     * synchronization is disabled, drop the samples to
+     * keep the latency bounded */
+    if (queued >= sdl_backend->primary_buffer_size) {
+        DebugMessage(M64MSG_VERBOSE, "queue_primary_buffer: dropping %zu bytes, %zu samples queued !", len, queued);
+        return;
+    }
+
+    if (SDL_QueueAudio(sdl_backend->device, sdl_backend->queue_buffer, (Uint32)len) != 0) {
+        DebugMessage(M64MSG_WARNING, "Couldn't queue audio: %s", SDL_GetError());
+    }
+}
+
+/* accumulates an estimate of the current output latency
+ * and reports the statistics at a regular interval, the
+ * estimate is derived from the buffer levels, so it doesn't
+ * include the latency of the audio driver and hardware */
+static void update_latency_estimate(struct sdl_backend* sdl_backend, size_t level)
+{
+    unsigned int now = SDL_GetTicks();
+
+    /* the latency consists of the buffered samples
+     * and the samples in the device buffer */
+    size_t latency = level + sdl_backend->secondary_buffer_size;
+
+    if (sdl_backend->latency_estimate_count == 0 || latency < sdl_backend->latency_estimate_min) {
+        sdl_backend->latency_estimate_min = latency;
+    }
+    if (latency > sdl_backend->latency_estimate_max) {
+        sdl_backend->latency_estimate_max = latency;
+    }
+    sdl_backend->latency_estimate_sum += latency;
+    sdl_backend->latency_estimate_count++;
+
+    if (now - sdl_backend->last_latency_estimate_report < LATENCY_REPORT_INTERVAL) {
+        return;
+    }
+
+    DebugMessage(M64MSG_VERBOSE, "Estimated audio latency: %.1f ms average, %.1f ms min, %.1f ms max, %u underruns.",
+                 (double)sdl_backend->latency_estimate_sum * 1000 / ((double)sdl_backend->latency_estimate_count * sdl_backend->output_frequency),
+                 (double)sdl_backend->latency_estimate_min * 1000 / sdl_backend->output_frequency,
+                 (double)sdl_backend->latency_estimate_max * 1000 / sdl_backend->output_frequency,
+                 sdl_backend->underrun_count - sdl_backend->latency_estimate_underruns);
+
+    sdl_backend->latency_estimate_sum = 0;
+    sdl_backend->latency_estimate_min = 0;
+    sdl_backend->latency_estimate_max = 0;
+    sdl_backend->latency_estimate_count = 0;
+    sdl_backend->latency_estimate_underruns = sdl_backend->underrun_count;
+    sdl_backend->last_latency_estimate_report = now;
+}
+
 static size_t new_primary_buffer_size(const struct sdl_backend* sdl_backend)
 {
-    return N64_SAMPLE_BYTES * ((uint64_t)sdl_backend->primary_buffer_size * sdl_backend->input_frequency * sdl_backend->speed_factor) /
+    /* the buffer is sized for the maximum speed factor,
+     * so it never has to be resized while the producer
+     * or consumer might be accessing it */
+    return N64_SAMPLE_BYTES * ((uint64_t)sdl_backend->primary_buffer_size * sdl_backend->input_frequency * MAX_SPEED_FACTOR) /
         (sdl_backend->output_frequency * 100);
 }
 
 static void resize_primary_buffer(struct sdl_backend* sdl_backend, size_t new_size)
 {
-    /* only grows the buffer */
+    /* only grows the buffer, this is only done
+     * while the audio device is paused, so the
+     * consumer isn't running */
     if (new_size > sdl_backend->primary_buffer.size) {
-        SDL_LockAudio();
-        sdl_backend->primary_buffer.data = realloc(sdl_backend->primary_buffer.data, new_size);
-        memset((unsigned char*)sdl_backend->primary_buffer.data + sdl_backend->primary_buffer.size, 0, new_size - sdl_backend->primary_buffer.size);
-        sdl_backend->primary_buffer.size = new_size;
-        SDL_UnlockAudio();
+        release_cbuff(&sdl_backend->primary_buffer);
+        if (init_cbuff(&sdl_backend->primary_buffer, new_size) != 0) {
+            DebugMessage(M64MSG_ERROR, "Failed to allocate primary audio buffer.");
+            sdl_backend->error = 1;
+        }
     }
 }
 
@@ -169,6 +358,7 @@ static void sdl_init_audio_device(struct sdl_backend* sdl_backend)
     }
 
     sdl_backend->paused_for_sync = 1;
+    sdl_backend->queue_output = sdl_backend->low_latency_output;
 
     /* reload these because they gets re-assigned from SDL data below, and sdl_init_audio_device can be called more than once */
     sdl_backend->primary_buffer_size = CoreSettingsGetIntValue(SettingsID::Audio_PrimaryBufferSize);
@@ -179,13 +369,17 @@ static void sdl_init_audio_device(struct sdl_backend* sdl_backend)
     DebugMessage(M64MSG_VERBOSE, "Primary buffer: %i output samples.", (uint32_t) sdl_backend->primary_buffer_size);
     DebugMessage(M64MSG_VERBOSE, "Primary target fullness: %i output samples.", (uint32_t) sdl_backend->target);
     DebugMessage(M64MSG_VERBOSE, "Secondary buffer: %i output samples.", (uint32_t) sdl_backend->secondary_buffer_size);
+    DebugMessage(M64MSG_VERBOSE, "Output mode: %s.", sdl_backend->queue_output ? "queue" : "callback");
 
     memset(&desired, 0, sizeof(desired));
     desired.freq = select_output_frequency(sdl_backend->input_frequency);
     desired.format = AUDIO_S16SYS;
     desired.channels = 2;
     desired.samples = sdl_backend->secondary_buffer_size;
-    desired.callback = my_audio_callback;
+    /* in low latency mode the samples are queued to the device
+     * as soon as they're pushed, which removes the latency
+     * of waiting for the next callback */
+    desired.callback = sdl_backend->queue_output ? nullptr : my_audio_callback;
     desired.userdata = sdl_backend;
 
     DebugMessage(M64MSG_VERBOSE, "Requesting frequency: %iHz.", desired.freq);
@@ -219,15 +413,28 @@ static void sdl_init_audio_device(struct sdl_backend* sdl_backend)
     if (sdl_backend->primary_buffer_size < sdl_backend->secondary_buffer_size * 2)
         sdl_backend->primary_buffer_size = sdl_backend->secondary_buffer_size * 2;
 
+    /* playback starts at the target fullness */
+    sdl_backend->drc_level = sdl_backend->target;
+
     /* allocate memory for audio buffers */
     resize_primary_buffer(sdl_backend, new_primary_buffer_size(sdl_backend));
-    sdl_backend->mix_buffer = (unsigned char*)realloc(sdl_backend->mix_buffer, sdl_backend->secondary_buffer_size * SDL_SAMPLE_BYTES);
+    if (sdl_backend->mix_buffer_size < sdl_backend->secondary_buffer_size * SDL_SAMPLE_BYTES) {
+        sdl_backend->mix_buffer_size = sdl_backend->secondary_buffer_size * SDL_SAMPLE_BYTES;
+        sdl_backend->mix_buffer = (unsigned char*)realloc(sdl_backend->mix_buffer, sdl_backend->mix_buffer_size);
+    }
 
     /* preset the last callback time */
     if (sdl_backend->last_cb_time == 0) {
         sdl_backend->last_cb_time = SDL_GetTicks();
     }
 
+    /* restart the latency estimate */
+    sdl_backend->latency_estimate_count = 0;
+    sdl_backend->latency_estimate_sum = 0;
+    sdl_backend->latency_estimate_max = 0;
+    sdl_backend->latency_estimate_underruns = sdl_backend->underrun_count;
+    sdl_backend->last_latency_estimate_report = SDL_GetTicks();
+
     DebugMessage(M64MSG_VERBOSE, "Frequency: %i", obtained.freq);
     DebugMessage(M64MSG_VERBOSE, "Format: " AFMT_FMTSPEC, AFMT_ARGS(obtained.format));
     DebugMessage(M64MSG_VERBOSE, "Channels: %i", obtained.channels);
@@ -252,26 +459,25 @@ static void release_audio_device(struct sdl_backend* sdl_backend)
 struct sdl_backend* init_sdl_backend(void)
 {
     /* allocate memory for sdl_backend */
-    struct sdl_backend* sdl_backend = (struct sdl_backend*)malloc(sizeof(*sdl_backend));
+    struct sdl_backend* sdl_backend = new (std::nothrow) struct sdl_backend();
     if (sdl_backend == nullptr) {
         return nullptr;
     }
 
-    /* reset sdl_backend */
-    memset(sdl_backend, 0, sizeof(*sdl_backend));
-
     /* instanciate resampler */
     std::string resampler_id = CoreSettingsGetStringValue(SettingsID::Audio_Resampler);
     void* resampler = nullptr;
     const struct resampler_interface* iresampler = get_iresampler(resampler_id.c_str(), &resampler);
     if (iresampler == nullptr) {
-        free(sdl_backend);
+        delete sdl_backend;
         return nullptr;
     }
 
     sdl_backend->input_frequency = CoreSettingsGetIntValue(SettingsID::Audio_DefaultFrequency);
     sdl_backend->swap_channels = CoreSettingsGetBoolValue(SettingsID::Audio_SwapChannels);
     sdl_backend->audio_sync = !CoreHasInitNetplay() && CoreSettingsGetBoolValue(SettingsID::Audio_Synchronize);
+    sdl_backend->dynamic_rate_control = CoreSettingsGetBoolValue(SettingsID::Audio_DynamicRateControl);
+    sdl_backend->low_latency_output = CoreSettingsGetBoolValue(SettingsID::Audio_LowLatencyOutput);
     sdl_backend->paused_for_sync = 1;
     sdl_backend->speed_factor = 100;
     sdl_backend->resampler = resampler;
@@ -287,6 +493,8 @@ void sdl_apply_settings(struct sdl_backend* sdl_backend)
     sdl_backend->input_frequency = CoreSettingsGetIntValue(SettingsID::Audio_DefaultFrequency);
     sdl_backend->swap_channels = CoreSettingsGetBoolValue(SettingsID::Audio_SwapChannels);
     sdl_backend->audio_sync = CoreSettingsGetBoolValue(SettingsID::Audio_Synchronize);
+    sdl_backend->dynamic_rate_control = CoreSettingsGetBoolValue(SettingsID::Audio_DynamicRateControl);
+    sdl_backend->low_latency_output = CoreSettingsGetBoolValue(SettingsID::Audio_LowLatencyOutput);
     sdl_backend->primary_buffer_size = CoreSettingsGetIntValue(SettingsID::Audio_PrimaryBufferSize);
     sdl_backend->target = CoreSettingsGetIntValue(SettingsID::Audio_PrimaryBufferTarget);
     sdl_backend->secondary_buffer_size = CoreSettingsGetIntValue(SettingsID::Audio_SecondaryBufferSize);
@@ -308,11 +516,14 @@ void release_sdl_backend(struct sdl_backend* sdl_backend)
     /* release mix buffer */
     free(sdl_backend->mix_buffer);
 
+    /* release queue buffer */
+    free(sdl_backend->queue_buffer);
+
     /* release resampler */
     sdl_backend->iresampler->release(sdl_backend->resampler);
 
     /* release sdl backend */
-    free(sdl_backend);
+    delete sdl_backend;
 }
 
 void sdl_set_frequency(struct sdl_backend* sdl_backend, unsigned int frequency)
@@ -325,6 +536,30 @@ void sdl_set_frequency(struct sdl_backend* sdl_backend, unsigned int frequency)
 }
 
 
+/* copies the samples while swapping the 16 bit halves
+ * of each sample, size must be a multiple of 4 */
+static void copy_swapped_samples(unsigned char* dst, const void* src, size_t size)
+{
+    size_t i = 0;
+
+#ifdef SDL_BACKEND_SSE2
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i samples = _mm_loadu_si128((const __m128i*)((const unsigned char*)src + i));
+        samples = _mm_shufflehi_epi16(_mm_shufflelo_epi16(samples, 0xB1), 0xB1);
+        _mm_storeu_si128((__m128i*)(dst + i), samples);
+    }
+#endif
+
+    for (; i < size; i += 4)
+    {
+        uint32_t sample;
+        memcpy(&sample, (const unsigned char*)src + i, 4);
+        sample = (sample << 16) | (sample >> 16);
+        memcpy(dst + i, &sample, 4);
+    }
+}
+
 void sdl_push_samples(struct sdl_backend* sdl_backend, const void* src, size_t size)
 {
     size_t available;
@@ -338,8 +573,8 @@ void sdl_push_samples(struct sdl_backend* sdl_backend, const void* src, size_t s
     }
     size = (size / 4) * 4;
 
-    /* We need to lock audio before accessing cbuff */
-    SDL_LockAudio();
+    /* the primary buffer is a single producer, single consumer
+     * ring buffer, so there's no need to lock audio */
     unsigned char* dst = (unsigned char*)cbuff_head(&sdl_backend->primary_buffer, &available);
     if (size <= available)
     {
@@ -358,17 +593,16 @@ void sdl_push_samples(struct sdl_backend* sdl_backend, const void* src, size_t s
             memcpy(dst, src, size);
         }
         else {
-            size_t i;
-            for (i = 0 ; i < size ; i += 4 )
-            {
-                memcpy(dst + i + 0, (const unsigned char*)src + i + 2, 2); /* Left */
-                memcpy(dst + i + 2, (const unsigned char*)src + i + 0, 2); /* Right */
-            }
+            copy_swapped_samples(dst, src, size);
         }
 
         produce_cbuff_data(&sdl_backend->primary_buffer, size);
     }
-    SDL_UnlockAudio();
+
+    if (sdl_backend->queue_output)
+    {
+        queue_primary_buffer(sdl_backend);
+    }
 
     if (size > available)
     {
@@ -379,14 +613,11 @@ void sdl_push_samples(struct sdl_backend* sdl_backend, const void* src, size_t s
 
 static size_t estimate_level_at_next_audio_cb(struct sdl_backend* sdl_backend)
 {
-    size_t available;
+    size_t available = cbuff_level(&sdl_backend->primary_buffer);
     unsigned int now = SDL_GetTicks();
 
-    /* NOTE: given that we only access "available" counter from cbuff, we don't need to protect it's access with LockAudio/UnlockAudio */
-    cbuff_tail(&sdl_backend->primary_buffer, &available);
-
     /* Start by calculating the current Primary buffer fullness in terms of output samples */
-    size_t expected_level = (size_t)(((int64_t)(available/N64_SAMPLE_BYTES) * sdl_backend->output_frequency * 100) / (sdl_backend->input_frequency * sdl_backend->speed_factor));
+    size_t expected_level = primary_level_in_output_samples(sdl_backend, available);
 
     /* Next, extrapolate to the buffer level at the expected time of the next audio callback, assuming that the
        buffer is filled at the same rate as the output frequency */
@@ -403,7 +634,39 @@ void sdl_synchronize_audio(struct sdl_backend* sdl_backend)
 {
     enum { TOLERANCE_MS = 10 };
 
-    size_t expected_level = estimate_level_at_next_audio_cb(sdl_backend);
+    size_t expected_level;
+
+    if (sdl_backend->error != 0)
+        return;
+
+    if (sdl_backend->queue_output)
+    {
+        /* the queue level is known exactly, an empty
+         * queue while playing means the device ran dry */
+        expected_level = queued_level(sdl_backend);
+        if (expected_level == 0 && !sdl_backend->paused_for_sync) {
+            ++sdl_backend->underrun_count;
+        }
+    }
+    else
+    {
+        expected_level = estimate_level_at_next_audio_cb(sdl_backend);
+    }
+
+    update_latency_estimate(sdl_backend, expected_level);
+
+    if (sdl_backend->dynamic_rate_control)
+    {
+        /* start playback once the Primary Buffer has been filled up to the target,
+         * from then on the audio callback keeps the fullness around the target by
+         * adjusting the resampling ratio, so emulation never has to be delayed */
+        if (sdl_backend->paused_for_sync && expected_level >= sdl_backend->target)
+        {
+            SDL_PauseAudio(0);
+            sdl_backend->paused_for_sync = 0;
+        }
+        return;
+    }
 
     /* If the expected value of the Primary Buffer Fullness at the time of the next audio callback is more than 10
        milliseconds ahead of our target buffer fullness level, then insert a delay now */
@@ -436,11 +699,8 @@ void sdl_synchronize_audio(struct sdl_backend* sdl_backend)
 
 void sdl_set_speed_factor(struct sdl_backend* sdl_backend, unsigned int speed_factor)
 {
-    if (speed_factor < 10 || speed_factor > 300)
+    if (speed_factor < MIN_SPEED_FACTOR || speed_factor > MAX_SPEED_FACTOR)
         return;
 
     sdl_backend->speed_factor = speed_factor;
-
-    /* we need a different size primary buffer to store the N64 samples when the speed changes */
-    resize_primary_buffer(sdl_backend, new_primary_buffer_size(sdl_backend));
 }
@@ -15,8 +15,10 @@
 #include "String.hpp"
 #include "Error.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <mutex>
 
 // lzma includes
 #include <3rdParty/lzma/7zVersion.h>
@@ -41,6 +43,7 @@
 //
 
 #define UNZIP_READ_SIZE 67108860 /* 64 MiB */
+#define UNZIP_CHUNK_SIZE 1048576 /* 1 MiB */
 
 //
 // Local Functions
@@ -114,7 +117,8 @@ static int zlib_filefunc_testerror(voidpf, voidpf)
 // Exported Functions
 //
 
-CORE_EXPORT bool CoreReadZipFile(std::filesystem::path file, std::filesystem::path& extractedFileName, bool& isDisk, std::vector<char>& outBuffer)
+CORE_EXPORT bool CoreReadZipFileChunks(std::filesystem::path file, std::filesystem::path& extractedFileName, bool& isDisk,
+                                       std::function<bool(uint64_t, const char*, size_t)> callback)
 {
     std::string  error;
     std::ifstream fileStream;
@@ -193,22 +197,36 @@ CORE_EXPORT bool CoreReadZipFile(std::filesystem::path file, std::filesystem::pa
             fileExtension == ".ndd" ||
             fileExtension == ".d64")
         {
-            std::vector<char> buffer(UNZIP_READ_SIZE);
+            std::vector<char> chunk;
+            uint64_t remaining = fileInfo.uncompressed_size;
             int bytes_read = 0;
 
-            outBuffer.reserve(UNZIP_READ_SIZE);
+            // ensure the file isn't larger than we support
+            if (fileInfo.uncompressed_size > UNZIP_READ_SIZE)
+            {
+                unzClose(zipFile);
+                error = "CoreReadZipFile Failed: file in zip exceeds maximum size!";
+                CoreSetError(error);
+                return false;
+            }
 
             if (unzOpenCurrentFile(zipFile) != UNZ_OK)
             {
+                unzClose(zipFile);
                 error = "CoreReadZipFile Failed: unzOpenCurrentFile Failed!";
                 CoreSetError(error);
                 return false;
             }
 
-            do
+            extractedFileName = fileNamePath;
+            isDisk            = (fileExtension == ".ndd" || fileExtension == ".d64");
+
+            chunk.resize(std::min<uint64_t>(remaining, UNZIP_CHUNK_SIZE));
+
+            while (remaining > 0)
             {
-                bytes_read = unzReadCurrentFile(zipFile, buffer.data(), UNZIP_READ_SIZE);
-                if (bytes_read < 0)
+                bytes_read = unzReadCurrentFile(zipFile, chunk.data(), std::min<uint64_t>(remaining, chunk.size()));
+                if (bytes_read <= 0)
                 {
                     unzCloseCurrentFile(zipFile);
                     unzClose(zipFile);
@@ -217,14 +235,17 @@ CORE_EXPORT bool CoreReadZipFile(std::filesystem::path file, std::filesystem::pa
                     CoreSetError(error);
                     return false;
                 }
-                else if (bytes_read > 0)
+
+                remaining -= bytes_read;
+
+                if (!callback(fileInfo.uncompressed_size, chunk.data(), bytes_read))
                 {
-                    outBuffer.insert(outBuffer.end(), buffer.begin(), std::next(buffer.begin(), bytes_read));
+                    unzCloseCurrentFile(zipFile);
+                    unzClose(zipFile);
+                    return false;
                 }
-            } while (bytes_read > 0);
+            }
 
-            extractedFileName = fileNamePath;
-            isDisk            = (fileExtension == ".ndd" || fileExtension == ".d64");
             unzCloseCurrentFile(zipFile);
             unzClose(zipFile);
             return true;
@@ -252,6 +273,22 @@ CORE_EXPORT bool CoreReadZipFile(std::filesystem::path file, std::filesystem::pa
     return false;
 }
 
+CORE_EXPORT bool CoreReadZipFile(std::filesystem::path file, std::filesystem::path& extractedFileName, bool& isDisk, std::vector<char>& outBuffer)
+{
+    outBuffer.clear();
+
+    return CoreReadZipFileChunks(file, extractedFileName, isDisk, [&outBuffer](uint64_t size, const char* data, size_t dataSize)
+    {
+        if (outBuffer.empty())
+        {
+            outBuffer.reserve(size);
+        }
+
+        outBuffer.insert(outBuffer.end(), data, data + dataSize);
+        return true;
+    });
+}
+
 CORE_EXPORT bool CoreRead7zipFile(std::filesystem::path file, std::filesystem::path& extractedFileName, bool& isDisk, std::vector<char>& outBuffer)
 {
     std::string  error;
@@ -305,8 +342,10 @@ CORE_EXPORT bool CoreRead7zipFile(std::filesystem::path file, std::filesystem::p
     lookStream.realStream = &archiveStream.vt;
     LookToRead2_INIT(&lookStream);
 
-    // initialize CRC table
-    CrcGenerateTable();
+    // initialize CRC table once, CoreRead7zipFile
+    // can be called from multiple threads at once
+    static std::once_flag crcTableFlag;
+    std::call_once(crcTableFlag, CrcGenerateTable);
 
     // initialize archive
     SzArEx_Init(&db);
@@ -11,8 +11,16 @@
 #define CORE_ARCHIVE_HPP
 
 #include <filesystem>
+#include <functional>
 #include <vector>
 
+// attempts to read the ROM/disk in a zip file in chunks,
+// extractedFileName and isDisk are set before the callback
+// is called with the uncompressed size and each chunk,
+// returning false from the callback stops reading
+bool CoreReadZipFileChunks(std::filesystem::path file, std::filesystem::path& extractedFileName, bool& isDisk,
+                           std::function<bool(uint64_t, const char*, size_t)> callback);
+
 // attempts to read the ROM/disk in a zip file into outBuffer
 bool CoreReadZipFile(std::filesystem::path file, std::filesystem::path& extractedFileName, bool& isDisk, std::vector<char>& outBuffer);
 
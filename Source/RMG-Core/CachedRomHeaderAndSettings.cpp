@@ -11,31 +11,44 @@
 #include "CachedRomHeaderAndSettings.hpp"
 #include "Directories.hpp"
 #include "RomSettings.hpp"
+#include "RomScanner.hpp"
 #include "RomHeader.hpp"
 #include "Library.hpp"
 #include "File.hpp"
 
+#include <condition_variable>
+#include <unordered_map>
 #include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <list>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif // _WIN32
 
 //
 // Local Defines
 //
 
-#define ROMHEADER_NAME_LEN 256
-#define GOODNAME_LEN 256
-#define MD5_LEN 33
-#define GAMEID_LEN 5
-#define REGION_LEN 18
-
 #ifdef _WIN32
-#define CACHE_FILE_MAGIC "RMGCoreHeaderAndSettingsCacheWindows_09"
+#define CACHE_FILE_MAGIC "RMGCoreHeaderAndSettingsCacheWindows_11"
 #else // Linux
-#define CACHE_FILE_MAGIC "RMGCoreHeaderAndSettingsCacheLinux_09"
+#define CACHE_FILE_MAGIC "RMGCoreHeaderAndSettingsCacheLinux_11"
 #endif // _WIN32
 #define CACHE_FILE_ITEMS_MAX 250000
+// the cache file is rewritten instead of appended to
+// when it'd contain more than this factor of records
+// compared to the amount of cached entries
+#define CACHE_FILE_COMPACT_FACTOR 2
 
 //
 // Local Structures
@@ -54,12 +67,57 @@ struct l_CacheEntry
     CoreRomSettings defaultSettings;
 };
 
+struct l_ScanResult
+{
+    size_t index;
+    bool   valid;
+    bool   isDisk;
+
+    CoreRomHeader   header;
+    CoreRomSettings settings;
+};
+
+struct l_CacheFileReader
+{
+    const char* data;
+    size_t      size;
+    size_t      offset;
+};
+
+struct l_MappedFile
+{
+    const char* data = nullptr;
+    size_t      size = 0;
+#ifdef _WIN32
+    HANDLE file    = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif // _WIN32
+};
+
+typedef std::list<l_CacheEntry>::iterator l_CacheEntryIter;
+
 //
 // Local Variables
 //
 
-static bool                      l_CacheEntriesChanged = false;
-static std::vector<l_CacheEntry> l_CacheEntries;
+// the entries are kept in insertion order, so the oldest
+// entry can be removed when we're over the item limit
+static std::list<l_CacheEntry> l_CacheEntries;
+static std::unordered_map<std::filesystem::path::string_type, l_CacheEntryIter> l_CacheEntriesByFileName;
+// multiple files can have the same MD5
+static std::unordered_multimap<std::string, l_CacheEntryIter> l_CacheEntriesByMD5;
+
+// entries which have changed since the cache file has
+// been read or saved, these are appended to the cache file
+static std::vector<l_CacheEntry> l_ChangedCacheEntries;
+static size_t l_CacheFileRecordCount = 0;
+static bool   l_CacheFileRewrite     = true;
+
+// the cache is accessed from both the UI thread
+// and the rom searcher thread, it's recursive
+// because opening a disk in the core updates
+// the cache while we're adding an entry
+static std::recursive_mutex l_CacheMutex;
 
 //
 // Internal Functions
@@ -76,36 +134,323 @@ static std::filesystem::path get_cache_file_name(void)
     return file;
 }
 
-static std::vector<l_CacheEntry>::iterator get_cache_entry_iter(const std::filesystem::path& file, bool checkFileTime = true)
+static bool map_file(const std::filesystem::path& file, l_MappedFile& mappedFile)
 {
-    CoreFileTime fileTime = (checkFileTime ? CoreGetFileTime(file) : 0);
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
 
-    auto predicate = [file, fileTime, checkFileTime](const auto& entry)
+    mappedFile.file = CreateFileW(file.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mappedFile.file == INVALID_HANDLE_VALUE)
     {
-        return entry.fileName == file &&
-                (!checkFileTime || entry.fileTime == fileTime);
-    };
+        return false;
+    }
 
-    return std::find_if(l_CacheEntries.begin(), l_CacheEntries.end(), predicate);
+    if (!GetFileSizeEx(mappedFile.file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(mappedFile.file);
+        return false;
+    }
+
+    mappedFile.mapping = CreateFileMappingW(mappedFile.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappedFile.mapping == nullptr)
+    {
+        CloseHandle(mappedFile.file);
+        return false;
+    }
+
+    mappedFile.data = static_cast<const char*>(MapViewOfFile(mappedFile.mapping, FILE_MAP_READ, 0, 0, 0));
+    if (mappedFile.data == nullptr)
+    {
+        CloseHandle(mappedFile.mapping);
+        CloseHandle(mappedFile.file);
+        return false;
+    }
+
+    mappedFile.size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+#else // Linux
+    struct stat fileStat;
+    void* data;
+    int fd;
+
+    fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after closing the file
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    mappedFile.data = static_cast<const char*>(data);
+    mappedFile.size = static_cast<size_t>(fileStat.st_size);
+    return true;
+#endif // _WIN32
 }
 
-static void add_cache_entry(const std::filesystem::path& file, CoreRomType type, 
-                            const CoreRomHeader& header, const CoreRomSettings& defaultSettings,
-                            const CoreRomSettings& settings)
+static void unmap_file(l_MappedFile& mappedFile)
 {
-    l_CacheEntry cacheEntry;
+#ifdef _WIN32
+    UnmapViewOfFile(mappedFile.data);
+    CloseHandle(mappedFile.mapping);
+    CloseHandle(mappedFile.file);
+#else // Linux
+    munmap(const_cast<char*>(mappedFile.data), mappedFile.size);
+#endif // _WIN32
+    mappedFile = {};
+}
+
+template <typename T>
+static void write_value(std::vector<char>& buffer, const T& value)
+{
+    const char* data = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), data, data + sizeof(T));
+}
+
+template <typename T>
+static void write_string(std::vector<char>& buffer, const T& str)
+{
+    const uint32_t size = static_cast<uint32_t>(str.size() * sizeof(typename T::value_type));
+    const char* data    = reinterpret_cast<const char*>(str.data());
+
+    write_value(buffer, size);
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+template <typename T>
+static bool read_value(l_CacheFileReader& reader, T& value)
+{
+    if ((reader.size - reader.offset) < sizeof(T))
+    {
+        return false;
+    }
+
+    memcpy(&value, reader.data + reader.offset, sizeof(T));
+    reader.offset += sizeof(T);
+    return true;
+}
+
+template <typename T>
+static bool read_string(l_CacheFileReader& reader, T& str)
+{
+    uint32_t size;
+
+    if (!read_value(reader, size) ||
+        (reader.size - reader.offset) < size ||
+        (size % sizeof(typename T::value_type)) != 0)
+    {
+        return false;
+    }
+
+    str.resize(size / sizeof(typename T::value_type));
+    memcpy(str.data(), reader.data + reader.offset, size);
+    reader.offset += size;
+    return true;
+}
 
+static void write_cache_entry(std::vector<char>& buffer, const l_CacheEntry& cacheEntry)
+{
+    const size_t recordOffset = buffer.size();
+    uint32_t     recordSize   = 0;
+
+    // every record starts with its size,
+    // which is filled in afterwards
+    write_value(buffer, recordSize);
+
+    // file info
+    write_string(buffer, cacheEntry.fileName.native());
+    write_value(buffer, cacheEntry.fileTime);
+    // validity
+    write_value(buffer, cacheEntry.valid);
+    // invalid entries have less data
+    if (cacheEntry.valid)
+    {
+        // type
+        write_value(buffer, cacheEntry.type);
+        // header
+        write_string(buffer, cacheEntry.header.Name);
+        write_string(buffer, cacheEntry.header.GameID);
+        write_string(buffer, cacheEntry.header.Region);
+        write_value(buffer, cacheEntry.header.CRC1);
+        write_value(buffer, cacheEntry.header.CRC2);
+        write_value(buffer, cacheEntry.header.CountryCode);
+        write_value(buffer, cacheEntry.header.SystemType);
+        // shared settings
+        write_string(buffer, cacheEntry.settings.GoodName);
+        write_string(buffer, cacheEntry.settings.MD5);
+        // default settings
+        write_value(buffer, cacheEntry.defaultSettings.SaveType);
+        write_value(buffer, cacheEntry.defaultSettings.DisableExtraMem);
+        write_value(buffer, cacheEntry.defaultSettings.TransferPak);
+        write_value(buffer, cacheEntry.defaultSettings.CountPerOp);
+        write_value(buffer, cacheEntry.defaultSettings.SiDMADuration);
+        write_value(buffer, cacheEntry.defaultSettings.RunAheadFrames);
+        // current settings
+        write_value(buffer, cacheEntry.settings.SaveType);
+        write_value(buffer, cacheEntry.settings.DisableExtraMem);
+        write_value(buffer, cacheEntry.settings.TransferPak);
+        write_value(buffer, cacheEntry.settings.CountPerOp);
+        write_value(buffer, cacheEntry.settings.SiDMADuration);
+        write_value(buffer, cacheEntry.settings.RunAheadFrames);
+    }
+
+    recordSize = static_cast<uint32_t>(buffer.size() - recordOffset - sizeof(recordSize));
+    memcpy(buffer.data() + recordOffset, &recordSize, sizeof(recordSize));
+}
+
+static bool read_cache_entry(l_CacheFileReader& reader, l_CacheEntry& cacheEntry)
+{
+    l_CacheFileReader recordReader;
+    std::filesystem::path::string_type fileName;
+    uint32_t recordSize;
+
+    cacheEntry = {};
+
+    // ensure the whole record is available,
+    // the last record might be truncated when
+    // we weren't able to finish appending it
+    if (!read_value(reader, recordSize) ||
+        (reader.size - reader.offset) < recordSize)
+    {
+        return false;
+    }
+
+    recordReader = { reader.data + reader.offset, recordSize, 0 };
+    reader.offset += recordSize;
+
+    // file info & validity
+    if (!read_string(recordReader, fileName) ||
+        !read_value(recordReader, cacheEntry.fileTime) ||
+        !read_value(recordReader, cacheEntry.valid))
+    {
+        return false;
+    }
+
+    cacheEntry.fileName = fileName;
+
+    // invalid entries have less data
+    // so we don't need to read further
+    if (!cacheEntry.valid)
+    {
+        return true;
+    }
+
+    if (// type
+        !read_value(recordReader, cacheEntry.type) ||
+        // header
+        !read_string(recordReader, cacheEntry.header.Name) ||
+        !read_string(recordReader, cacheEntry.header.GameID) ||
+        !read_string(recordReader, cacheEntry.header.Region) ||
+        !read_value(recordReader, cacheEntry.header.CRC1) ||
+        !read_value(recordReader, cacheEntry.header.CRC2) ||
+        !read_value(recordReader, cacheEntry.header.CountryCode) ||
+        !read_value(recordReader, cacheEntry.header.SystemType) ||
+        // shared settings
+        !read_string(recordReader, cacheEntry.settings.GoodName) ||
+        !read_string(recordReader, cacheEntry.settings.MD5) ||
+        // default settings
+        !read_value(recordReader, cacheEntry.defaultSettings.SaveType) ||
+        !read_value(recordReader, cacheEntry.defaultSettings.DisableExtraMem) ||
+        !read_value(recordReader, cacheEntry.defaultSettings.TransferPak) ||
+        !read_value(recordReader, cacheEntry.defaultSettings.CountPerOp) ||
+        !read_value(recordReader, cacheEntry.defaultSettings.SiDMADuration) ||
+        !read_value(recordReader, cacheEntry.defaultSettings.RunAheadFrames) ||
+        // current settings
+        !read_value(recordReader, cacheEntry.settings.SaveType) ||
+        !read_value(recordReader, cacheEntry.settings.DisableExtraMem) ||
+        !read_value(recordReader, cacheEntry.settings.TransferPak) ||
+        !read_value(recordReader, cacheEntry.settings.CountPerOp) ||
+        !read_value(recordReader, cacheEntry.settings.SiDMADuration) ||
+        !read_value(recordReader, cacheEntry.settings.RunAheadFrames))
+    {
+        return false;
+    }
+
+    cacheEntry.defaultSettings.GoodName = cacheEntry.settings.GoodName;
+    cacheEntry.defaultSettings.MD5      = cacheEntry.settings.MD5;
+    return true;
+}
+
+static l_CacheEntryIter get_cache_entry_iter(const std::filesystem::path& file, bool checkFileTime = true)
+{
+    auto iter = l_CacheEntriesByFileName.find(file.native());
+    if (iter == l_CacheEntriesByFileName.end())
+    {
+        return l_CacheEntries.end();
+    }
+
+    if (checkFileTime && (*iter->second).fileTime != CoreGetFileTime(file))
+    {
+        return l_CacheEntries.end();
+    }
+
+    return iter->second;
+}
+
+static void remove_cache_entry(l_CacheEntryIter iter)
+{
+    l_CacheEntriesByFileName.erase((*iter).fileName.native());
+
+    // only remove the MD5 index which
+    // refers to the entry we're removing
+    auto md5Range = l_CacheEntriesByMD5.equal_range((*iter).settings.MD5);
+    for (auto md5Iter = md5Range.first; md5Iter != md5Range.second; md5Iter++)
+    {
+        if (md5Iter->second == iter)
+        {
+            l_CacheEntriesByMD5.erase(md5Iter);
+            break;
+        }
+    }
+
+    l_CacheEntries.erase(iter);
+}
+
+static void set_cache_entry(const l_CacheEntry& cacheEntry, bool changed)
+{
     // try to find existing entry with same filename,
     // when found, remove it from the cache
-    auto iter = get_cache_entry_iter(file, false);
+    auto iter = get_cache_entry_iter(cacheEntry.fileName, false);
     if (iter != l_CacheEntries.end())
     {
-        l_CacheEntries.erase(iter);
+        remove_cache_entry(iter);
     }
     else if (l_CacheEntries.size() >= CACHE_FILE_ITEMS_MAX)
     { // delete first item when we're over the item limit
-        l_CacheEntries.erase(l_CacheEntries.begin());
+        remove_cache_entry(l_CacheEntries.begin());
+    }
+
+    l_CacheEntries.push_back(cacheEntry);
+
+    iter = std::prev(l_CacheEntries.end());
+    l_CacheEntriesByFileName[cacheEntry.fileName.native()] = iter;
+    if (cacheEntry.valid)
+    {
+        l_CacheEntriesByMD5.emplace(cacheEntry.settings.MD5, iter);
+    }
+
+    if (changed)
+    {
+        l_ChangedCacheEntries.push_back(cacheEntry);
     }
+}
+
+static void add_cache_entry(const std::filesystem::path& file, CoreRomType type, 
+                            const CoreRomHeader& header, const CoreRomSettings& defaultSettings,
+                            const CoreRomSettings& settings)
+{
+    l_CacheEntry cacheEntry;
 
     cacheEntry.fileName = file;
     cacheEntry.fileTime = CoreGetFileTime(file);
@@ -115,32 +460,60 @@ static void add_cache_entry(const std::filesystem::path& file, CoreRomType type,
     cacheEntry.defaultSettings = defaultSettings;
     cacheEntry.valid    = true;
 
-    l_CacheEntries.push_back(cacheEntry);
-    l_CacheEntriesChanged = true;
+    set_cache_entry(cacheEntry, true);
 }
 
 static void add_invalid_cache_entry(const std::filesystem::path& file)
 {
-    l_CacheEntry cacheEntry;
+    l_CacheEntry cacheEntry = {};
 
-    // try to find existing entry with same filename,
-    // when found, remove it from the cache
-    auto iter = get_cache_entry_iter(file, false);
-    if (iter != l_CacheEntries.end())
+    cacheEntry.fileName = file;
+    cacheEntry.fileTime = CoreGetFileTime(file);
+    cacheEntry.valid    = false;
+
+    set_cache_entry(cacheEntry, true);
+}
+
+static bool get_rom_header_and_settings_from_core(const std::filesystem::path& file, CoreRomType& type, CoreRomHeader& header,
+                                                  CoreRomSettings& defaultSettings, CoreRomSettings& settings)
+{
+    bool ret;
+
+    ret = CoreOpenRom(file) &&
+            CoreGetRomType(type) &&
+            CoreGetCurrentRomHeader(header) &&
+            CoreGetCurrentRomSettings(settings) &&
+            CoreGetCurrentDefaultRomSettings(defaultSettings);
+    // always close ROM
+    if (CoreHasRomOpen() && !CoreCloseRom())
     {
-        l_CacheEntries.erase(iter);
+        ret = false;
     }
-    else if (l_CacheEntries.size() >= CACHE_FILE_ITEMS_MAX)
-    { // delete first item when we're over the item limit
-        l_CacheEntries.erase(l_CacheEntries.begin());
+
+    return ret;
+}
+
+static bool get_rom_header_and_settings_from_scan(const std::filesystem::path& file, bool scanned, bool isDisk,
+                                                  CoreRomType& type, CoreRomHeader& header,
+                                                  CoreRomSettings& defaultSettings, CoreRomSettings& settings)
+{
+    // disks can only be opened by the core
+    if (isDisk)
+    {
+        return get_rom_header_and_settings_from_core(file, type, header, defaultSettings, settings);
     }
 
-    cacheEntry.fileName = file;
-    cacheEntry.fileTime = CoreGetFileTime(file);
-    cacheEntry.valid    = false;
+    if (!scanned)
+    {
+        return false;
+    }
 
-    l_CacheEntries.push_back(cacheEntry);
-    l_CacheEntriesChanged = true;
+    // the scanner only retrieves the default settings,
+    // so apply the settings overlay like CoreOpenRom does
+    type            = CoreRomType::Cartridge;
+    defaultSettings = settings;
+    CoreGetRomSettingsOverlay(settings);
+    return true;
 }
 
 //
@@ -149,227 +522,114 @@ static void add_invalid_cache_entry(const std::filesystem::path& file)
 
 CORE_EXPORT void CoreReadRomHeaderAndSettingsCache(void)
 {
-    std::ifstream inputStream;
-    char magicBuf[sizeof(CACHE_FILE_MAGIC)];
-    wchar_t fileNameBuf[CORE_DIR_MAX_LEN];
-    char headerNameBuf[ROMHEADER_NAME_LEN];
-    char gameIDBuf[GAMEID_LEN];
-    char regionBuf[REGION_LEN];
-    char goodNameBuf[GOODNAME_LEN];
-    char md5Buf[MD5_LEN];
-    uint32_t size;
+    l_MappedFile mappedFile;
+    l_CacheFileReader reader;
     l_CacheEntry cacheEntry;
 
-    inputStream.open(get_cache_file_name(), std::ios::binary);
-    if (!inputStream.good())
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
+    if (!map_file(get_cache_file_name(), mappedFile))
     {
         return;
     }
 
-    // when magic doesn't match, don't read cache file
-    inputStream.read((char*)magicBuf, sizeof(CACHE_FILE_MAGIC));
-    if (std::string(magicBuf) != std::string(CACHE_FILE_MAGIC))
+    // when magic doesn't match, don't read cache file,
+    // it'll be rewritten when saving the cache
+    if (mappedFile.size < sizeof(CACHE_FILE_MAGIC) ||
+        memcmp(mappedFile.data, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0)
     {
-        inputStream.close();
+        unmap_file(mappedFile);
         return;
     }
 
-    // read entry count
-    size = l_CacheEntries.size();
-    inputStream.read((char*)&size, sizeof(size));
-
-    // reserve items
-    l_CacheEntries.reserve(size);
-
-    // read all file entries
-#define FREAD(x) inputStream.read((char*)&x, sizeof(x))
-#define FREAD_STR(x, y) inputStream.read((char*)x, y)
-    while (!inputStream.eof())
-    {
-        // reset state
-        size = 0;
-        cacheEntry = {};
-        memset(fileNameBuf, 0, sizeof(fileNameBuf));
-        memset(headerNameBuf, 0, sizeof(headerNameBuf));
-        memset(gameIDBuf, 0, sizeof(gameIDBuf));
-        memset(regionBuf, 0, sizeof(regionBuf));
-        memset(goodNameBuf, 0, sizeof(goodNameBuf));
-        memset(md5Buf, 0, sizeof(md5Buf));
-
-        // file info
-        FREAD(size);
-        FREAD_STR(fileNameBuf, size);
-        cacheEntry.fileName = std::filesystem::path(fileNameBuf);
-        FREAD(cacheEntry.fileTime);
-        // validity
-        FREAD(cacheEntry.valid);
-        // invalid entries have less data
-        // so we don't need to read further
-        if (!cacheEntry.valid)
-        {
-            l_CacheEntries.push_back(cacheEntry);
-            continue;
+    reader = { mappedFile.data, mappedFile.size, sizeof(CACHE_FILE_MAGIC) };
+    l_CacheFileRewrite = false;
+
+    // read all records, later records
+    // replace earlier records with the
+    // same filename
+    while (reader.offset < reader.size)
+    {
+        if (!read_cache_entry(reader, cacheEntry))
+        { // rewrite the cache file when it's corrupt
+            l_CacheFileRewrite = true;
+            break;
         }
-        // type
-        FREAD(cacheEntry.type);
-        // header
-        FREAD(size);
-        FREAD_STR(headerNameBuf, size);
-        FREAD(size);
-        FREAD_STR(gameIDBuf, size);
-        FREAD(size);
-        FREAD_STR(regionBuf, size);
-        cacheEntry.header.Name = std::string(headerNameBuf);
-        cacheEntry.header.GameID = std::string(gameIDBuf);
-        cacheEntry.header.Region = std::string(regionBuf);
-        FREAD(cacheEntry.header.CRC1);
-        FREAD(cacheEntry.header.CRC2);
-        FREAD(cacheEntry.header.CountryCode);
-        FREAD(cacheEntry.header.SystemType);
-        // shared settings
-        FREAD(size);
-        FREAD_STR(goodNameBuf, size);
-        FREAD(size);
-        FREAD_STR(md5Buf, size);
-        cacheEntry.defaultSettings.GoodName = std::string(goodNameBuf);
-        cacheEntry.defaultSettings.MD5 = std::string(md5Buf);
-        cacheEntry.settings.GoodName = std::string(goodNameBuf);
-        cacheEntry.settings.MD5 = std::string(md5Buf);
-        // default settings
-        FREAD(cacheEntry.defaultSettings.SaveType);
-        FREAD(cacheEntry.defaultSettings.DisableExtraMem);
-        FREAD(cacheEntry.defaultSettings.TransferPak);
-        FREAD(cacheEntry.defaultSettings.CountPerOp);
-        FREAD(cacheEntry.defaultSettings.SiDMADuration);
-        // current settings
-        FREAD(cacheEntry.settings.SaveType);
-        FREAD(cacheEntry.settings.DisableExtraMem);
-        FREAD(cacheEntry.settings.TransferPak);
-        FREAD(cacheEntry.settings.CountPerOp);
-        FREAD(cacheEntry.settings.SiDMADuration);
 
-        // add to cached entries
-        l_CacheEntries.push_back(cacheEntry);
+        set_cache_entry(cacheEntry, false);
+        l_CacheFileRecordCount++;
     }
-#undef FREAD
-#undef FREAD_STR
 
-    inputStream.close();
+    unmap_file(mappedFile);
 }
 
 CORE_EXPORT bool CoreSaveRomHeaderAndSettingsCache(void)
 {
     std::ofstream outputStream;
-    wchar_t fileNameBuf[CORE_DIR_MAX_LEN];
-    char headerNameBuf[ROMHEADER_NAME_LEN];
-    char gameIDBuf[GAMEID_LEN];
-    char regionBuf[REGION_LEN];
-    char goodNameBuf[GOODNAME_LEN];
-    char md5Buf[MD5_LEN];
-    uint32_t size;
-    l_CacheEntry cacheEntry;
+    std::vector<char> buffer;
+    bool rewrite;
+
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
 
     // only save cache when the entries have changed
-    if (!l_CacheEntriesChanged)
+    if (!l_CacheFileRewrite && l_ChangedCacheEntries.empty())
     {
         return true;
     }
 
-    outputStream.open(get_cache_file_name(), std::ios::binary);
-    if (!outputStream.good())
+    // rewrite the whole cache file when appending
+    // would leave too many outdated records in it
+    rewrite = l_CacheFileRewrite ||
+                (l_CacheFileRecordCount + l_ChangedCacheEntries.size()) > 
+                    (l_CacheEntries.size() * CACHE_FILE_COMPACT_FACTOR);
+
+    if (rewrite)
     {
-        return false;
-    }
+        buffer.insert(buffer.end(), CACHE_FILE_MAGIC, CACHE_FILE_MAGIC + sizeof(CACHE_FILE_MAGIC));
+        for (const l_CacheEntry& cacheEntry : l_CacheEntries)
+        {
+            write_cache_entry(buffer, cacheEntry);
+        }
 
-    // write magic header
-    outputStream.write((char*)CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
-
-    // write entry count
-    size = l_CacheEntries.size();
-    outputStream.write((char*)&size, sizeof(size));
-
-    // write each entry in the file
-#define FWRITE(x) outputStream.write((char*)&x, sizeof(x))
-#define FWRITE_STR(x, y) outputStream.write((char*)x, y)
-    for (auto iter = l_CacheEntries.cbegin(); iter != l_CacheEntries.end(); iter++)
-    {
-        cacheEntry = (*iter);
-
-        // reset buffers
-        size = 0;
-        memset(fileNameBuf, 0, sizeof(fileNameBuf));
-        memset(headerNameBuf, 0, sizeof(headerNameBuf));
-        memset(gameIDBuf, 0, sizeof(gameIDBuf));
-        memset(regionBuf, 0, sizeof(regionBuf));
-        memset(goodNameBuf, 0, sizeof(goodNameBuf));
-        memset(md5Buf, 0, sizeof(md5Buf));
-
-        // copy strings into buffers
-        wcsncpy(fileNameBuf, cacheEntry.fileName.wstring().c_str(), CORE_DIR_MAX_LEN);
-        strncpy(headerNameBuf, cacheEntry.header.Name.c_str(), sizeof(headerNameBuf));
-        strncpy(gameIDBuf, cacheEntry.header.GameID.c_str(), sizeof(gameIDBuf));
-        strncpy(regionBuf, cacheEntry.header.Region.c_str(), sizeof(regionBuf));
-        strncpy(goodNameBuf, cacheEntry.settings.GoodName.c_str(), sizeof(goodNameBuf));
-        strncpy(md5Buf, cacheEntry.settings.MD5.c_str(), sizeof(md5Buf));
-
-        // file info
-        size = cacheEntry.fileName.wstring().size() * sizeof(wchar_t);
-        FWRITE(size);
-        FWRITE_STR(fileNameBuf, size);
-        FWRITE(cacheEntry.fileTime);
-        // validity
-        FWRITE(cacheEntry.valid);
-        // skip writing more data
-        // when the entry is invalid
-        if (!cacheEntry.valid)
+        outputStream.open(get_cache_file_name(), std::ios::binary | std::ios::trunc);
+    }
+    else
+    {
+        for (const l_CacheEntry& cacheEntry : l_ChangedCacheEntries)
         {
-            continue;
+            write_cache_entry(buffer, cacheEntry);
         }
-        // type
-        FWRITE(cacheEntry.type);
-        // header
-        size = cacheEntry.header.Name.size();
-        FWRITE(size);
-        FWRITE_STR(headerNameBuf, size);
-        size = cacheEntry.header.GameID.size();
-        FWRITE(size);
-        FWRITE_STR(gameIDBuf, size);
-        size = cacheEntry.header.Region.size();
-        FWRITE(size);
-        FWRITE_STR(regionBuf, size);
-        FWRITE(cacheEntry.header.CRC1);
-        FWRITE(cacheEntry.header.CRC2);
-        FWRITE(cacheEntry.header.CountryCode);
-        FWRITE(cacheEntry.header.SystemType);
-        // shared settings
-        size = cacheEntry.settings.GoodName.size();
-        FWRITE(size);
-        FWRITE_STR(goodNameBuf, size);
-        size = cacheEntry.settings.MD5.size();
-        FWRITE(size);
-        FWRITE_STR(md5Buf, size);
-        // default settings
-        FWRITE(cacheEntry.defaultSettings.SaveType);
-        FWRITE(cacheEntry.defaultSettings.DisableExtraMem);
-        FWRITE(cacheEntry.defaultSettings.TransferPak);
-        FWRITE(cacheEntry.defaultSettings.CountPerOp);
-        FWRITE(cacheEntry.defaultSettings.SiDMADuration);
-        // current settings
-        FWRITE(cacheEntry.settings.SaveType);
-        FWRITE(cacheEntry.settings.DisableExtraMem);
-        FWRITE(cacheEntry.settings.TransferPak);
-        FWRITE(cacheEntry.settings.CountPerOp);
-        FWRITE(cacheEntry.settings.SiDMADuration);
+
+        outputStream.open(get_cache_file_name(), std::ios::binary | std::ios::app);
+    }
+
+    if (!outputStream.good())
+    {
+        return false;
     }
-#undef FWRITE
-#undef FWRITE_STR
 
+    outputStream.write(buffer.data(), buffer.size());
     outputStream.close();
+    if (outputStream.fail())
+    {
+        // ensure the next save rewrites
+        // the possibly broken cache file
+        l_CacheFileRewrite = true;
+        return false;
+    }
+
+    l_CacheFileRecordCount = rewrite ? 
+                                l_CacheEntries.size() : 
+                                (l_CacheFileRecordCount + l_ChangedCacheEntries.size());
+    l_CacheFileRewrite = false;
+    l_ChangedCacheEntries.clear();
     return true;
 }
 
 CORE_EXPORT bool CoreGetCachedRomHeaderAndSettings(std::filesystem::path file, CoreRomType* type, CoreRomHeader* header, CoreRomSettings* defaultSettings, CoreRomSettings* settings)
 {
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
     bool ret = false;
     auto iter = get_cache_entry_iter(file);
     if (iter == l_CacheEntries.end())
@@ -378,21 +638,14 @@ CORE_EXPORT bool CoreGetCachedRomHeaderAndSettings(std::filesystem::path file, C
         CoreRomHeader romHeader;
         CoreRomSettings romSettings;
         CoreRomSettings romDefaultSettings;
+        bool isDisk;
 
         // when we haven't found a cached entry,
         // we're gonna attempt to retrieve the
         // rom header and settings and add it
         // to the cache
-        ret = CoreOpenRom(file) &&
-                CoreGetRomType(romType) &&
-                CoreGetCurrentRomHeader(romHeader) &&
-                CoreGetCurrentRomSettings(romSettings) &&
-                CoreGetCurrentDefaultRomSettings(romDefaultSettings);
-        // always close ROM
-        if (CoreHasRomOpen() && !CoreCloseRom())
-        {
-            ret = false;
-        }
+        ret = CoreScanRomFile(file, romHeader, romSettings, isDisk);
+        ret = get_rom_header_and_settings_from_scan(file, ret, isDisk, romType, romHeader, romDefaultSettings, romSettings);
         // add file to cache
         if (ret)
         {
@@ -413,7 +666,7 @@ CORE_EXPORT bool CoreGetCachedRomHeaderAndSettings(std::filesystem::path file, C
                 *defaultSettings = romDefaultSettings;
             }
 
-            add_cache_entry(file, romType, romHeader, romSettings, romDefaultSettings);
+            add_cache_entry(file, romType, romHeader, romDefaultSettings, romSettings);
             return true;
         }
         else
@@ -447,10 +700,208 @@ CORE_EXPORT bool CoreGetCachedRomHeaderAndSettings(std::filesystem::path file, C
     return true;
 }
 
+CORE_EXPORT void CoreGetCachedRomHeaderAndSettings(const std::vector<std::filesystem::path>& files, bool openDisks,
+                                                   std::function<bool(const CoreRomHeaderAndSettings&, size_t processed)> callback)
+{
+    CoreRomHeaderAndSettings data;
+    std::vector<size_t> uncachedFiles;
+    size_t processed = 0;
+
+    // return the cached entries first,
+    // the lock isn't held while calling
+    // the callback
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        {
+            const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
+            auto iter = get_cache_entry_iter(files[i]);
+            if (iter == l_CacheEntries.end())
+            {
+                uncachedFiles.push_back(i);
+                continue;
+            }
+
+            processed++;
+
+            if (!(*iter).valid)
+            {
+                continue;
+            }
+
+            data.File            = files[i];
+            data.Type            = (*iter).type;
+            data.Header          = (*iter).header;
+            data.DefaultSettings = (*iter).defaultSettings;
+            data.Settings        = (*iter).settings;
+        }
+
+        if (!callback(data, processed))
+        {
+            return;
+        }
+    }
+
+    if (uncachedFiles.empty())
+    {
+        return;
+    }
+
+    // scan the uncached files on worker threads,
+    // the results are added to the cache on this
+    // thread because the settings aren't thread-safe
+    std::mutex               resultsMutex;
+    std::condition_variable  resultsCondition;
+    std::deque<l_ScanResult> results;
+    std::atomic<size_t>      nextFile = 0;
+    std::atomic<bool>        stop     = false;
+    std::vector<std::thread> threads;
+
+    const size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, uncachedFiles.size());
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            l_ScanResult result;
+
+            while (!stop)
+            {
+                result       = {};
+                result.index = nextFile++;
+                if (result.index >= uncachedFiles.size())
+                {
+                    break;
+                }
+
+                result.valid = CoreScanRomFile(files[uncachedFiles[result.index]], result.header, result.settings, result.isDisk);
+
+                {
+                    const std::lock_guard<std::mutex> guard(resultsMutex);
+                    results.push_back(result);
+                }
+                resultsCondition.notify_one();
+            }
+        });
+    }
+
+    for (size_t i = 0; i < uncachedFiles.size() && !stop; i++)
+    {
+        l_ScanResult result;
+        bool         ret;
+
+        {
+            std::unique_lock<std::mutex> lock(resultsMutex);
+            resultsCondition.wait(lock, [&results]() { return !results.empty(); });
+            result = results.front();
+            results.pop_front();
+        }
+
+        processed++;
+
+        // don't add skipped disks to the cache,
+        // so they're opened by the next scan
+        // which is allowed to open them
+        if (result.isDisk && !openDisks)
+        {
+            continue;
+        }
+
+        data.File     = files[uncachedFiles[result.index]];
+        data.Header   = result.header;
+        data.Settings = result.settings;
+
+        {
+            const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
+            ret = get_rom_header_and_settings_from_scan(data.File, result.valid, result.isDisk,
+                                                        data.Type, data.Header, data.DefaultSettings, data.Settings);
+            if (!ret)
+            {
+                add_invalid_cache_entry(data.File);
+                continue;
+            }
+
+            add_cache_entry(data.File, data.Type, data.Header, data.DefaultSettings, data.Settings);
+        }
+
+        if (!callback(data, processed))
+        {
+            stop = true;
+        }
+    }
+
+    // wait for the worker threads to finish
+    stop = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // appending the new entries to the cache
+    // file is cheap, so do it right away
+    CoreSaveRomHeaderAndSettingsCache();
+}
+
+CORE_EXPORT std::vector<CoreRomHeaderAndSettings> CoreGetCachedRomHeaderAndSettingsInDirectory(std::filesystem::path directory, bool recursive)
+{
+    std::vector<CoreRomHeaderAndSettings> data;
+    std::filesystem::path normalDirectory = directory.lexically_normal();
+    std::filesystem::path parentDirectory;
+
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
+    // remove the trailing separator
+    if (!normalDirectory.has_filename())
+    {
+        normalDirectory = normalDirectory.parent_path();
+    }
+
+    for (const l_CacheEntry& cacheEntry : l_CacheEntries)
+    {
+        if (!cacheEntry.valid)
+        {
+            continue;
+        }
+
+        parentDirectory = cacheEntry.fileName.parent_path().lexically_normal();
+
+        // when searching recursively, the file can be
+        // in any sub-directory, so only check whether
+        // the directory is a prefix of its parent directory
+        if (recursive)
+        {
+            auto mismatch = std::mismatch(normalDirectory.begin(), normalDirectory.end(),
+                                          parentDirectory.begin(), parentDirectory.end());
+            if (mismatch.first != normalDirectory.end())
+            {
+                continue;
+            }
+        }
+        else if (parentDirectory != normalDirectory)
+        {
+            continue;
+        }
+
+        data.push_back(
+        {
+            cacheEntry.fileName,
+            cacheEntry.type,
+            cacheEntry.header,
+            cacheEntry.defaultSettings,
+            cacheEntry.settings
+        });
+    }
+
+    return data;
+}
+
 CORE_EXPORT bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file, CoreRomType type, CoreRomHeader header, CoreRomSettings defaultSettings, CoreRomSettings settings)
 {
     l_CacheEntry cachedEntry;
 
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
     // try to find existing entry with same filename,
     // when not found, do nothing
     auto iter = get_cache_entry_iter(file, false);
@@ -463,17 +914,18 @@ CORE_EXPORT bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file
 
     // check if the cached entry needs to be updated,
     // if it does, then update the entry
-    if (cachedEntry.type != type ||
+    if (!cachedEntry.valid ||
+        cachedEntry.type != type ||
         cachedEntry.header != header ||
         cachedEntry.defaultSettings != defaultSettings ||
         cachedEntry.settings != settings)
     {
-        (*iter).type            = type;
-        (*iter).header          = header;
-        (*iter).defaultSettings = defaultSettings;
-        (*iter).settings        = settings;
-        (*iter).valid           = true;
-        l_CacheEntriesChanged   = true;
+        cachedEntry.type            = type;
+        cachedEntry.header          = header;
+        cachedEntry.defaultSettings = defaultSettings;
+        cachedEntry.settings        = settings;
+        cachedEntry.valid           = true;
+        set_cache_entry(cachedEntry, true);
     }
 
     return true;
@@ -486,6 +938,8 @@ CORE_EXPORT bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file
     CoreRomSettings defaultSettings;
     CoreRomSettings settings;
 
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
     // try to find existing entry with same filename,
     // when not found, do nothing
     auto iter = get_cache_entry_iter(file, false);
@@ -506,9 +960,32 @@ CORE_EXPORT bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file
     return CoreUpdateCachedRomHeaderAndSettings(file, type, header, defaultSettings, settings);
 }
 
+CORE_EXPORT bool CoreFindCachedRomFileByMD5(std::string md5, std::filesystem::path& file)
+{
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
+    auto range = l_CacheEntriesByMD5.equal_range(md5);
+    for (auto iter = range.first; iter != range.second; iter++)
+    {
+        // ensure the file hasn't changed
+        if ((*iter->second).fileTime == CoreGetFileTime((*iter->second).fileName))
+        {
+            file = (*iter->second).fileName;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 CORE_EXPORT bool CoreClearRomHeaderAndSettingsCache(void)
 {
+    const std::lock_guard<std::recursive_mutex> guard(l_CacheMutex);
+
     l_CacheEntries.clear();
-    l_CacheEntriesChanged = true;
+    l_CacheEntriesByFileName.clear();
+    l_CacheEntriesByMD5.clear();
+    l_ChangedCacheEntries.clear();
+    l_CacheFileRewrite = true;
     return true;
 }
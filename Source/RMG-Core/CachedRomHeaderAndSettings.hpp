@@ -11,11 +11,23 @@
 #define CORE_CACHEDROMHEADERANDSETTINGS_HPP
 
 #include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
 
 #include "Rom.hpp"
 #include "RomHeader.hpp"
 #include "RomSettings.hpp"
 
+struct CoreRomHeaderAndSettings
+{
+    std::filesystem::path File;
+    CoreRomType     Type;
+    CoreRomHeader   Header;
+    CoreRomSettings DefaultSettings;
+    CoreRomSettings Settings;
+};
+
 #ifdef CORE_INTERNAL
 // attempts to read rom header & settings cache
 void CoreReadRomHeaderAndSettingsCache(void);
@@ -30,6 +42,22 @@ bool CoreSaveRomHeaderAndSettingsCache(void);
 // an entry if there's no cached entry found
 bool CoreGetCachedRomHeaderAndSettings(std::filesystem::path file, CoreRomType* type, CoreRomHeader* header, CoreRomSettings* defaultSettings, CoreRomSettings* settings);
 
+// retrieves the rom header & settings for all given files, files which
+// aren't cached yet are scanned by a pool of worker threads without
+// opening them in the core, disks can only be opened by the core, so
+// when openDisks is false, uncached disks are skipped, callback is called
+// from the calling thread for every valid file (in no particular order),
+// processed contains the amount of files which have been processed so far,
+// returning false from callback stops the scan
+void CoreGetCachedRomHeaderAndSettings(const std::vector<std::filesystem::path>& files, bool openDisks,
+                                       std::function<bool(const CoreRomHeaderAndSettings&, size_t processed)> callback);
+
+// retrieves the cached rom header & settings of all valid entries
+// in the given directory (and its sub-directories when recursive is
+// true), the files themselves aren't accessed, so the results can
+// contain files which have been changed or removed since
+std::vector<CoreRomHeaderAndSettings> CoreGetCachedRomHeaderAndSettingsInDirectory(std::filesystem::path directory, bool recursive);
+
 // returns whether updating the cached rom header & settings succeeds
 bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file, CoreRomType type, CoreRomHeader header, CoreRomSettings defaultSettings, CoreRomSettings settings);
 
@@ -39,6 +67,10 @@ bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file, CoreRomTyp
 bool CoreUpdateCachedRomHeaderAndSettings(std::filesystem::path file);
 #endif // CORE_INTERNAL
 
+// returns whether finding the file of a cached entry
+// with the given MD5 succeeds
+bool CoreFindCachedRomFileByMD5(std::string md5, std::filesystem::path& file);
+
 // returns whether clearing rom header & settings cache
 // succeeds
 bool CoreClearRomHeaderAndSettingsCache(void);
@@ -16,6 +16,7 @@
 #include "Library.hpp"
 #include "Netplay.hpp"
 #include "Plugins.hpp"
+#include "Rewind.hpp"
 #include "Cheats.hpp"
 #include "Error.hpp"
 #include "File.hpp"
@@ -244,6 +245,13 @@ CORE_EXPORT bool CoreStartEmulation(std::filesystem::path n64rom, std::filesyste
     }
 #endif // NETPLAY
 
+    // rewinding would desync netplay,
+    // so only use it without netplay
+    if (!netplay)
+    {
+        CoreInitRewind();
+    }
+
     // only start emulation when initializing netplay
     // is successful or if there's no netplay requested
     if (!netplay || netplay_ret)
@@ -263,6 +271,11 @@ CORE_EXPORT bool CoreStartEmulation(std::filesystem::path n64rom, std::filesyste
     }
 #endif // NETPLAY
 
+    if (CoreHasInitRewind())
+    {
+        CoreShutdownRewind();
+    }
+
     CoreClearCheats();
     CoreDetachPlugins();
     CoreCloseRom();
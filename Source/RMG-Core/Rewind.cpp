@@ -0,0 +1,344 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#define CORE_INTERNAL
+#include "Settings.hpp"
+#include "Library.hpp"
+#include "Rewind.hpp"
+#include "Error.hpp"
+
+#include "m64p/Api.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <deque>
+
+//
+// Local Defines
+//
+
+// amount of unchanged words needed
+// to end a run in a delta
+#define REWIND_DELTA_MIN_GAP 4
+
+//
+// Local Variables
+//
+
+static bool l_RewindInitialized = false;
+static std::atomic<bool> l_Rewinding = false;
+
+static size_t l_StateWords = 0;
+static int    l_Interval   = 1;
+static int    l_FrameCount = 0;
+static bool   l_JobPending = false;
+
+// the newest snapshot, older snapshots
+// are reconstructed by applying the deltas
+// to it from newest to oldest
+static std::vector<uint32_t> l_CurrentState;
+static bool l_HasCurrentState    = false;
+static bool l_CurrentStateLoaded = false;
+
+// buffer which the core saves new snapshots into
+static std::vector<uint32_t> l_PendingState;
+
+static std::deque<std::vector<uint32_t>> l_Deltas;
+static std::vector<uint32_t> l_DeltaBuffer;
+static size_t l_DeltasSize    = 0;
+static size_t l_MaxDeltasSize = 0;
+
+//
+// Local Functions
+//
+
+// encodes the difference between both states as
+// a list of runs, each run consists of the amount
+// of unchanged words to skip, the amount of changed
+// words and the changed words xor'ed together, because
+// xor is its own inverse, the same delta is used to
+// go from the new state back to the old state
+static void encode_delta(const uint32_t* oldState, const uint32_t* newState, size_t words, std::vector<uint32_t>& delta)
+{
+    size_t i = 0;
+    size_t runStart;
+    size_t skipStart;
+    size_t gapEnd;
+
+    delta.clear();
+
+    while (i < words)
+    {
+        skipStart = i;
+        while (i < words && oldState[i] == newState[i])
+        {
+            i++;
+        }
+
+        if (i == words)
+        {
+            break;
+        }
+
+        // extend the run until there are enough
+        // unchanged words to make a new run worth it
+        runStart = i;
+        while (i < words)
+        {
+            if (oldState[i] != newState[i])
+            {
+                i++;
+                continue;
+            }
+
+            gapEnd = i;
+            while (gapEnd < words && (gapEnd - i) < REWIND_DELTA_MIN_GAP && oldState[gapEnd] == newState[gapEnd])
+            {
+                gapEnd++;
+            }
+
+            if ((gapEnd - i) >= REWIND_DELTA_MIN_GAP || gapEnd == words)
+            {
+                break;
+            }
+
+            i = gapEnd;
+        }
+
+        delta.push_back(static_cast<uint32_t>(runStart - skipStart));
+        delta.push_back(static_cast<uint32_t>(i - runStart));
+        for (size_t j = runStart; j < i; j++)
+        {
+            delta.push_back(oldState[j] ^ newState[j]);
+        }
+    }
+}
+
+static void apply_delta(uint32_t* state, const std::vector<uint32_t>& delta)
+{
+    size_t offset = 0;
+    size_t i      = 0;
+    uint32_t count;
+
+    while (i + 1 < delta.size())
+    {
+        offset += delta[i++];
+        count   = delta[i++];
+
+        for (uint32_t j = 0; j < count; j++)
+        {
+            state[offset++] ^= delta[i++];
+        }
+    }
+}
+
+static void save_state_callback(void*, int result)
+{
+    l_JobPending = false;
+
+    if (!result)
+    {
+        return;
+    }
+
+    if (l_HasCurrentState)
+    {
+        encode_delta(l_CurrentState.data(), l_PendingState.data(), l_StateWords, l_DeltaBuffer);
+
+        l_DeltasSize += l_DeltaBuffer.size() * sizeof(uint32_t);
+        l_Deltas.emplace_back(l_DeltaBuffer.begin(), l_DeltaBuffer.end());
+
+        // drop the oldest deltas when
+        // we're over the memory budget
+        while (l_DeltasSize > l_MaxDeltasSize && !l_Deltas.empty())
+        {
+            l_DeltasSize -= l_Deltas.front().size() * sizeof(uint32_t);
+            l_Deltas.pop_front();
+        }
+    }
+
+    l_CurrentState.swap(l_PendingState);
+    l_HasCurrentState    = true;
+    l_CurrentStateLoaded = false;
+}
+
+static void load_state_callback(void*, int result)
+{
+    l_JobPending         = false;
+    l_CurrentStateLoaded = result;
+}
+
+static void queue_state_job(m64p_command command, std::vector<uint32_t>& buffer, void (*callback)(void*, int))
+{
+    m64p_state_memory state;
+    m64p_error ret;
+
+    state.data     = buffer.data();
+    state.size     = buffer.size() * sizeof(uint32_t);
+    state.callback = callback;
+    state.context  = nullptr;
+
+    ret = m64p::Core.DoCommand(command, sizeof(m64p_state_memory), &state);
+    l_JobPending = (ret == M64ERR_SUCCESS);
+}
+
+static void frame_callback(unsigned int)
+{
+    // the core runs the jobs at the next safe point,
+    // so wait for the previous job to finish
+    if (l_JobPending)
+    {
+        return;
+    }
+
+    if (++l_FrameCount < l_Interval)
+    {
+        return;
+    }
+
+    l_FrameCount = 0;
+
+    if (!l_Rewinding)
+    {
+        queue_state_job(M64CMD_STATE_SAVE_MEMORY, l_PendingState, save_state_callback);
+        return;
+    }
+
+    if (!l_HasCurrentState)
+    {
+        return;
+    }
+
+    // when the current snapshot has already been
+    // restored, step back to the snapshot before it,
+    // when there are no older snapshots, the oldest
+    // snapshot is restored again
+    if (l_CurrentStateLoaded && !l_Deltas.empty())
+    {
+        apply_delta(l_CurrentState.data(), l_Deltas.back());
+        l_DeltasSize -= l_Deltas.back().size() * sizeof(uint32_t);
+        l_Deltas.pop_back();
+    }
+
+    queue_state_job(M64CMD_STATE_LOAD_MEMORY, l_CurrentState, load_state_callback);
+}
+
+//
+// Internal Functions
+//
+
+bool CoreInitRewind(void)
+{
+    std::string error;
+    m64p_error ret;
+    m64p_state_memory state = {};
+
+    if (!CoreSettingsGetBoolValue(SettingsID::Core_Rewind_Enabled))
+    {
+        return true;
+    }
+
+    if (!m64p::Core.IsHooked())
+    {
+        return false;
+    }
+
+    // retrieve the size of a state
+    ret = m64p::Core.DoCommand(M64CMD_STATE_SAVE_MEMORY, sizeof(m64p_state_memory), &state);
+    if (ret != M64ERR_SUCCESS)
+    {
+        error = "CoreInitRewind m64p::Core.DoCommand(M64CMD_STATE_SAVE_MEMORY) Failed: ";
+        error += m64p::Core.ErrorMessage(ret);
+        CoreSetError(error);
+        return false;
+    }
+
+    l_StateWords    = (state.size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    l_Interval      = std::max(1, CoreSettingsGetIntValue(SettingsID::Core_Rewind_Interval));
+    l_MaxDeltasSize = static_cast<size_t>(std::max(0, CoreSettingsGetIntValue(SettingsID::Core_Rewind_BufferSize))) * 1024 * 1024;
+    l_FrameCount    = 0;
+    l_JobPending    = false;
+
+    l_CurrentState.resize(l_StateWords);
+    l_PendingState.resize(l_StateWords);
+    l_HasCurrentState    = false;
+    l_CurrentStateLoaded = false;
+
+    ret = m64p::Core.DoCommand(M64CMD_SET_FRAME_CALLBACK, 0, (void*)frame_callback);
+    if (ret != M64ERR_SUCCESS)
+    {
+        error = "CoreInitRewind m64p::Core.DoCommand(M64CMD_SET_FRAME_CALLBACK) Failed: ";
+        error += m64p::Core.ErrorMessage(ret);
+        CoreSetError(error);
+        CoreShutdownRewind();
+        return false;
+    }
+
+    l_Rewinding         = false;
+    l_RewindInitialized = true;
+    return true;
+}
+
+bool CoreShutdownRewind(void)
+{
+    std::string error;
+    m64p_error ret = M64ERR_SUCCESS;
+
+    if (m64p::Core.IsHooked())
+    {
+        ret = m64p::Core.DoCommand(M64CMD_SET_FRAME_CALLBACK, 0, nullptr);
+        if (ret != M64ERR_SUCCESS)
+        {
+            error = "CoreShutdownRewind m64p::Core.DoCommand(M64CMD_SET_FRAME_CALLBACK) Failed: ";
+            error += m64p::Core.ErrorMessage(ret);
+            CoreSetError(error);
+        }
+    }
+
+    l_RewindInitialized = false;
+    l_Rewinding         = false;
+    l_JobPending        = false;
+    l_HasCurrentState   = false;
+
+    // free all memory
+    std::vector<uint32_t>().swap(l_CurrentState);
+    std::vector<uint32_t>().swap(l_PendingState);
+    std::vector<uint32_t>().swap(l_DeltaBuffer);
+    std::deque<std::vector<uint32_t>>().swap(l_Deltas);
+    l_DeltasSize = 0;
+
+    return ret == M64ERR_SUCCESS;
+}
+
+//
+// Exported Functions
+//
+
+CORE_EXPORT bool CoreHasInitRewind(void)
+{
+    return l_RewindInitialized;
+}
+
+CORE_EXPORT bool CoreSetRewinding(bool enabled)
+{
+    if (!l_RewindInitialized)
+    {
+        return false;
+    }
+
+    l_Rewinding = enabled;
+    return true;
+}
+
+CORE_EXPORT bool CoreIsRewinding(void)
+{
+    return l_RewindInitialized && l_Rewinding;
+}
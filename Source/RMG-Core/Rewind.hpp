@@ -0,0 +1,36 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CORE_REWIND_HPP
+#define CORE_REWIND_HPP
+
+#ifdef CORE_INTERNAL
+// attempts to initialize rewind using the
+// rewind settings, nothing is done when
+// rewind has been disabled
+bool CoreInitRewind(void);
+
+// attempts to shutdown rewind,
+// which frees all snapshots
+bool CoreShutdownRewind(void);
+#endif // CORE_INTERNAL
+
+// returns whether rewind has been initialized
+bool CoreHasInitRewind(void);
+
+// sets whether emulation is rewinding,
+// while rewinding, snapshots are restored
+// from newest to oldest at the same interval
+// as they're taken
+bool CoreSetRewinding(bool enabled);
+
+// returns whether emulation is rewinding
+bool CoreIsRewinding(void);
+
+#endif // CORE_REWIND_HPP
@@ -164,6 +164,25 @@ static CoreSystemType get_systemtype_from_countrycode(uint8_t countryCode)
     return systemType;
 }
 
+//
+// Internal Functions
+//
+
+CoreRomHeader CoreConvertRomHeader(m64p_rom_header m64p_header)
+{
+    CoreRomHeader header;
+
+    header.CRC1        = ntohl(m64p_header.CRC1);
+    header.CRC2        = ntohl(m64p_header.CRC2);
+    header.CountryCode = m64p_header.Country_code;
+    header.Name        = get_name_from_headername(m64p_header.Name);
+    header.GameID      = get_gameid_from_header(m64p_header);
+    header.Region      = get_region_from_countrycode(static_cast<char>(header.CountryCode));
+    header.SystemType  = get_systemtype_from_countrycode(header.CountryCode);
+
+    return header;
+}
+
 //
 // Exported Functions
 //
@@ -188,13 +207,6 @@ CORE_EXPORT bool CoreGetCurrentRomHeader(CoreRomHeader& header)
         return false;
     }
 
-    header.CRC1        = ntohl(m64p_header.CRC1);
-    header.CRC2        = ntohl(m64p_header.CRC2);
-    header.CountryCode = m64p_header.Country_code;
-    header.Name        = get_name_from_headername(m64p_header.Name);
-    header.GameID      = get_gameid_from_header(m64p_header);
-    header.Region      = get_region_from_countrycode(static_cast<char>(header.CountryCode));
-    header.SystemType  = get_systemtype_from_countrycode(header.CountryCode);
-
+    header = CoreConvertRomHeader(m64p_header);
     return true;
 }
@@ -13,6 +13,10 @@
 #include <cstdint>
 #include <string>
 
+#ifdef CORE_INTERNAL
+#include "m64p/api/m64p_types.h"
+#endif // CORE_INTERNAL
+
 enum class CoreSystemType
 {
     NTSC = 0,
@@ -45,4 +49,10 @@ struct CoreRomHeader
 // retrieves the currently opened ROM header
 bool CoreGetCurrentRomHeader(CoreRomHeader& header);
 
+#ifdef CORE_INTERNAL
+// converts the given mupen64plus ROM header
+// to a CoreRomHeader
+CoreRomHeader CoreConvertRomHeader(m64p_rom_header m64p_header);
+#endif // CORE_INTERNAL
+
 #endif // CORE_ROMHEADER_HPP
\ No newline at end of file
@@ -0,0 +1,339 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#define CORE_INTERNAL
+#include "RomScanner.hpp"
+#include "RomSettings.hpp"
+#include "RomHeader.hpp"
+#include "m64p/Api.hpp"
+#include "Archive.hpp"
+#include "Library.hpp"
+#include "String.hpp"
+#include "Error.hpp"
+#include "File.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// md5 includes
+#include <md5.h>
+
+//
+// Local Defines
+//
+
+#define ROM_MIN_SIZE 4096
+
+// amount of data which is byte swapped and hashed
+// at once, must be a multiple of 4
+#define ROM_SCAN_CHUNK_SIZE 1048576 /* 1 MiB */
+
+//
+// Local Structures
+//
+
+enum class RomByteOrder
+{
+    Invalid,
+    Native,   // .z64
+    Swapped,  // .v64
+    Reversed, // .n64
+};
+
+struct RomScanState
+{
+    uint64_t size = 0;
+    uint64_t processed = 0;
+    RomByteOrder byteOrder = RomByteOrder::Invalid;
+
+    // data which hasn't been processed yet
+    std::vector<char> pending;
+
+    m64p_rom_header header;
+    md5_state_t md5State;
+};
+
+//
+// Local Variables
+//
+
+static const uint8_t l_Z64Signature[4] = { 0x80, 0x37, 0x12, 0x40 };
+static const uint8_t l_V64Signature[4] = { 0x37, 0x80, 0x40, 0x12 };
+static const uint8_t l_N64Signature[4] = { 0x40, 0x12, 0x37, 0x80 };
+
+//
+// Local Functions
+//
+
+static RomByteOrder get_rom_byte_order(const char* data, uint64_t size)
+{
+    if (size < ROM_MIN_SIZE)
+    {
+        return RomByteOrder::Invalid;
+    }
+
+    if (memcmp(data, l_Z64Signature, sizeof(l_Z64Signature)) == 0)
+    {
+        return RomByteOrder::Native;
+    }
+    else if (memcmp(data, l_V64Signature, sizeof(l_V64Signature)) == 0 && size % 2 == 0)
+    {
+        return RomByteOrder::Swapped;
+    }
+    else if (memcmp(data, l_N64Signature, sizeof(l_N64Signature)) == 0 && size % 4 == 0)
+    {
+        return RomByteOrder::Reversed;
+    }
+
+    return RomByteOrder::Invalid;
+}
+
+static void swap_rom_to_native(RomByteOrder byteOrder, char* data, size_t size)
+{
+    // .v64 images have byte-swapped half-words (16-bit)
+    if (byteOrder == RomByteOrder::Swapped)
+    {
+        for (size_t i = 0; i + 1 < size; i += 2)
+        {
+            std::swap(data[i], data[i + 1]);
+        }
+    }
+    // .n64 images have byte-swapped words (32-bit)
+    else if (byteOrder == RomByteOrder::Reversed)
+    {
+        for (size_t i = 0; i + 3 < size; i += 4)
+        {
+            std::swap(data[i], data[i + 3]);
+            std::swap(data[i + 1], data[i + 2]);
+        }
+    }
+}
+
+// converts and hashes the given amount of
+// pending data, the first call validates
+// the image and retrieves the header
+static bool process_rom_data(RomScanState& state, size_t size)
+{
+    if (state.processed == 0)
+    {
+        state.byteOrder = get_rom_byte_order(state.pending.data(), state.size);
+        if (state.byteOrder == RomByteOrder::Invalid)
+        {
+            return false;
+        }
+
+        md5_init(&state.md5State);
+    }
+
+    // the header and MD5 are always
+    // retrieved from the native byte order
+    swap_rom_to_native(state.byteOrder, state.pending.data(), size);
+
+    if (state.processed == 0)
+    {
+        memcpy(&state.header, state.pending.data(), sizeof(m64p_rom_header));
+    }
+
+    md5_append(&state.md5State, reinterpret_cast<const md5_byte_t*>(state.pending.data()), size);
+
+    state.processed += size;
+    state.pending.erase(state.pending.begin(), state.pending.begin() + size);
+    return true;
+}
+
+static bool append_rom_data(RomScanState& state, uint64_t size, const char* data, size_t dataSize)
+{
+    state.size = size;
+
+    // ensure we don't receive more data than expected
+    if ((state.processed + state.pending.size() + dataSize) > state.size)
+    {
+        return false;
+    }
+
+    state.pending.insert(state.pending.end(), data, data + dataSize);
+
+    // only process whole chunks until the end,
+    // so the byte swapping never gets split
+    while (state.pending.size() >= ROM_SCAN_CHUNK_SIZE)
+    {
+        if (!process_rom_data(state, ROM_SCAN_CHUNK_SIZE))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool finish_rom_data(RomScanState& state, uint8_t md5[16])
+{
+    if ((state.processed + state.pending.size()) != state.size ||
+        (state.size == 0))
+    {
+        return false;
+    }
+
+    if (!state.pending.empty() &&
+        !process_rom_data(state, state.pending.size()))
+    {
+        return false;
+    }
+
+    md5_finish(&state.md5State, md5);
+    return true;
+}
+
+static bool read_rom_file(std::filesystem::path file, RomScanState& state)
+{
+    std::string error;
+    std::ifstream fileStream;
+    std::vector<char> chunk;
+    std::error_code errorCode;
+    uint64_t fileSize;
+    uint64_t remaining;
+
+    fileSize = std::filesystem::file_size(file, errorCode);
+    if (errorCode)
+    {
+        error = "CoreScanRomFile Failed: ";
+        error += "failed to retrieve file size: ";
+        error += errorCode.message();
+        CoreSetError(error);
+        return false;
+    }
+
+    fileStream.open(file, std::ios::binary);
+    if (!fileStream.is_open())
+    {
+        error = "CoreScanRomFile Failed: ";
+        error += "failed to open file: ";
+        error += strerror(errno);
+        error += " (";
+        error += std::to_string(errno);
+        error += ")";
+        CoreSetError(error);
+        return false;
+    }
+
+    remaining = fileSize;
+    chunk.resize(ROM_SCAN_CHUNK_SIZE);
+
+    while (remaining > 0)
+    {
+        size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(remaining, chunk.size()));
+
+        fileStream.read(chunk.data(), chunkSize);
+        if (fileStream.fail())
+        {
+            error = "CoreScanRomFile Failed: ";
+            error += "failed to read file!";
+            CoreSetError(error);
+            return false;
+        }
+
+        if (!append_rom_data(state, fileSize, chunk.data(), chunkSize))
+        {
+            return false;
+        }
+
+        remaining -= chunkSize;
+    }
+
+    return true;
+}
+
+//
+// Internal Functions
+//
+
+bool CoreScanRomFile(std::filesystem::path file, CoreRomHeader& header, CoreRomSettings& settings, bool& isDisk)
+{
+    std::string error;
+    std::string file_extension;
+    RomScanState state;
+    m64p_rom_database_lookup lookup;
+    m64p_error ret;
+    bool readRet = false;
+
+    isDisk = false;
+
+    if (!m64p::Core.IsHooked())
+    {
+        return false;
+    }
+
+    file_extension = file.has_extension() ? file.extension().string() : "";
+    file_extension = CoreLowerString(file_extension);
+
+    // ROMs are streamed in chunks so only a
+    // small part of each ROM is kept in memory,
+    // except for 7zip files, which can only
+    // be extracted at once
+    if (file_extension == ".zip")
+    {
+        std::filesystem::path extracted_file;
+
+        readRet = CoreReadZipFileChunks(file, extracted_file, isDisk, [&](uint64_t size, const char* data, size_t dataSize)
+        {
+            return !isDisk && append_rom_data(state, size, data, dataSize);
+        });
+    }
+    else if (file_extension == ".7z")
+    {
+        std::filesystem::path extracted_file;
+        std::vector<char> buf;
+
+        readRet = CoreRead7zipFile(file, extracted_file, isDisk, buf) && !isDisk &&
+                    append_rom_data(state, buf.size(), buf.data(), buf.size());
+    }
+    else if (file_extension == ".d64" ||
+             file_extension == ".ndd")
+    {
+        isDisk = true;
+        return false;
+    }
+    else
+    {
+        readRet = read_rom_file(file, state);
+    }
+
+    if (!readRet || isDisk)
+    {
+        return false;
+    }
+
+    memset(&lookup, 0, sizeof(lookup));
+
+    if (!finish_rom_data(state, lookup.md5))
+    {
+        error = "CoreScanRomFile Failed: ";
+        error += "not a valid ROM image!";
+        CoreSetError(error);
+        return false;
+    }
+
+    memcpy(&lookup.header, &state.header, sizeof(m64p_rom_header));
+
+    ret = m64p::Core.DoCommand(M64CMD_ROM_DATABASE_LOOKUP, sizeof(m64p_rom_database_lookup), &lookup);
+    if (ret != M64ERR_SUCCESS)
+    {
+        error = "CoreScanRomFile: m64p::Core.DoCommand(M64CMD_ROM_DATABASE_LOOKUP) Failed: ";
+        error += m64p::Core.ErrorMessage(ret);
+        CoreSetError(error);
+        return false;
+    }
+
+    header   = CoreConvertRomHeader(lookup.header);
+    settings = CoreConvertRomSettings(lookup.settings);
+    return true;
+}
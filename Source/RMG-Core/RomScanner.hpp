@@ -0,0 +1,28 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef CORE_ROMSCANNER_HPP
+#define CORE_ROMSCANNER_HPP
+
+#include <filesystem>
+
+#include "RomHeader.hpp"
+#include "RomSettings.hpp"
+
+#ifdef CORE_INTERNAL
+// attempts to retrieve the ROM header & default settings
+// for the given file without opening it in the core,
+// when the file is (or contains) a disk, isDisk is set
+// and false is returned because disks have to be opened
+// in the core, this function is safe to call from
+// multiple threads at once
+bool CoreScanRomFile(std::filesystem::path file, CoreRomHeader& header, CoreRomSettings& settings, bool& isDisk);
+#endif // CORE_INTERNAL
+
+#endif // CORE_ROMSCANNER_HPP
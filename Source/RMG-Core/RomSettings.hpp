@@ -13,6 +13,10 @@
 #include <cstdint>
 #include <string>
 
+#ifdef CORE_INTERNAL
+#include "m64p/api/m64p_types.h"
+#endif // CORE_INTERNAL
+
 struct CoreRomSettings
 {
     // rom goodname
@@ -29,6 +33,8 @@ struct CoreRomSettings
     int32_t CountPerOp;
     // SI DMA duration
     int32_t SiDMADuration;
+    // amount of frames to run ahead
+    int32_t RunAheadFrames;
 
     bool operator==(const CoreRomSettings& other) const
     {
@@ -38,7 +44,8 @@ struct CoreRomSettings
                 DisableExtraMem == other.DisableExtraMem &&
                 TransferPak == other.TransferPak &&
                 CountPerOp == other.CountPerOp &&
-                SiDMADuration == other.SiDMADuration;
+                SiDMADuration == other.SiDMADuration &&
+                RunAheadFrames == other.RunAheadFrames;
     }
 };
 
@@ -60,4 +67,14 @@ bool CoreApplyRomSettings(CoreRomSettings settings);
 // applies the ROM settings settings if they exist
 bool CoreApplyRomSettingsOverlay(void);
 
+#ifdef CORE_INTERNAL
+// converts the given mupen64plus ROM settings
+// to CoreRomSettings
+CoreRomSettings CoreConvertRomSettings(m64p_rom_settings m64p_settings);
+
+// applies the ROM settings overlay to the given
+// default settings, returns false when there's no overlay
+bool CoreGetRomSettingsOverlay(CoreRomSettings& settings);
+#endif // CORE_INTERNAL
+
 #endif // CORE_ROMSETTINGS_HPP
\ No newline at end of file
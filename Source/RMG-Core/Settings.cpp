@@ -22,6 +22,8 @@
 #include <algorithm>
 #include <sstream>
 #include <variant>
+#include <vector>
+#include <mutex>
 
 //
 // Local Defines
@@ -43,6 +45,13 @@ struct l_Setting
     bool ForceUseSetAlways  = false;
 };
 
+struct l_CachedSetting
+{
+    uint64_t Generation = 0;
+    bool     NoCache    = false;
+    std::variant<std::monostate, int, bool, float, std::string> Value = std::monostate();
+};
+
 //
 // Local Variables
 //
@@ -51,6 +60,13 @@ static m64p_handle              l_sectionHandle = nullptr;
 static std::vector<std::string> l_sectionList;
 static std::vector<std::string> l_keyList;
 
+// cache of the values retrieved by SettingsID,
+// an entry is only valid when its generation
+// matches l_SettingsCacheGeneration
+static std::mutex                   l_SettingsCacheMutex;
+static std::vector<l_CachedSetting> l_SettingsCache(static_cast<size_t>(SettingsID::Invalid));
+static uint64_t                     l_SettingsCacheGeneration = 1;
+
 //
 // Local Functions
 //
@@ -65,6 +81,7 @@ static std::vector<std::string> l_keyList;
 #define SETTING_SECTION_64DD        SETTING_SECTION_CORE " 64DD"
 #define SETTING_SECTION_PIF         SETTING_SECTION_CORE " PIF"
 #define SETTING_SECTION_GB          SETTING_SECTION_CORE " Gameboy"
+#define SETTING_SECTION_REWIND      SETTING_SECTION_CORE " Rewind"
 #define SETTING_SECTION_M64P        "Core"
 #define SETTING_SECTION_AUDIO       SETTING_SECTION_GUI  " - Audio Plugin"
 #define SETTING_SECTION_INPUT       SETTING_SECTION_GUI  " - Input Plugin"
@@ -248,6 +265,15 @@ static l_Setting get_setting(SettingsID settingId)
     case SettingsID::Core_SaveFileNameFormat:
         setting = {SETTING_SECTION_M64P, "SaveFilenameFormat", 1};
         break;
+    case SettingsID::Core_FramePacingDisplayLock:
+        setting = {SETTING_SECTION_M64P, "FramePacingDisplayLock", false};
+        break;
+    case SettingsID::Core_NetplayRollbackFrames:
+        setting = {SETTING_SECTION_M64P, "NetplayRollbackFrames", 0};
+        break;
+    case SettingsID::Core_NetplaySyncHashInterval:
+        setting = {SETTING_SECTION_M64P, "NetplaySyncHashInterval", 0};
+        break;
 
     case SettingsID::CoreOverlay_RandomizeInterrupt:
         setting = {SETTING_SECTION_OVERLAY, "RandomizeInterrupt", true};
@@ -332,6 +358,16 @@ static l_Setting get_setting(SettingsID settingId)
         setting = {SETTING_SECTION_GB, "Gameboy_P4_Save", std::string("")};
         break;
 
+    case SettingsID::Core_Rewind_Enabled:
+        setting = {SETTING_SECTION_REWIND, "Rewind_Enabled", false};
+        break;
+    case SettingsID::Core_Rewind_BufferSize:
+        setting = {SETTING_SECTION_REWIND, "Rewind_BufferSize", 256};
+        break;
+    case SettingsID::Core_Rewind_Interval:
+        setting = {SETTING_SECTION_REWIND, "Rewind_Interval", 2};
+        break;
+
     case SettingsID::Game_OverrideSettings:
         setting = {"", "OverrideSettings", false};
         break;
@@ -350,6 +386,9 @@ static l_Setting get_setting(SettingsID settingId)
     case SettingsID::Game_SiDmaDuration:
         setting = {"", "SiDmaDuration", 2304};
         break;
+    case SettingsID::Game_RunAheadFrames:
+        setting = {"", "RunAheadFrames", 0};
+        break;
 
     case SettingsID::Game_OverrideCoreSettings:
         setting = {"", "OverrideCoreSettings", false};
@@ -464,6 +503,9 @@ static l_Setting get_setting(SettingsID settingId)
     case SettingsID::KeyBinding_GSButton:
         setting = {SETTING_SECTION_KEYBIND, "GSButton", std::string("F9")};
         break;
+    case SettingsID::KeyBinding_Rewind:
+        setting = {SETTING_SECTION_KEYBIND, "Rewind", std::string("F8")};
+        break;
     case SettingsID::KeyBinding_SaveStateSlot0:
         setting = {SETTING_SECTION_KEYBIND, "SaveStateSlot0", std::string("Ctrl+0")};
         break;
@@ -540,6 +582,9 @@ static l_Setting get_setting(SettingsID settingId)
     case SettingsID::RomBrowser_Recursive:
         setting = {SETTING_SECTION_ROMBROWSER, "Recursive", true};
         break;
+    case SettingsID::RomBrowser_WatchDirectory:
+        setting = {SETTING_SECTION_ROMBROWSER, "WatchDirectory", true};
+        break;
     case SettingsID::RomBrowser_MaxItems:
         setting = {SETTING_SECTION_ROMBROWSER, "MaxItems", 1024};
         break;
@@ -602,6 +647,12 @@ static l_Setting get_setting(SettingsID settingId)
     case SettingsID::Audio_Synchronize:
         setting = {SETTING_SECTION_AUDIO, "Synchronize", false};
         break;
+    case SettingsID::Audio_DynamicRateControl:
+        setting = {SETTING_SECTION_AUDIO, "DynamicRateControl", false};
+        break;
+    case SettingsID::Audio_LowLatencyOutput:
+        setting = {SETTING_SECTION_AUDIO, "LowLatencyOutput", false};
+        break;
     case SettingsID::Audio_SimpleBackend:
         setting = {SETTING_SECTION_AUDIO, "SimpleBackend", false};
         break;
@@ -1353,11 +1404,86 @@ static l_Setting get_setting(SettingsID settingId)
     case SettingsID::Input_Hotkey_Fullscreen_ExtraData:
         setting = {"", "Hotkey_Fullscreen_ExtraData" };
         break;
+    case SettingsID::Input_Hotkey_Rewind_InputType:
+        setting = {"", "Hotkey_Rewind_InputType" };
+        break;
+    case SettingsID::Input_Hotkey_Rewind_Name:
+        setting = {"", "Hotkey_Rewind_Name" };
+        break;
+    case SettingsID::Input_Hotkey_Rewind_Data:
+        setting = {"", "Hotkey_Rewind_Data" };
+        break;
+    case SettingsID::Input_Hotkey_Rewind_ExtraData:
+        setting = {"", "Hotkey_Rewind_ExtraData" };
+        break;
     }
 
     return setting;
 }
 
+// has to be called after changing a setting, values
+// which have been read while it was being changed
+// would be cached otherwise
+static void settings_cache_invalidate(void)
+{
+    const std::lock_guard<std::mutex> guard(l_SettingsCacheMutex);
+    l_SettingsCacheGeneration++;
+}
+
+// attempts to retrieve the cached value of settingId,
+// when it isn't cached, generation is set to the
+// generation which has to be passed to settings_cache_store()
+template<typename T>
+static bool settings_cache_get(SettingsID settingId, T& value, uint64_t& generation)
+{
+    const std::lock_guard<std::mutex> guard(l_SettingsCacheMutex);
+
+    generation = l_SettingsCacheGeneration;
+
+    if (static_cast<size_t>(settingId) >= l_SettingsCache.size())
+    {
+        return false;
+    }
+
+    const l_CachedSetting& cachedSetting = l_SettingsCache[static_cast<size_t>(settingId)];
+    if (cachedSetting.NoCache ||
+        cachedSetting.Generation != l_SettingsCacheGeneration ||
+        !std::holds_alternative<T>(cachedSetting.Value))
+    {
+        return false;
+    }
+
+    value = std::get<T>(cachedSetting.Value);
+    return true;
+}
+
+// stores the value of settingId in the cache, when the cache
+// has been invalidated since generation was retrieved,
+// the stored value will be treated as invalid
+template<typename T>
+static void settings_cache_store(SettingsID settingId, const l_Setting& setting, const T& value, uint64_t generation)
+{
+    const std::lock_guard<std::mutex> guard(l_SettingsCacheMutex);
+
+    if (static_cast<size_t>(settingId) >= l_SettingsCache.size())
+    {
+        return;
+    }
+
+    l_CachedSetting& cachedSetting = l_SettingsCache[static_cast<size_t>(settingId)];
+
+    // the core changes values in its own section
+    // without going through us, so we can't cache those
+    if (setting.Section == SETTING_SECTION_M64P)
+    {
+        cachedSetting.NoCache = true;
+        return;
+    }
+
+    cachedSetting.Generation = generation;
+    cachedSetting.Value      = value;
+}
+
 static void config_listsections_callback(void*, const char* section)
 {
     l_sectionList.emplace_back(std::string(section));
@@ -1465,6 +1591,8 @@ static bool config_option_set(const std::string& section, const std::string& key
     }
 
     ret = m64p::Config.SetParameter(l_sectionHandle, key.c_str(), type, value);
+    settings_cache_invalidate();
+
     if (ret != M64ERR_SUCCESS)
     {
         error = "config_option_set m64p::Config.SetParameter Failed: ";
@@ -1551,6 +1679,8 @@ static bool config_option_default_set(const std::string& section, const std::str
         } break;
     }
 
+    settings_cache_invalidate();
+
     if (ret != M64ERR_SUCCESS)
     {
         CoreSetError(error);
@@ -1662,6 +1792,8 @@ CORE_EXPORT bool CoreSettingsSave(void)
     }
 
     ret = m64p::Config.SaveFile();
+    settings_cache_invalidate();
+
     if (ret != M64ERR_SUCCESS)
     {
         error = "CoreSettingsSave m64p::Config.SaveFile Failed: ";
@@ -1806,6 +1938,8 @@ CORE_EXPORT bool CoreSettingsRevertSection(std::string section)
     }
 
     ret = m64p::Config.RevertChanges(section.c_str());
+    settings_cache_invalidate();
+
     if (ret != M64ERR_SUCCESS)
     {
         error = "CoreSettingsRevertSection m64p::Config.RevertChanges() Failed: ";
@@ -1834,6 +1968,8 @@ CORE_EXPORT bool CoreSettingsDeleteSection(std::string section)
     }
 
     ret = m64p::Config.DeleteSection(section.c_str());
+    settings_cache_invalidate();
+
     if (ret != M64ERR_SUCCESS)
     {
         error = "CoreSettingsDeleteSection m64p::Config.DeleteSection() Failed: ";
@@ -2018,46 +2154,103 @@ CORE_EXPORT std::vector<int> CoreSettingsGetDefaultIntListValue(SettingsID setti
 
 CORE_EXPORT int CoreSettingsGetIntValue(SettingsID settingId)
 {
+    uint64_t generation;
+    int value;
+
+    if (settings_cache_get(settingId, value, generation))
+    {
+        return value;
+    }
+
     l_Setting setting = get_setting(settingId);
-    int value = setting.DefaultValue.index() == 0 ? 0 : std::get<int>(setting.DefaultValue);
-    config_option_get(setting.Section, setting.Key, M64TYPE_INT, &value, sizeof(value));
+    value = setting.DefaultValue.index() == 0 ? 0 : std::get<int>(setting.DefaultValue);
+    if (config_option_get(setting.Section, setting.Key, M64TYPE_INT, &value, sizeof(value)))
+    {
+        settings_cache_store(settingId, setting, value, generation);
+    }
     return value;
 }
 
 CORE_EXPORT bool CoreSettingsGetBoolValue(SettingsID settingId)
 {
+    uint64_t generation;
+    bool boolValue;
+
+    if (settings_cache_get(settingId, boolValue, generation))
+    {
+        return boolValue;
+    }
+
     l_Setting setting = get_setting(settingId);
     int value = setting.DefaultValue.index() == 0 ? 0 : (std::get<bool>(setting.DefaultValue) ? 1 : 0);
-    config_option_get(setting.Section, setting.Key, M64TYPE_BOOL, &value, sizeof(value));
+    if (config_option_get(setting.Section, setting.Key, M64TYPE_BOOL, &value, sizeof(value)))
+    {
+        settings_cache_store(settingId, setting, value > 0, generation);
+    }
     return value > 0;
 }
 
 CORE_EXPORT float CoreSettingsGetFloatValue(SettingsID settingId)
 {
+    uint64_t generation;
+    float value;
+
+    if (settings_cache_get(settingId, value, generation))
+    {
+        return value;
+    }
+
     l_Setting setting = get_setting(settingId);
-    float value = setting.DefaultValue.index() == 0 ? 0.0f : std::get<float>(setting.DefaultValue);
-    config_option_get(setting.Section, setting.Key, M64TYPE_FLOAT, &value, sizeof(value));
+    value = setting.DefaultValue.index() == 0 ? 0.0f : std::get<float>(setting.DefaultValue);
+    if (config_option_get(setting.Section, setting.Key, M64TYPE_FLOAT, &value, sizeof(value)))
+    {
+        settings_cache_store(settingId, setting, value, generation);
+    }
     return value;
 }
 
 CORE_EXPORT std::string CoreSettingsGetStringValue(SettingsID settingId)
 {
+    uint64_t generation;
+    std::string stringValue;
+
+    if (settings_cache_get(settingId, stringValue, generation))
+    {
+        return stringValue;
+    }
+
     l_Setting setting = get_setting(settingId);
     char value[STR_SIZE] = {0};
-    config_option_get(setting.Section, setting.Key, M64TYPE_STRING, value, sizeof(value));
+    if (config_option_get(setting.Section, setting.Key, M64TYPE_STRING, value, sizeof(value)))
+    {
+        stringValue = std::string(value);
+        settings_cache_store(settingId, setting, stringValue, generation);
+    }
     return std::string(value);
 }
 
 CORE_EXPORT std::vector<int> CoreSettingsGetIntListValue(SettingsID settingId)
 {
-    l_Setting setting = get_setting(settingId);
-    return CoreSettingsGetIntListValue(settingId, setting.Section);
+    std::vector<int> value;
+
+    if (!string_to_int_list(CoreSettingsGetStringValue(settingId), value))
+    {
+        return std::vector<int>();
+    }
+
+    return value;
 }
 
 CORE_EXPORT std::vector<std::string> CoreSettingsGetStringListValue(SettingsID settingId)
 {
-    l_Setting setting = get_setting(settingId);
-    return CoreSettingsGetStringListValue(settingId, setting.Section);
+    std::vector<std::string> value;
+
+    if (!string_to_string_list(CoreSettingsGetStringValue(settingId), value))
+    {
+        return std::vector<std::string>();
+    }
+
+    return value;
 }
 
 CORE_EXPORT int CoreSettingsGetIntValue(SettingsID settingId, std::string section)
@@ -79,6 +79,11 @@ enum class SettingsID
     Core_Gameboy_P4_Rom,
     Core_Gameboy_P4_Save,
 
+    // Core Rewind Settings
+    Core_Rewind_Enabled,
+    Core_Rewind_BufferSize,
+    Core_Rewind_Interval,
+
     // (mupen64plus) Core Settings
     Core_OverrideGameSpecificSettings,
     Core_RandomizeInterrupt,
@@ -89,6 +94,9 @@ enum class SettingsID
     Core_CountPerOpDenomPot,
     Core_SiDmaDuration,
     Core_SaveFileNameFormat,
+    Core_FramePacingDisplayLock,
+    Core_NetplayRollbackFrames,
+    Core_NetplaySyncHashInterval,
 
     // (mupen64plus) Overlay Core Settings
     CoreOverlay_RandomizeInterrupt,
@@ -112,6 +120,7 @@ enum class SettingsID
     Game_SaveType,
     Game_CountPerOp,
     Game_SiDmaDuration,
+    Game_RunAheadFrames,
 
     // Game Core Override Settings
     Game_OverrideCoreSettings,
@@ -155,6 +164,7 @@ enum class SettingsID
     KeyBinding_Load,
     KeyBinding_Cheats,
     KeyBinding_GSButton,
+    KeyBinding_Rewind,
     KeyBinding_SaveStateSlot0,
     KeyBinding_SaveStateSlot1,
     KeyBinding_SaveStateSlot2,
@@ -182,6 +192,7 @@ enum class SettingsID
     RomBrowser_Geometry,
     RomBrowser_Maximized,
     RomBrowser_Recursive,
+    RomBrowser_WatchDirectory,
     RomBrowser_MaxItems,
     RomBrowser_ColumnVisibility,
     RomBrowser_ColumnOrder,
@@ -206,6 +217,8 @@ enum class SettingsID
     Audio_Volume,
     Audio_Muted,
     Audio_Synchronize,
+    Audio_DynamicRateControl,
+    Audio_LowLatencyOutput,
     Audio_SimpleBackend,
 
     // HLE RSP Plugin Settings
@@ -457,6 +470,10 @@ enum class SettingsID
     Input_Hotkey_Fullscreen_Name,
     Input_Hotkey_Fullscreen_Data,
     Input_Hotkey_Fullscreen_ExtraData,
+    Input_Hotkey_Rewind_InputType,
+    Input_Hotkey_Rewind_Name,
+    Input_Hotkey_Rewind_Data,
+    Input_Hotkey_Rewind_ExtraData,
 
     Invalid
 };
@@ -63,3 +63,56 @@ CORE_EXPORT bool CoreSetSpeedLimiterState(bool enabled)
 
     return ret == M64ERR_SUCCESS;
 }
+
+CORE_EXPORT bool CoreSetDisplayRefreshRate(double refreshRate)
+{
+    std::string error;
+    m64p_error ret;
+    int value = static_cast<int>(refreshRate * 1000);
+
+    if (!m64p::Core.IsHooked())
+    {
+        return false;
+    }
+
+    ret = m64p::Core.DoCommand(M64CMD_CORE_STATE_SET, M64CORE_DISPLAY_REFRESH_RATE, &value);
+    if (ret != M64ERR_SUCCESS)
+    {
+        error = "CoreSetDisplayRefreshRate: m64p::Core.DoCommand(M64CMD_CORE_STATE_SET) Failed: ";
+        error += m64p::Core.ErrorMessage(ret);
+        CoreSetError(error);
+    }
+
+    return ret == M64ERR_SUCCESS;
+}
+
+CORE_EXPORT bool CoreGetFrameTimingStats(CoreFrameTimingStats& stats)
+{
+    std::string error;
+    m64p_error ret;
+    m64p_frame_timing timing;
+
+    if (!m64p::Core.IsHooked())
+    {
+        return false;
+    }
+
+    ret = m64p::Core.DoCommand(M64CMD_FRAME_TIMING_QUERY, sizeof(m64p_frame_timing), &timing);
+    if (ret != M64ERR_SUCCESS)
+    {
+        error = "CoreGetFrameTimingStats: m64p::Core.DoCommand(M64CMD_FRAME_TIMING_QUERY) Failed: ";
+        error += m64p::Core.ErrorMessage(ret);
+        CoreSetError(error);
+        return false;
+    }
+
+    stats.FrameCount = timing.frame_count;
+    stats.LateFrames = timing.late_frames;
+    stats.Resyncs    = timing.resyncs;
+    stats.TargetNs   = timing.target_ns;
+    stats.LastNs     = timing.last_ns;
+    stats.AverageNs  = timing.average_ns;
+    stats.JitterNs   = timing.jitter_ns;
+    stats.ErrorNs    = timing.error_ns;
+    return true;
+}
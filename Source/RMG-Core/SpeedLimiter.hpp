@@ -10,10 +10,40 @@
 #ifndef CORE_SPEEDLIMITER_HPP
 #define CORE_SPEEDLIMITER_HPP
 
+#include <cstdint>
+
+struct CoreFrameTimingStats
+{
+    // amount of frames paced since emulation started
+    uint32_t FrameCount;
+    // amount of frames which were already past their deadline
+    uint32_t LateFrames;
+    // amount of times emulation fell too far behind
+    uint32_t Resyncs;
+    // target duration of a frame in nanoseconds
+    uint64_t TargetNs;
+    // duration of the last frame in nanoseconds
+    uint64_t LastNs;
+    // moving average of the frame duration in nanoseconds
+    uint64_t AverageNs;
+    // moving average of the deviation from the target duration in nanoseconds
+    uint64_t JitterNs;
+    // difference between the end of the last frame and its deadline in nanoseconds
+    int64_t ErrorNs;
+};
+
 // returns whether the speed limiter is enabled
 bool CoreIsSpeedLimiterEnabled(void);
 
 // sets the speed limiter state
 bool CoreSetSpeedLimiterState(bool enabled);
 
+// sets the refresh rate of the display in hertz,
+// which the speed limiter locks to when enabled
+bool CoreSetDisplayRefreshRate(double refreshRate);
+
+// attempts to retrieve the frame timing statistics
+// of the speed limiter while emulation is running
+bool CoreGetFrameTimingStats(CoreFrameTimingStats& stats);
+
 #endif // CORE_SPEEDLIMITER_HPP
@@ -0,0 +1,88 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "InputPollThread.hpp"
+
+#include <SDL.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace Thread;
+
+//
+// Local Defines
+//
+
+// polling interval in microseconds (1 kHz)
+#define INPUT_POLL_INTERVAL 1000
+
+//
+// Exported Functions
+//
+
+InputPollThread::InputPollThread(std::function<void(void)> pollFunc, QObject *parent) : QThread(parent)
+{
+    this->pollFunc = pollFunc;
+}
+
+InputPollThread::~InputPollThread()
+{
+    if (this->isRunning())
+    {
+        this->StopLoop();
+    }
+}
+
+void InputPollThread::SetState(InputPollThreadState state)
+{
+    this->state = state;
+}
+
+void InputPollThread::StopLoop(void)
+{
+    this->keepLoopRunning = false;
+    while (this->isRunning())
+    {
+        // wait until we're not running anymore
+    }
+}
+
+void InputPollThread::run(void)
+{
+    auto nextPollTime = std::chrono::steady_clock::now();
+
+    while (this->keepLoopRunning)
+    {
+        // sleep for 300ms when no ROM is opened
+        if (this->state == InputPollThreadState::RomClosed)
+        {
+            QThread::msleep(300);
+            nextPollTime = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        // update the state of all opened devices
+        SDL_JoystickUpdate();
+
+        this->pollFunc();
+
+        // schedule the next poll relative to the previous
+        // one so the polling rate doesn't drift, when we've
+        // fallen behind, don't try to catch up
+        nextPollTime += std::chrono::microseconds(INPUT_POLL_INTERVAL);
+        const auto currentTime = std::chrono::steady_clock::now();
+        if (nextPollTime < currentTime)
+        {
+            nextPollTime = currentTime;
+        }
+
+        std::this_thread::sleep_until(nextPollTime);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INPUTPOLLTHREAD_HPP
+#define INPUTPOLLTHREAD_HPP
+
+#include <QThread>
+
+#include <functional>
+#include <atomic>
+
+enum class InputPollThreadState
+{
+    RomOpened,
+    RomClosed,
+};
+
+namespace Thread
+{
+class InputPollThread : public QThread
+{
+    Q_OBJECT
+public:
+    InputPollThread(std::function<void(void)> pollFunc, QObject *parent);
+    ~InputPollThread(void);
+
+    void run(void) override;
+
+    void SetState(InputPollThreadState state);
+
+    void StopLoop(void);
+
+private:
+    std::atomic<bool> keepLoopRunning = true;
+    std::function<void(void)> pollFunc;
+    std::atomic<InputPollThreadState> state = InputPollThreadState::RomClosed;
+};
+} // namespace Thread
+
+#endif // INPUTPOLLTHREAD_HPP
@@ -9,8 +9,37 @@
  */
 #include "InputDevice.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 using namespace Utilities;
 
+//
+// Local Functions
+//
+
+static uint64_t get_current_time(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void set_digital_bit(InputDeviceState& state, const int bit, const bool value)
+{
+    state.Digital[bit / 64] |= (uint64_t)value << (bit % 64);
+}
+
+static void set_axis(InputDeviceState& state, const int bit, const int axis, const int16_t value)
+{
+    state.Axes[axis] = value;
+    set_digital_bit(state, bit,     value <= -(SDL_AXIS_PEAK / 2));
+    set_digital_bit(state, bit + 1, value >= (SDL_AXIS_PEAK / 2));
+}
+
+//
+// Exported Functions
+//
+
 InputDevice::InputDevice()
 {
 
@@ -101,6 +130,8 @@ bool InputDevice::IsOpeningDevice(void)
 
 bool InputDevice::CloseDevice()
 {
+    std::lock_guard<std::mutex> guard(this->deviceMutex);
+
     if (this->joystick != nullptr)
     {
         SDL_JoystickClose(this->joystick);
@@ -182,6 +213,8 @@ void InputDevice::on_SDLThread_DeviceSearchFinished(void)
         }
     }
 
+    std::lock_guard<std::mutex> guard(this->deviceMutex);
+
     this->joystick = SDL_JoystickOpen(device.number);
     if (SDL_IsGameController(device.number))
     {
@@ -191,3 +224,101 @@ void InputDevice::on_SDLThread_DeviceSearchFinished(void)
     this->isOpeningDevice = false;
     this->hasOpenDevice = this->joystick != nullptr || this->gameController != nullptr;
 }
+
+void InputDevice::SampleState(void)
+{
+    // write to the state which isn't published,
+    // readers which are still copying it will
+    // notice the sequence change and retry
+    const int index = 1 - this->stateIndex.load(std::memory_order_relaxed);
+
+    this->stateSequence[index].fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    this->readState(this->states[index]);
+
+    this->stateSequence[index].fetch_add(1, std::memory_order_release);
+    this->stateIndex.store(index, std::memory_order_release);
+}
+
+void InputDevice::GetState(InputDeviceState& state, uint64_t maxAge)
+{
+    int index;
+    uint32_t sequence;
+
+    while (true)
+    {
+        index    = this->stateIndex.load(std::memory_order_acquire);
+        sequence = this->stateSequence[index].load(std::memory_order_acquire);
+        if (sequence & 1)
+        {
+            continue;
+        }
+
+        state = this->states[index];
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (this->stateSequence[index].load(std::memory_order_relaxed) == sequence)
+        {
+            break;
+        }
+    }
+
+    // fallback to sampling the device ourselves
+    // when the state hasn't been updated recently
+    if ((get_current_time() - state.Timestamp) > maxAge)
+    {
+        this->readState(state);
+    }
+}
+
+void InputDevice::readState(InputDeviceState& state)
+{
+    std::lock_guard<std::mutex> guard(this->deviceMutex);
+
+    state = InputDeviceState();
+    state.Timestamp = get_current_time();
+
+    if (this->gameController != nullptr)
+    {
+        for (int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; i++)
+        {
+            set_digital_bit(state, INPUTDEVICE_BIT_GAMEPAD_BUTTON + i,
+                            SDL_GameControllerGetButton(this->gameController, (SDL_GameControllerButton)i));
+        }
+
+        for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++)
+        {
+            set_axis(state, INPUTDEVICE_BIT_GAMEPAD_AXIS + (i * 2), INPUTDEVICE_AXIS_GAMEPAD + i,
+                     SDL_GameControllerGetAxis(this->gameController, (SDL_GameControllerAxis)i));
+        }
+    }
+
+    if (this->joystick != nullptr)
+    {
+        const int buttons = std::min(SDL_JoystickNumButtons(this->joystick), INPUTDEVICE_MAX_BUTTONS);
+        const int hats    = std::min(SDL_JoystickNumHats(this->joystick), INPUTDEVICE_MAX_HATS);
+        const int axes    = std::min(SDL_JoystickNumAxes(this->joystick), INPUTDEVICE_MAX_AXES);
+
+        for (int i = 0; i < buttons; i++)
+        {
+            set_digital_bit(state, INPUTDEVICE_BIT_JOYSTICK_BUTTON + i,
+                            SDL_JoystickGetButton(this->joystick, i));
+        }
+
+        for (int i = 0; i < hats; i++)
+        {
+            const Uint8 hat = SDL_JoystickGetHat(this->joystick, i);
+            for (int j = 0; j < 4; j++)
+            {
+                set_digital_bit(state, INPUTDEVICE_BIT_JOYSTICK_HAT + (i * 4) + j, hat & (1 << j));
+            }
+        }
+
+        for (int i = 0; i < axes; i++)
+        {
+            set_axis(state, INPUTDEVICE_BIT_JOYSTICK_AXIS + (i * 2), INPUTDEVICE_AXIS_JOYSTICK + i,
+                     SDL_JoystickGetAxis(this->joystick, i));
+        }
+    }
+}
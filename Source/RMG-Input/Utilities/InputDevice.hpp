@@ -13,13 +13,52 @@
 #include "common.hpp"
 
 #include <QObject>
+#include <cstdint>
 #include <string>
+#include <atomic>
+#include <mutex>
 #include <SDL.h>
 
 #include "Thread/SDLThread.hpp"
 
+// maximum amount of joystick buttons,
+// hats and axes stored in a state
+#define INPUTDEVICE_MAX_BUTTONS 128
+#define INPUTDEVICE_MAX_HATS    16
+#define INPUTDEVICE_MAX_AXES    32
+
+// layout of the digital inputs in a state, axes
+// have a bit for each direction, which is set when
+// the axis is pushed at least halfway, hats have
+// a bit for each direction
+#define INPUTDEVICE_BIT_GAMEPAD_BUTTON  0
+#define INPUTDEVICE_BIT_GAMEPAD_AXIS    (INPUTDEVICE_BIT_GAMEPAD_BUTTON + SDL_CONTROLLER_BUTTON_MAX)
+#define INPUTDEVICE_BIT_JOYSTICK_BUTTON (INPUTDEVICE_BIT_GAMEPAD_AXIS + (SDL_CONTROLLER_AXIS_MAX * 2))
+#define INPUTDEVICE_BIT_JOYSTICK_HAT    (INPUTDEVICE_BIT_JOYSTICK_BUTTON + INPUTDEVICE_MAX_BUTTONS)
+#define INPUTDEVICE_BIT_JOYSTICK_AXIS   (INPUTDEVICE_BIT_JOYSTICK_HAT + (INPUTDEVICE_MAX_HATS * 4))
+#define INPUTDEVICE_BIT_COUNT           (INPUTDEVICE_BIT_JOYSTICK_AXIS + (INPUTDEVICE_MAX_AXES * 2))
+#define INPUTDEVICE_DIGITAL_WORDS       ((INPUTDEVICE_BIT_COUNT + 63) / 64)
+
+// layout of the analog inputs in a state
+#define INPUTDEVICE_AXIS_GAMEPAD  0
+#define INPUTDEVICE_AXIS_JOYSTICK (INPUTDEVICE_AXIS_GAMEPAD + SDL_CONTROLLER_AXIS_MAX)
+#define INPUTDEVICE_AXIS_COUNT    (INPUTDEVICE_AXIS_JOYSTICK + INPUTDEVICE_MAX_AXES)
+
 namespace Utilities
 {
+struct InputDeviceState
+{
+    // time at which the state was
+    // sampled, in nanoseconds
+    uint64_t Timestamp = 0;
+
+    // bitset of the digital inputs
+    uint64_t Digital[INPUTDEVICE_DIGITAL_WORDS] = {};
+
+    // values of the axes
+    int16_t Axes[INPUTDEVICE_AXIS_COUNT] = {};
+};
+
 class InputDevice : public QObject
 {
 Q_OBJECT
@@ -50,10 +89,32 @@ public:
     // tries to close opened device
     bool CloseDevice(void);
 
+    // samples the state of the opened device
+    // and publishes it as the latest state,
+    // this should only be called by one thread
+    void SampleState(void);
+
+    // retrieves the latest published state, when
+    // it's older than maxAge nanoseconds, the
+    // device is sampled on the calling thread
+    void GetState(InputDeviceState& state, uint64_t maxAge);
+
 private:
     SDL_Joystick*       joystick = nullptr;
     SDL_GameController* gameController = nullptr;
 
+    // protects the device handles against
+    // being closed while they're sampled
+    std::mutex deviceMutex;
+
+    // double buffered states, each state has a sequence
+    // number which is odd while the state is being written
+    InputDeviceState states[2];
+    std::atomic<uint32_t> stateSequence[2] = {0, 0};
+    std::atomic<int> stateIndex = 0;
+
+    void readState(InputDeviceState& state);
+
     bool hasOpenDevice = false;
     bool isOpeningDevice = false;
 
@@ -13,6 +13,7 @@
 
 #include "UserInterface/MainDialog.hpp"
 #include "Utilities/InputDevice.hpp"
+#include "Thread/InputPollThread.hpp"
 #include "Thread/HotkeysThread.hpp"
 #include "Thread/SDLThread.hpp"
 #include "common.hpp"
@@ -35,6 +36,7 @@
 #include <RMG-Core/SaveState.hpp>
 #include <RMG-Core/Settings.hpp>
 #include <RMG-Core/Netplay.hpp>
+#include <RMG-Core/Rewind.hpp>
 #include <RMG-Core/Cheats.hpp>
 #include <RMG-Core/Video.hpp>
 
@@ -44,6 +46,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <atomic>
 #include <cmath>
 
 //
@@ -64,10 +67,38 @@
 
 #define PAK_IO_RUMBLE       0xC000 // the address where rumble-commands are sent to
 
+// maximum age of an input device state (in ns), when the
+// polling thread hasn't published a newer state, the
+// input device is sampled on the calling thread
+#define INPUT_STATE_MAX_AGE 50000000
+
+// the digital inputs are stored as a bitset, the
+// keyboard scancodes come first, followed by the
+// digital inputs of the input device state
+#define KEYBOARD_WORDS      (SDL_NUM_SCANCODES / 64)
+#define INPUT_BITS_WORDS    (KEYBOARD_WORDS + INPUTDEVICE_DIGITAL_WORDS)
+
 //
 // Local Structures
 //
 
+struct InputMask
+{
+    int      Word = 0;
+    uint64_t Bits = 0;
+};
+
+struct InputAxis
+{
+    int  Index    = 0;
+    bool Positive = false;
+};
+
+struct InputBits
+{
+    uint64_t Words[INPUT_BITS_WORDS];
+};
+
 struct InputMapping
 {
     std::vector<std::string> Name;
@@ -75,6 +106,12 @@ struct InputMapping
     std::vector<int>         Data;
     std::vector<int>         ExtraData;
     int                      Count = 0;
+
+    // compiled mapping, the masks of the
+    // digital inputs in the input bitset and
+    // the axes when the mapping is an axis
+    std::vector<InputMask> Masks;
+    std::vector<InputAxis> Axes;
 };
 
 struct InputProfile
@@ -83,6 +120,12 @@ struct InputProfile
     int DeadzoneValue = 0;
     int SensitivityValue = 100;
 
+    // axis input with the deadzone and sensitivity
+    // applied, indexed by the absolute axis value
+    std::vector<double> AxisTable;
+    // maximum input radius of the octagon
+    double OctagonInputRadius = 0;
+
     N64ControllerPak ControllerPak = N64ControllerPak::None;
 
     // input device information
@@ -155,6 +198,8 @@ struct InputProfile
     InputMapping Hotkey_LoadState;
     bool Hotkey_GSButton_Pressed = false;
     InputMapping Hotkey_GSButton;
+    bool Hotkey_Rewind_Pressed = false;
+    InputMapping Hotkey_Rewind;
     bool Hotkey_SaveStateSlot_Pressed = false;
     InputMapping Hotkey_SaveStateSlot0;
     InputMapping Hotkey_SaveStateSlot1;
@@ -190,6 +235,9 @@ static Thread::SDLThread *l_SDLThread = nullptr;
 // Hotkeys thread (for when paused)
 static Thread::HotkeysThread *l_HotkeysThread = nullptr;
 
+// Input polling thread
+static Thread::InputPollThread *l_InputPollThread = nullptr;
+
 // input profiles
 static InputProfile l_InputProfiles[NUM_CONTROLLERS];
 
@@ -203,8 +251,8 @@ static CONTROL_INFO l_ControlInfo;
 static void (*l_DebugCallback)(void *, int, const char *) = nullptr;
 static void *l_DebugCallContext                           = nullptr;
 
-// keyboard state
-static bool l_KeyboardState[SDL_NUM_SCANCODES];
+// keyboard state, as a bitset of scancodes
+static std::atomic<uint64_t> l_KeyboardState[KEYBOARD_WORDS];
 
 // config GUI state
 static bool l_IsConfigGuiOpen = false;
@@ -213,9 +261,214 @@ static bool l_IsConfigGuiOpen = false;
 // Local Functions
 //
 
+// maps a value in one range to a value in another
+static double map_range_to_range(const double value, const double fromLower, const double fromUpper, const double toLower, const double toUpper)
+{
+    const double fromDelta = fromUpper - fromLower;
+    const double toDelta = toUpper - toLower;
+    const double toUnitsPerFromUnit = toDelta / fromDelta;
+    const double fromUnits = value - fromLower;
+
+    return toLower + fromUnits * toUnitsPerFromUnit;
+}
+
+// applies square deadzone, then scales result such that the edge of the deadzone is 0
+static double apply_deadzone(const double input, const double deadzone)
+{
+    const double inputAbsolute = std::abs(input);
+
+    if (inputAbsolute <= deadzone)
+    {
+        return 0;
+    }
+
+    return std::copysign(map_range_to_range(inputAbsolute, deadzone, 1.0, 0.0, 1.0), input);
+}
+
+// returns the maximum input radius of the octagon for the given deadzone
+static double get_octagon_input_radius(const double deadzone)
+{
+    const double maxAxis     = N64_AXIS_PEAK;
+    const double maxDiagonal = MAX_DIAGONAL_VALUE;
+
+    return sqrt(2) * (maxDiagonal + deadzone * (maxAxis - maxDiagonal));
+}
+
+// Credit: MerryMage, fzurita & kev4cards
+static void simulate_octagon(const double maxInputRadius, const double inputX, const double inputY, int& outputX, int& outputY)
+{
+    const double maxAxis     = N64_AXIS_PEAK;
+    const double maxDiagonal = MAX_DIAGONAL_VALUE;
+    // scale to [-maxInputRadius, maxInputRadius]
+    double ax = inputX * maxInputRadius;
+    double ay = inputY * maxInputRadius;
+
+    // check whether (ax, ay) is within the circle of radius maxInputRadius
+    double distance = std::hypot(ax, ay);
+    if (distance > maxInputRadius)
+    {
+        // scale ax and ay to stay on the same line, but at the edge of the circle
+        const double scale = maxInputRadius / distance;
+        ax *= scale;
+        ay *= scale;
+    }
+
+    // bound diagonals to an octagonal range [-maxDiagonal, maxDiagonal]
+    if (ax != 0.0 && ay != 0.0)
+    {
+        const double slope = ay / ax;
+        double edgex = std::copysign(maxAxis / (std::abs(slope) + (maxAxis - maxDiagonal) / maxDiagonal), ax);
+        const double edgey = std::copysign(std::min(std::abs(edgex * slope), maxAxis / (1.0 / std::abs(slope) + (maxAxis - maxDiagonal) / maxDiagonal)), ay);
+        edgex = edgey / slope;
+
+        distance = std::hypot(ax, ay);
+        const double distanceToOctagonalEdge = std::hypot(edgex, edgey);
+        if (distance > distanceToOctagonalEdge)
+        {
+            ax = edgex;
+            ay = edgey;
+        }
+    }
+
+    // keep cardinal input within positive and negative bounds of maxAxis
+    if (std::abs(ax) > maxAxis) ax = std::copysign(maxAxis, ax);
+    if (std::abs(ay) > maxAxis) ay = std::copysign(maxAxis, ay);
+
+    outputX = static_cast<int>(ax);
+    outputY = static_cast<int>(ay);
+}
+
+// precomputes the deadzone and sensitivity for
+// every axis value and the octagon input radius
+static void build_axis_table(InputProfile* profile)
+{
+    const double deadzone = profile->DeadzoneValue / 100.0;
+    const double sensitivityRatio = profile->SensitivityValue / 100.0;
+    const double upperInputLimit = std::min(1.0, sensitivityRatio);
+
+    profile->OctagonInputRadius = get_octagon_input_radius(deadzone);
+
+    if (!profile->PluggedIn)
+    {
+        std::vector<double>().swap(profile->AxisTable);
+        return;
+    }
+
+    profile->AxisTable.resize(SDL_AXIS_PEAK + 1);
+    for (int i = 0; i <= SDL_AXIS_PEAK; i++)
+    {
+        // both the deadzone and the sensitivity are
+        // symmetric, so only the positive half is stored
+        const double input = apply_deadzone(static_cast<double>(i) / SDL_AXIS_PEAK, deadzone);
+        profile->AxisTable[i] = std::min(input * sensitivityRatio, upperInputLimit);
+    }
+}
+
+static void add_inputmapping_bit(InputMapping* mapping, const int bit)
+{
+    const int word = bit / 64;
+    const uint64_t mask = (uint64_t)1 << (bit % 64);
+
+    for (InputMask& inputMask : mapping->Masks)
+    {
+        if (inputMask.Word == word)
+        {
+            inputMask.Bits |= mask;
+            return;
+        }
+    }
+
+    mapping->Masks.push_back({word, mask});
+}
+
+// compiles the mapping into masks of the input bitset,
+// when the mapping is an axis, the axes in the mapping are
+// stored separately, else they're treated as buttons
+static void compile_inputmapping(InputMapping* mapping, const bool isAxis)
+{
+    const int deviceBit = KEYBOARD_WORDS * 64;
+
+    mapping->Masks.clear();
+    mapping->Axes.clear();
+
+    for (int i = 0; i < mapping->Count; i++)
+    {
+        const int data = mapping->Data.at(i);
+        const int extraData = mapping->ExtraData.at(i);
+
+        switch ((InputType)mapping->Type.at(i))
+        {
+            case InputType::Keyboard:
+            {
+                if (data >= 0 && data < SDL_NUM_SCANCODES)
+                {
+                    add_inputmapping_bit(mapping, data);
+                }
+            } break;
+            case InputType::GamepadButton:
+            {
+                if (data >= 0 && data < SDL_CONTROLLER_BUTTON_MAX)
+                {
+                    add_inputmapping_bit(mapping, deviceBit + INPUTDEVICE_BIT_GAMEPAD_BUTTON + data);
+                }
+            } break;
+            case InputType::GamepadAxis:
+            {
+                if (data >= 0 && data < SDL_CONTROLLER_AXIS_MAX)
+                {
+                    if (isAxis)
+                    {
+                        mapping->Axes.push_back({INPUTDEVICE_AXIS_GAMEPAD + data, extraData != 0});
+                    }
+                    else
+                    {
+                        add_inputmapping_bit(mapping, deviceBit + INPUTDEVICE_BIT_GAMEPAD_AXIS + (data * 2) + (extraData ? 1 : 0));
+                    }
+                }
+            } break;
+            case InputType::JoystickButton:
+            {
+                if (data >= 0 && data < INPUTDEVICE_MAX_BUTTONS)
+                {
+                    add_inputmapping_bit(mapping, deviceBit + INPUTDEVICE_BIT_JOYSTICK_BUTTON + data);
+                }
+            } break;
+            case InputType::JoystickHat:
+            {
+                if (data >= 0 && data < INPUTDEVICE_MAX_HATS)
+                {
+                    for (int j = 0; j < 4; j++)
+                    {
+                        if (extraData & (1 << j))
+                        {
+                            add_inputmapping_bit(mapping, deviceBit + INPUTDEVICE_BIT_JOYSTICK_HAT + (data * 4) + j);
+                        }
+                    }
+                }
+            } break;
+            case InputType::JoystickAxis:
+            {
+                if (data >= 0 && data < INPUTDEVICE_MAX_AXES)
+                {
+                    if (isAxis)
+                    {
+                        mapping->Axes.push_back({INPUTDEVICE_AXIS_JOYSTICK + data, extraData != 0});
+                    }
+                    else
+                    {
+                        add_inputmapping_bit(mapping, deviceBit + INPUTDEVICE_BIT_JOYSTICK_AXIS + (data * 2) + (extraData ? 1 : 0));
+                    }
+                }
+            } break;
+            default:
+                break;
+        }
+    }
+}
+
 static void load_inputmapping_settings(InputMapping* mapping, std::string section,
     SettingsID inputNameSettingsId, SettingsID inputTypeSettingsId, 
-    SettingsID dataSettingsId, SettingsID extraDataSettingsId)
+    SettingsID dataSettingsId, SettingsID extraDataSettingsId, const bool isAxis = false)
 {
     mapping->Name = CoreSettingsGetStringListValue(inputNameSettingsId, section);
     mapping->Type = CoreSettingsGetIntListValue(inputTypeSettingsId, section);
@@ -235,6 +488,8 @@ static void load_inputmapping_settings(InputMapping* mapping, std::string sectio
         mapping->ExtraData.push_back(CoreSettingsGetIntValue(extraDataSettingsId, section));
         mapping->Count = 1;
     }
+
+    compile_inputmapping(mapping, isAxis);
 }
 
 static void load_settings(void)
@@ -329,6 +584,8 @@ static void load_settings(void)
 
 #define LOAD_INPUT_MAPPING(mapping, setting) \
         load_inputmapping_settings(&profile->mapping, section, SettingsID::setting##_Name, SettingsID::setting##_InputType, SettingsID::setting##_Data, SettingsID::setting##_ExtraData)
+#define LOAD_AXIS_INPUT_MAPPING(mapping, setting) \
+        load_inputmapping_settings(&profile->mapping, section, SettingsID::setting##_Name, SettingsID::setting##_InputType, SettingsID::setting##_Data, SettingsID::setting##_ExtraData, true)
 
         // load inputmapping settings
         LOAD_INPUT_MAPPING(Button_A,            Input_A);
@@ -345,10 +602,10 @@ static void load_settings(void)
         LOAD_INPUT_MAPPING(Button_LeftShoulder,  Input_LeftShoulder);
         LOAD_INPUT_MAPPING(Button_RightShoulder, Input_RightShoulder);
         LOAD_INPUT_MAPPING(Button_ZTrigger,     Input_ZTrigger);
-        LOAD_INPUT_MAPPING(AnalogStick_Up,      Input_AnalogStickUp);
-        LOAD_INPUT_MAPPING(AnalogStick_Down,    Input_AnalogStickDown);
-        LOAD_INPUT_MAPPING(AnalogStick_Left,    Input_AnalogStickLeft);
-        LOAD_INPUT_MAPPING(AnalogStick_Right,   Input_AnalogStickRight);
+        LOAD_AXIS_INPUT_MAPPING(AnalogStick_Up,    Input_AnalogStickUp);
+        LOAD_AXIS_INPUT_MAPPING(AnalogStick_Down,  Input_AnalogStickDown);
+        LOAD_AXIS_INPUT_MAPPING(AnalogStick_Left,  Input_AnalogStickLeft);
+        LOAD_AXIS_INPUT_MAPPING(AnalogStick_Right, Input_AnalogStickRight);
 
         // load hotkeys settings
         LOAD_INPUT_MAPPING(Hotkey_Shutdown,       Input_Hotkey_Shutdown);
@@ -373,6 +630,7 @@ static void load_settings(void)
         LOAD_INPUT_MAPPING(Hotkey_SaveState,      Input_Hotkey_SaveState);
         LOAD_INPUT_MAPPING(Hotkey_LoadState,      Input_Hotkey_LoadState);
         LOAD_INPUT_MAPPING(Hotkey_GSButton,       Input_Hotkey_GSButton);
+        LOAD_INPUT_MAPPING(Hotkey_Rewind,         Input_Hotkey_Rewind);
         LOAD_INPUT_MAPPING(Hotkey_SaveStateSlot0, Input_Hotkey_SaveStateSlot0);
         LOAD_INPUT_MAPPING(Hotkey_SaveStateSlot1, Input_Hotkey_SaveStateSlot1);
         LOAD_INPUT_MAPPING(Hotkey_SaveStateSlot2, Input_Hotkey_SaveStateSlot2);
@@ -391,6 +649,9 @@ static void load_settings(void)
         LOAD_INPUT_MAPPING(Hotkey_Fullscreen, Input_Hotkey_Fullscreen);
 
 #undef LOAD_INPUT_MAPPING
+#undef LOAD_AXIS_INPUT_MAPPING
+
+        build_axis_table(profile);
     }
 }
 
@@ -598,162 +859,78 @@ static void close_controllers(void)
     }
 }
 
-static int get_button_state(InputProfile* profile, const InputMapping* inputMapping, const bool allPressed = false)
+static void sample_input_devices(void)
 {
-    int state = 0;
+    for (int i = 0; i < NUM_CONTROLLERS; i++)
+    {
+        l_InputProfiles[i].InputDevice.SampleState();
+    }
+}
+
+static void get_input_bits(const Utilities::InputDeviceState& deviceState, InputBits& bits)
+{
+    for (int i = 0; i < KEYBOARD_WORDS; i++)
+    {
+        bits.Words[i] = l_KeyboardState[i].load(std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < INPUTDEVICE_DIGITAL_WORDS; i++)
+    {
+        bits.Words[KEYBOARD_WORDS + i] = deviceState.Digital[i];
+    }
+}
 
-    for (int i = 0; i < inputMapping->Count; i++)
+static int get_button_state(const InputBits& bits, const InputMapping* inputMapping, const bool allPressed = false)
+{
+    if (inputMapping->Masks.empty())
     {
-        const int data = inputMapping->Data.at(i);
-        const int extraData = inputMapping->ExtraData.at(i);
+        return 0;
+    }
 
-        switch ((InputType)inputMapping->Type[i])
+    if (allPressed)
+    {
+        for (const InputMask& mask : inputMapping->Masks)
         {
-            case InputType::GamepadButton:
-            {
-                if (allPressed && i > 0)
-                {
-                    state &= SDL_GameControllerGetButton(profile->InputDevice.GetGameControllerHandle(), (SDL_GameControllerButton)data);
-                }
-                else
-                {
-                    state |= SDL_GameControllerGetButton(profile->InputDevice.GetGameControllerHandle(), (SDL_GameControllerButton)data);
-                }
-            } break;
-            case InputType::GamepadAxis:
-            {
-                int axis_value = SDL_GameControllerGetAxis(profile->InputDevice.GetGameControllerHandle(), (SDL_GameControllerAxis)data);
-                if (allPressed && i > 0)
-                {
-                    state &= (abs(axis_value) >= (SDL_AXIS_PEAK / 2) && (extraData ? axis_value > 0 : axis_value < 0)) ? 1 : 0;
-                }
-                else
-                {
-                    state |= (abs(axis_value) >= (SDL_AXIS_PEAK / 2) && (extraData ? axis_value > 0 : axis_value < 0)) ? 1 : 0;
-                }
-            } break;
-            case InputType::JoystickButton:
-            {
-                if (allPressed && i > 0)
-                {
-                    state &= SDL_JoystickGetButton(profile->InputDevice.GetJoystickHandle(), data);
-                }
-                else
-                {
-                    state |= SDL_JoystickGetButton(profile->InputDevice.GetJoystickHandle(), data);
-                }
-            } break;
-            case InputType::JoystickHat:
-            {
-                if (allPressed && i > 0)
-                {
-                    state &= (SDL_JoystickGetHat(profile->InputDevice.GetJoystickHandle(), data) & extraData) ? 1 : 0;
-                }
-                else
-                {
-                    state |= (SDL_JoystickGetHat(profile->InputDevice.GetJoystickHandle(), data) & extraData) ? 1 : 0;
-                }
-            } break;
-            case InputType::JoystickAxis:
-            {
-                int axis_value = SDL_JoystickGetAxis(profile->InputDevice.GetJoystickHandle(), data);
-                if (allPressed && i > 0)
-                {
-                    state &= (abs(axis_value) >= (SDL_AXIS_PEAK / 2) && (extraData ? axis_value > 0 : axis_value < 0)) ? 1 : 0;
-                }
-                else
-                {
-                    state |= (abs(axis_value) >= (SDL_AXIS_PEAK / 2) && (extraData ? axis_value > 0 : axis_value < 0)) ? 1 : 0;
-                }
-            } break;
-            case InputType::Keyboard:
+            if ((bits.Words[mask.Word] & mask.Bits) != mask.Bits)
             {
-                if (allPressed && i > 0)
-                {
-                    state &= l_KeyboardState[data] ? 1 : 0;
-                }
-                else
-                {
-                    state |= l_KeyboardState[data] ? 1 : 0;
-                }
-            } break;
-            default:
-                break;
+                return 0;
+            }
         }
 
-        // early return when needed
-        if (allPressed && !state)
-        {
-            return state;
-        }
+        return 1;
     }
 
-    return state;
+    uint64_t state = 0;
+    for (const InputMask& mask : inputMapping->Masks)
+    {
+        state |= bits.Words[mask.Word] & mask.Bits;
+    }
+
+    return state != 0 ? 1 : 0;
 }
 
-// returns axis input scaled to the range [-1, 1]
-static double get_axis_state(InputProfile* profile, const InputMapping* inputMapping, const int direction, const double value, bool& useButtonMapping)
+// returns axis input in the range [-SDL_AXIS_PEAK, SDL_AXIS_PEAK]
+static int get_axis_state(const InputBits& bits, const Utilities::InputDeviceState& deviceState, const InputMapping* inputMapping, const int direction, const int value, bool& useButtonMapping)
 {
-    double axis_state   = value;
-    bool   button_state = false;
+    int axis_state = value;
 
-    for (int i = 0; i < inputMapping->Count; i++)
+    for (const InputAxis& axis : inputMapping->Axes)
     {
-        const int data = inputMapping->Data.at(i);
-        const int extraData = inputMapping->ExtraData.at(i);
-
-        switch ((InputType)inputMapping->Type[i])
+        int axis_value = deviceState.Axes[axis.Index];
+        if (axis_value < -SDL_AXIS_PEAK) axis_value = -SDL_AXIS_PEAK;
+        if (axis.Positive ? axis_value > 0 : axis_value < 0)
         {
-            case InputType::GamepadButton:
-            {
-                button_state |= SDL_GameControllerGetButton(profile->InputDevice.GetGameControllerHandle(), (SDL_GameControllerButton)data);
-            } break;
-            case InputType::GamepadAxis:
-            {
-                double axis_value = SDL_GameControllerGetAxis(profile->InputDevice.GetGameControllerHandle(), (SDL_GameControllerAxis)data);
-                if (axis_value < -32767.0) axis_value = -32767.0;
-                if (extraData ? axis_value > 0 : axis_value < 0)
-                {
-                    axis_value = (axis_value / SDL_AXIS_PEAK);
-                    axis_value = abs(axis_value) * direction;
-                    axis_state = axis_value;
-                }
-            } break;
-            case InputType::JoystickButton:
-            {
-                button_state |= SDL_JoystickGetButton(profile->InputDevice.GetJoystickHandle(), data);
-            } break;
-            case InputType::JoystickHat:
-            {
-                button_state |= (SDL_JoystickGetHat(profile->InputDevice.GetJoystickHandle(), data) & extraData) ? 1 : 0;
-            } break;
-            case InputType::JoystickAxis:
-            {
-                double axis_value = SDL_JoystickGetAxis(profile->InputDevice.GetJoystickHandle(), data);
-                if (axis_value < -32767.0) axis_value = -32767.0;
-                if (extraData ? axis_value > 0 : axis_value < 0)
-                {
-                    axis_value = (axis_value / SDL_AXIS_PEAK);
-                    axis_value = abs(axis_value) * direction;
-                    axis_state = axis_value;
-                }
-            } break;
-            case InputType::Keyboard:
-            {
-                button_state |= l_KeyboardState[data];
-            } break;
-            default:
-                break;
+            axis_state = std::abs(axis_value) * direction;
         }
     }
 
     // when a button has been mapped
     // to an axis, we should prioritize 
     // the button when it's been pressed
-    if (button_state)
+    if (get_button_state(bits, inputMapping))
     {
         useButtonMapping = true;
-        return direction;
+        return SDL_AXIS_PEAK * direction;
     }
     else if (!useButtonMapping)
     {
@@ -765,75 +942,6 @@ static double get_axis_state(InputProfile* profile, const InputMapping* inputMap
     }
 }
 
-// maps a value in one range to a value in another
-static double map_range_to_range(const double value, const double fromLower, const double fromUpper, const double toLower, const double toUpper)
-{
-    const double fromDelta = fromUpper - fromLower;
-    const double toDelta = toUpper - toLower;
-    const double toUnitsPerFromUnit = toDelta / fromDelta;
-    const double fromUnits = value - fromLower;
-
-    return toLower + fromUnits * toUnitsPerFromUnit;
-}
-
-// applies square deadzone, then scales result such that the edge of the deadzone is 0
-static double apply_deadzone(const double input, const double deadzone)
-{
-    const double inputAbsolute = std::abs(input);
-
-    if (inputAbsolute <= deadzone)
-    {
-        return 0;
-    }
-
-    return std::copysign(map_range_to_range(inputAbsolute, deadzone, 1.0, 0.0, 1.0), input);
-}
-
-// Credit: MerryMage, fzurita & kev4cards
-static void simulate_octagon(const double deadzone, const double inputX, const double inputY, int& outputX, int& outputY)
-{
-    const double maxAxis     = N64_AXIS_PEAK;
-    const double maxDiagonal = MAX_DIAGONAL_VALUE;
-    const double maxInputRadius = sqrt(2) * (maxDiagonal + deadzone * (maxAxis - maxDiagonal));
-    // scale to [-maxInputRadius, maxInputRadius]
-    double ax = inputX * maxInputRadius;
-    double ay = inputY * maxInputRadius;
-
-    // check whether (ax, ay) is within the circle of radius maxInputRadius
-    double distance = std::hypot(ax, ay);
-    if (distance > maxInputRadius)
-    {
-        // scale ax and ay to stay on the same line, but at the edge of the circle
-        const double scale = maxInputRadius / distance;
-        ax *= scale;
-        ay *= scale;
-    }
-
-    // bound diagonals to an octagonal range [-maxDiagonal, maxDiagonal]
-    if (ax != 0.0 && ay != 0.0)
-    {
-        const double slope = ay / ax;
-        double edgex = std::copysign(maxAxis / (std::abs(slope) + (maxAxis - maxDiagonal) / maxDiagonal), ax);
-        const double edgey = std::copysign(std::min(std::abs(edgex * slope), maxAxis / (1.0 / std::abs(slope) + (maxAxis - maxDiagonal) / maxDiagonal)), ay);
-        edgex = edgey / slope;
-
-        distance = std::hypot(ax, ay);
-        const double distanceToOctagonalEdge = std::hypot(edgex, edgey);
-        if (distance > distanceToOctagonalEdge)
-        {
-            ax = edgex;
-            ay = edgey;
-        }
-    }
-
-    // keep cardinal input within positive and negative bounds of maxAxis
-    if (std::abs(ax) > maxAxis) ax = std::copysign(maxAxis, ax);
-    if (std::abs(ay) > maxAxis) ay = std::copysign(maxAxis, ay);
-
-    outputX = static_cast<int>(ax);
-    outputY = static_cast<int>(ay);
-}
-
 static unsigned char data_crc(unsigned char *data, int length)
 {
     unsigned char remainder = data[0];
@@ -858,7 +966,7 @@ static unsigned char data_crc(unsigned char *data, int length)
     return remainder;
 }
 
-static bool check_hotkeys(int Control)
+static bool check_hotkeys_with_state(int Control, const InputBits& bits)
 {
     InputProfile* profile = &l_InputProfiles[Control];
 
@@ -872,7 +980,7 @@ static bool check_hotkeys(int Control)
     }
 
 #define DEFINE_HOTKEY(mapping, pressed, function, function2) \
-    state = get_button_state(profile, &profile->mapping, true); \
+    state = get_button_state(bits, &profile->mapping, true); \
     if (state) \
     { \
         if (!profile->pressed) \
@@ -909,6 +1017,7 @@ static bool check_hotkeys(int Control)
     DEFINE_HOTKEY(Hotkey_SaveState,             Hotkey_SaveState_Pressed,     CoreSaveState(), );
     DEFINE_HOTKEY(Hotkey_LoadState,             Hotkey_LoadState_Pressed,     CoreLoadSaveState(), );
     DEFINE_HOTKEY(Hotkey_GSButton,              Hotkey_GSButton_Pressed,      CorePressGamesharkButton(true), CorePressGamesharkButton(false));
+    DEFINE_HOTKEY(Hotkey_Rewind,                Hotkey_Rewind_Pressed,        CoreSetRewinding(true), CoreSetRewinding(false));
     DEFINE_HOTKEY(Hotkey_SaveStateSlot0,        Hotkey_SaveStateSlot_Pressed, CoreSetSaveStateSlot(0), );
     DEFINE_HOTKEY(Hotkey_SaveStateSlot1,        Hotkey_SaveStateSlot_Pressed, CoreSetSaveStateSlot(1), );
     DEFINE_HOTKEY(Hotkey_SaveStateSlot2,        Hotkey_SaveStateSlot_Pressed, CoreSetSaveStateSlot(2), );
@@ -930,6 +1039,17 @@ static bool check_hotkeys(int Control)
     return false;
 }
 
+static bool check_hotkeys(int Control)
+{
+    Utilities::InputDeviceState deviceState;
+    InputBits bits;
+
+    l_InputProfiles[Control].InputDevice.GetState(deviceState, INPUT_STATE_MAX_AGE);
+    get_input_bits(deviceState, bits);
+
+    return check_hotkeys_with_state(Control, bits);
+}
+
 static void sdl_init()
 {
     std::filesystem::path gameControllerDbPath;
@@ -1006,6 +1126,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     l_HotkeysThread = new Thread::HotkeysThread(check_hotkeys, nullptr);
     l_HotkeysThread->start();
 
+    l_InputPollThread = new Thread::InputPollThread(sample_input_devices, nullptr);
+    l_InputPollThread->start();
+
     load_settings();
 
     return M64ERR_SUCCESS;
@@ -1018,6 +1141,10 @@ EXPORT m64p_error CALL PluginShutdown(void)
         return M64ERR_NOT_INIT;
     }
 
+    l_InputPollThread->StopLoop();
+    l_InputPollThread->deleteLater();
+    l_InputPollThread = nullptr;
+
     close_controllers();
 
     l_SDLThread->StopLoop();
@@ -1252,51 +1379,50 @@ EXPORT void CALL GetKeys(int Control, BUTTONS* Keys)
     }
 #endif
 
+    // read the latest state published
+    // by the input polling thread
+    Utilities::InputDeviceState deviceState;
+    InputBits bits;
+    profile->InputDevice.GetState(deviceState, INPUT_STATE_MAX_AGE);
+    get_input_bits(deviceState, bits);
+
     // when we've matched a hotkey,
     // we don't need to check anything
     // else
-    if (check_hotkeys(Control))
+    if (check_hotkeys_with_state(Control, bits))
     {
         return;
     }
 
-    Keys->A_BUTTON     = get_button_state(profile, &profile->Button_A);
-    Keys->B_BUTTON     = get_button_state(profile, &profile->Button_B);
-    Keys->START_BUTTON = get_button_state(profile, &profile->Button_Start);
-    Keys->U_DPAD       = get_button_state(profile, &profile->Button_DpadUp);
-    Keys->D_DPAD       = get_button_state(profile, &profile->Button_DpadDown);
-    Keys->L_DPAD       = get_button_state(profile, &profile->Button_DpadLeft);
-    Keys->R_DPAD       = get_button_state(profile, &profile->Button_DpadRight);
-    Keys->U_CBUTTON    = get_button_state(profile, &profile->Button_CButtonUp);
-    Keys->D_CBUTTON    = get_button_state(profile, &profile->Button_CButtonDown);
-    Keys->L_CBUTTON    = get_button_state(profile, &profile->Button_CButtonLeft);
-    Keys->R_CBUTTON    = get_button_state(profile, &profile->Button_CButtonRight);
-    Keys->L_TRIG       = get_button_state(profile, &profile->Button_LeftShoulder);
-    Keys->R_TRIG       = get_button_state(profile, &profile->Button_RightShoulder);
-    Keys->Z_TRIG       = get_button_state(profile, &profile->Button_ZTrigger);
-
-    double inputX = 0, inputY = 0;
+    Keys->A_BUTTON     = get_button_state(bits, &profile->Button_A);
+    Keys->B_BUTTON     = get_button_state(bits, &profile->Button_B);
+    Keys->START_BUTTON = get_button_state(bits, &profile->Button_Start);
+    Keys->U_DPAD       = get_button_state(bits, &profile->Button_DpadUp);
+    Keys->D_DPAD       = get_button_state(bits, &profile->Button_DpadDown);
+    Keys->L_DPAD       = get_button_state(bits, &profile->Button_DpadLeft);
+    Keys->R_DPAD       = get_button_state(bits, &profile->Button_DpadRight);
+    Keys->U_CBUTTON    = get_button_state(bits, &profile->Button_CButtonUp);
+    Keys->D_CBUTTON    = get_button_state(bits, &profile->Button_CButtonDown);
+    Keys->L_CBUTTON    = get_button_state(bits, &profile->Button_CButtonLeft);
+    Keys->R_CBUTTON    = get_button_state(bits, &profile->Button_CButtonRight);
+    Keys->L_TRIG       = get_button_state(bits, &profile->Button_LeftShoulder);
+    Keys->R_TRIG       = get_button_state(bits, &profile->Button_RightShoulder);
+    Keys->Z_TRIG       = get_button_state(bits, &profile->Button_ZTrigger);
+
+    int axisX = 0, axisY = 0;
     bool useButtonMapping = false;
-    inputY = get_axis_state(profile, &profile->AnalogStick_Up,    1, inputY, useButtonMapping);
-    inputY = get_axis_state(profile, &profile->AnalogStick_Down, -1, inputY, useButtonMapping);
-    inputX = get_axis_state(profile, &profile->AnalogStick_Left, -1, inputX, useButtonMapping);
-    inputX = get_axis_state(profile, &profile->AnalogStick_Right, 1, inputX, useButtonMapping);
-
-    // take deadzone into account
-    const double deadzone = profile->DeadzoneValue / 100.0;
-    inputX = apply_deadzone(inputX, deadzone);
-    inputY = apply_deadzone(inputY, deadzone);
+    axisY = get_axis_state(bits, deviceState, &profile->AnalogStick_Up,    1, axisY, useButtonMapping);
+    axisY = get_axis_state(bits, deviceState, &profile->AnalogStick_Down, -1, axisY, useButtonMapping);
+    axisX = get_axis_state(bits, deviceState, &profile->AnalogStick_Left, -1, axisX, useButtonMapping);
+    axisX = get_axis_state(bits, deviceState, &profile->AnalogStick_Right, 1, axisX, useButtonMapping);
 
-    // take sensitivity into account
-    const double sensitivityRatio = profile->SensitivityValue / 100.0;
-    const double lowerInputLimit = std::max(-1.0, -sensitivityRatio);
-    const double upperInputLimit = std::min(1.0, sensitivityRatio);
-    inputX = std::clamp(inputX * sensitivityRatio, lowerInputLimit, upperInputLimit);
-    inputY = std::clamp(inputY * sensitivityRatio, lowerInputLimit, upperInputLimit);
+    // take deadzone & sensitivity into account
+    const double inputX = std::copysign(profile->AxisTable[std::abs(axisX)], axisX);
+    const double inputY = std::copysign(profile->AxisTable[std::abs(axisY)], axisY);
 
     int octagonX = 0, octagonY = 0;
     simulate_octagon(
-        deadzone, // deadzone
+        profile->OctagonInputRadius, // maxInputRadius
         inputX, // inputX
         inputY, // inputY
         octagonX, // outputX
@@ -1309,7 +1435,7 @@ EXPORT void CALL GetKeys(int Control, BUTTONS* Keys)
 
 EXPORT void CALL InitiateControllers(CONTROL_INFO ControlInfo)
 {
-    for (int i = 0; i < SDL_NUM_SCANCODES; i++)
+    for (int i = 0; i < KEYBOARD_WORDS; i++)
     {
         l_KeyboardState[i] = 0;
     }
@@ -1334,12 +1460,14 @@ EXPORT void CALL ReadController(int Control, unsigned char *Command)
 EXPORT int CALL RomOpen(void)
 {
     l_HotkeysThread->SetState(HotkeysThreadState::RomOpened);
+    l_InputPollThread->SetState(InputPollThreadState::RomOpened);
     return 1;
 }
 
 EXPORT void CALL RomClosed(void)
 {
     l_HotkeysThread->SetState(HotkeysThreadState::RomClosed);
+    l_InputPollThread->SetState(InputPollThreadState::RomClosed);
     l_HasControlInfo = false;
     close_controllers();
 #ifdef VRU
@@ -1349,10 +1477,20 @@ EXPORT void CALL RomClosed(void)
 
 EXPORT void CALL SDL_KeyDown(int keymod, int keysym)
 {
-    l_KeyboardState[keysym] = true;
+    if (keysym < 0 || keysym >= SDL_NUM_SCANCODES)
+    {
+        return;
+    }
+
+    l_KeyboardState[keysym / 64].fetch_or((uint64_t)1 << (keysym % 64), std::memory_order_relaxed);
 }
 
 EXPORT void CALL SDL_KeyUp(int keymod, int keysym)
 {
-    l_KeyboardState[keysym] = false;
+    if (keysym < 0 || keysym >= SDL_NUM_SCANCODES)
+    {
+        return;
+    }
+
+    l_KeyboardState[keysym / 64].fetch_and(~((uint64_t)1 << (keysym % 64)), std::memory_order_relaxed);
 }
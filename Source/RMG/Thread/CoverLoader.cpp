@@ -0,0 +1,292 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "CoverLoader.hpp"
+
+#include <RMG-Core/Directories.hpp>
+
+#include <QCryptographicHash>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QDir>
+
+using namespace Thread;
+
+//
+// Local Defines
+//
+
+// maximum width & height of the
+// cached cover thumbnails
+#define COVER_THUMBNAIL_SIZE 512
+
+//
+// Local Functions
+//
+
+static QString get_cover_file_key(QString fileName)
+{
+#if defined(_WIN32) || defined(__APPLE__)
+    // the file systems on these platforms
+    // are case insensitive by default
+    return fileName.toLower();
+#else
+    return fileName;
+#endif
+}
+
+static QHash<QString, QString> get_cover_files(QString coversDirectory)
+{
+    QHash<QString, QString> coverFiles;
+
+    for (const QString& file : QDir(coversDirectory).entryList(QDir::Files))
+    {
+        coverFiles.insert(get_cover_file_key(file), file);
+    }
+
+    return coverFiles;
+}
+
+static QImage load_cover_thumbnail(QString coverFile, QString thumbnailDirectory)
+{
+    QFileInfo coverFileInfo(coverFile);
+    QString thumbnailFile;
+    QImage image;
+
+    // the thumbnail is keyed by the path, size and
+    // modification time of the cover, so
+    // changing the cover invalidates it
+    if (!thumbnailDirectory.isEmpty())
+    {
+        QCryptographicHash hash(QCryptographicHash::Algorithm::Sha1);
+        hash.addData(coverFileInfo.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(coverFileInfo.size()));
+        hash.addData(QByteArray::number(coverFileInfo.lastModified().toMSecsSinceEpoch()));
+        hash.addData(QByteArray::number(COVER_THUMBNAIL_SIZE));
+
+        thumbnailFile = thumbnailDirectory;
+        thumbnailFile += CORE_DIR_SEPERATOR_STR;
+        thumbnailFile += QString::fromLatin1(hash.result().toHex());
+        thumbnailFile += ".png";
+
+        if (image.load(thumbnailFile))
+        {
+            return image;
+        }
+    }
+
+    // let the image reader scale the image
+    // while decoding, which is a lot faster
+    // for JPEG images than scaling afterwards
+    QImageReader imageReader(coverFile);
+    QSize imageSize = imageReader.size();
+    if (imageSize.isValid() &&
+        (imageSize.width() > COVER_THUMBNAIL_SIZE || imageSize.height() > COVER_THUMBNAIL_SIZE))
+    {
+        imageReader.setScaledSize(imageSize.scaled(COVER_THUMBNAIL_SIZE, COVER_THUMBNAIL_SIZE, Qt::KeepAspectRatio));
+    }
+
+    if (!imageReader.read(&image))
+    {
+        return QImage();
+    }
+
+    if (!thumbnailFile.isEmpty())
+    {
+        QSaveFile saveFile(thumbnailFile);
+        if (saveFile.open(QIODevice::WriteOnly) &&
+            image.save(&saveFile, "PNG"))
+        {
+            saveFile.commit();
+        }
+    }
+
+    return image;
+}
+
+//
+// Exported Functions
+//
+
+CoverLoader::CoverLoader(QObject *parent) : QObject(parent)
+{
+    this->threadPool = new QThreadPool(this);
+}
+
+CoverLoader::~CoverLoader(void)
+{
+    this->threadPool->clear();
+    this->threadPool->waitForDone();
+}
+
+void CoverLoader::SetDirectories(QString coversDirectory, QString thumbnailDirectory)
+{
+    this->Clear();
+
+    this->coversDirectory    = coversDirectory;
+    this->thumbnailDirectory = thumbnailDirectory;
+
+    if (!QDir().exists(this->thumbnailDirectory))
+    {
+        QDir().mkpath(this->thumbnailDirectory);
+    }
+
+    this->RefreshCoversDirectory();
+}
+
+void CoverLoader::RefreshCoversDirectory(void)
+{
+    // keep a list of the files in the
+    // covers directory, so we don't have to
+    // probe for every possible cover file
+    this->coverFiles = get_cover_files(this->coversDirectory);
+}
+
+void CoverLoader::Load(QString file, CoreRomHeader header, CoreRomSettings settings)
+{
+    if (this->requestedFiles.contains(file))
+    {
+        return;
+    }
+
+    this->requestedFiles.insert(file);
+
+    const int generation = this->generation;
+    const QString coversDirectory = this->coversDirectory;
+    const QString thumbnailDirectory = this->thumbnailDirectory;
+    const QHash<QString, QString> coverFiles = this->coverFiles;
+
+    this->threadPool->start([=, this]()
+    {
+        QString coverFile;
+        QImage image = loadCover(coversDirectory, thumbnailDirectory, coverFiles, file, header, settings, coverFile);
+
+        QMetaObject::invokeMethod(this, [=, this]()
+        {
+            // drop results of requests
+            // which have been discarded
+            if (generation != this->generation)
+            {
+                return;
+            }
+
+            emit this->CoverLoaded(file, coverFile, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CoverLoader::Reload(QString file, CoreRomHeader header, CoreRomSettings settings)
+{
+    this->requestedFiles.insert(file);
+
+    const int generation = this->generation;
+    const QString coversDirectory = this->coversDirectory;
+    const QString thumbnailDirectory = this->thumbnailDirectory;
+
+    this->threadPool->start([=, this]()
+    {
+        QString coverFile;
+        QHash<QString, QString> coverFiles = get_cover_files(coversDirectory);
+        QImage image = loadCover(coversDirectory, thumbnailDirectory, coverFiles, file, header, settings, coverFile);
+
+        QMetaObject::invokeMethod(this, [=, this]()
+        {
+            if (generation != this->generation)
+            {
+                return;
+            }
+
+            this->coverFiles = coverFiles;
+            emit this->CoverLoaded(file, coverFile, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CoverLoader::Remove(QString file)
+{
+    this->requestedFiles.remove(file);
+}
+
+void CoverLoader::Clear(void)
+{
+    this->threadPool->clear();
+    this->requestedFiles.clear();
+    this->generation++;
+}
+
+QImage CoverLoader::loadCover(QString coversDirectory, QString thumbnailDirectory, QHash<QString, QString> coverFiles,
+                              QString file, CoreRomHeader header, CoreRomSettings settings, QString& coverFile)
+{
+    QImage image;
+
+    // construct basename of file,
+    // by retrieving the last index of '.'
+    // and removing all characters from that index
+    // until the end of the string
+    QString baseName         = QFileInfo(file).fileName();
+    qsizetype lastIndexOfDot = baseName.lastIndexOf(".");
+    if (lastIndexOfDot != -1)
+    { // only remove when index was found
+        baseName.remove(lastIndexOfDot, baseName.size() - lastIndexOfDot);
+    }
+
+    // try to load cover using
+    // 1) basename of file
+    // 2) MD5
+    // 3) good name
+    // 4) internal name
+    for (QString name : {
+        baseName,
+        QString::fromStdString(settings.MD5),
+        QString::fromStdString(settings.GoodName),
+        QString::fromStdString(header.Name) })
+    {
+        // fixup file name
+        QString fixedName = name;
+        for (const QChar c : QString(":<>\"/\\|?*"))
+        {
+            fixedName.replace(c, "_");
+        }
+
+        // skip empty names,
+        // this can i.e happen
+        // when ROMs don't have
+        // an internal ROM name
+        if (fixedName.isEmpty())
+        {
+            continue;
+        }
+
+        // we support jpg & png as file extensions
+        for (QString ext : { ".png", ".jpg", ".jpeg" })
+        {
+            auto coverFileIter = coverFiles.constFind(get_cover_file_key(fixedName + ext));
+            if (coverFileIter == coverFiles.cend())
+            {
+                continue;
+            }
+
+            QString coverPath = coversDirectory;
+            coverPath += CORE_DIR_SEPERATOR_STR;
+            coverPath += coverFileIter.value();
+
+            image = load_cover_thumbnail(coverPath, thumbnailDirectory);
+            if (!image.isNull())
+            {
+                coverFile = coverPath;
+                return image;
+            }
+        }
+    }
+
+    coverFile.clear();
+    return QImage();
+}
@@ -0,0 +1,78 @@
+/*
+ * Rosalie's Mupen GUI - https://github.com/Rosalie241/RMG
+ *  Copyright (C) 2020-2025 Rosalie Wanders <rosalie@mailbox.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef COVERLOADER_HPP
+#define COVERLOADER_HPP
+
+#include <RMG-Core/RomSettings.hpp>
+#include <RMG-Core/RomHeader.hpp>
+
+#include <QThreadPool>
+#include <QObject>
+#include <QString>
+#include <QImage>
+#include <QHash>
+#include <QSet>
+
+namespace Thread
+{
+class CoverLoader : public QObject
+{
+    Q_OBJECT
+
+  public:
+    CoverLoader(QObject *);
+    ~CoverLoader(void);
+
+    // sets the directory containing the covers
+    // and the directory where the thumbnails
+    // are cached, this also discards
+    // all pending requests
+    void SetDirectories(QString coversDirectory, QString thumbnailDirectory);
+
+    // re-reads the contents of the covers directory
+    void RefreshCoversDirectory(void);
+
+    // queues loading the cover for the given file,
+    // when the file has already been requested,
+    // nothing is done
+    void Load(QString file, CoreRomHeader header, CoreRomSettings settings);
+
+    // re-reads the contents of the covers directory
+    // and loads the cover for the given file again,
+    // i.e after its cover has been changed
+    void Reload(QString file, CoreRomHeader header, CoreRomSettings settings);
+
+    // allows the cover for the given
+    // file to be requested again
+    void Remove(QString file);
+
+    // discards all pending requests
+    void Clear(void);
+
+  private:
+    QThreadPool* threadPool = nullptr;
+
+    QString coversDirectory;
+    QString thumbnailDirectory;
+    // lookup key of the file name -> file name
+    QHash<QString, QString> coverFiles;
+
+    QSet<QString> requestedFiles;
+    int generation = 0;
+
+    static QImage loadCover(QString coversDirectory, QString thumbnailDirectory, QHash<QString, QString> coverFiles,
+                            QString file, CoreRomHeader header, CoreRomSettings settings, QString& coverFile);
+
+  signals:
+    void CoverLoaded(QString file, QString coverFile, QImage image);
+};
+} // namespace Thread
+
+#endif // COVERLOADER_HPP
@@ -14,6 +14,8 @@
 #include <QElapsedTimer>
 #include <QDirIterator>
 
+#include <vector>
+
 using namespace Thread;
 
 RomSearcherThread::RomSearcherThread(QObject *parent) : QThread(parent)
@@ -34,6 +36,11 @@ void RomSearcherThread::SetDirectory(QString directory)
     this->directory = directory;
 }
 
+void RomSearcherThread::SetFiles(QStringList files)
+{
+    this->files = files;
+}
+
 void RomSearcherThread::SetRecursive(bool value)
 {
     this->recursive = value;
@@ -44,6 +51,11 @@ void RomSearcherThread::SetMaximumFiles(int value)
     this->maxItems = value;
 }
 
+void RomSearcherThread::SetOpenDisks(bool value)
+{
+    this->openDisks = value;
+}
+
 void RomSearcherThread::Stop(void)
 {
     this->stop = true;
@@ -56,10 +68,22 @@ void RomSearcherThread::Stop(void)
 void RomSearcherThread::run(void)
 {
     this->stop = false;
-    this->searchDirectory(this->directory);
+
+    // when we've been given a list of files,
+    // only retrieve the data for those files
+    // instead of searching the whole directory
+    if (!this->files.isEmpty())
+    {
+        this->searchFiles(this->files);
+        this->files.clear();
+    }
+    else
+    {
+        this->searchDirectory(this->directory);
+    }
 }
 
-void RomSearcherThread::searchDirectory(QString directory)
+QStringList RomSearcherThread::GetNameFilters(void)
 {
     QStringList filter;
     filter << "*.N64";
@@ -69,17 +93,15 @@ void RomSearcherThread::searchDirectory(QString directory)
     filter << "*.D64";
     filter << "*.ZIP";
     filter << "*.7Z";
+    return filter;
+}
 
+void RomSearcherThread::searchDirectory(QString directory)
+{
     QDirIterator::IteratorFlag flag = this->recursive ? 
         QDirIterator::Subdirectories : 
         QDirIterator::NoIteratorFlags;
-    QDirIterator romDirIt(directory, filter, QDir::Files, flag);
-
-    CoreRomType     type;
-    CoreRomHeader   header;
-    CoreRomSettings defaultSettings;
-    CoreRomSettings settings;
-    bool            ret;
+    QDirIterator romDirIt(directory, GetNameFilters(), QDir::Files, flag);
 
     QList<QString> roms;
     while (romDirIt.hasNext())
@@ -87,8 +109,20 @@ void RomSearcherThread::searchDirectory(QString directory)
         roms.push_back(romDirIt.next());
     }
 
+    this->searchFiles(roms);
+}
+
+void RomSearcherThread::searchFiles(QList<QString> roms)
+{
     const int romAmount = std::min(this->maxItems, (int)roms.size());
 
+    std::vector<std::filesystem::path> files;
+    files.reserve(romAmount);
+    for (int i = 0; i < romAmount; i++)
+    {
+        files.push_back(roms.at(i).toStdU32String());
+    }
+
     // our ROM data
     QList<RomSearcherThreadData> data;
 
@@ -96,20 +130,18 @@ void RomSearcherThread::searchDirectory(QString directory)
     QElapsedTimer timer;
     timer.start();
 
-    for (int i = 0; i < romAmount; i++)
+    // files which aren't cached yet are
+    // scanned on multiple threads by the core,
+    // the callback is called from this thread
+    CoreGetCachedRomHeaderAndSettings(files, this->openDisks, [&](const CoreRomHeaderAndSettings& romData, size_t processed)
     {
-        QString file = roms.at(i);
-
-        if (CoreGetCachedRomHeaderAndSettings(file.toStdU32String(), &type, &header, nullptr, &settings))
+        data.push_back(
         {
-            data.push_back(
-            {
-                file,
-                type,
-                header,
-                settings
-            });
-        }
+            QString::fromStdU32String(romData.File.u32string()),
+            romData.Type,
+            romData.Header,
+            romData.Settings
+        });
 
         // we need to give the UI some breathing room,
         // so when 10ms have passed,
@@ -118,16 +150,13 @@ void RomSearcherThread::searchDirectory(QString directory)
         // the timer
         if (timer.elapsed() >= 10)
         {
-            emit this->RomsFound(data, (i + 1), romAmount);
+            emit this->RomsFound(data, (int)processed, romAmount);
             data.clear();
             timer.start();
         }
 
-        if (this->stop)
-        {
-            break;
-        }
-    }
+        return !this->stop;
+    });
 
     // when we're done and
     // we still have data left,
@@ -14,6 +14,7 @@
 #include <RMG-Core/RomHeader.hpp>
 #include <RMG-Core/Rom.hpp>
 
+#include <QStringList>
 #include <QString>
 #include <QThread>
 
@@ -36,19 +37,26 @@ class RomSearcherThread : public QThread
     ~RomSearcherThread(void);
 
     void SetDirectory(QString);
+    void SetFiles(QStringList);
     void SetRecursive(bool);
     void SetMaximumFiles(int);
+    void SetOpenDisks(bool);
     void Stop(void);
 
     void run(void) override;
 
+    static QStringList GetNameFilters(void);
+
   private:
     QString directory;
+    QStringList files;
     bool recursive = false;
     int  maxItems = 0;
+    bool openDisks = true;
     bool stop = false;
 
     void searchDirectory(QString);
+    void searchFiles(QList<QString>);
 
   signals:
     void RomsFound(QList<RomSearcherThreadData> data, int index, int count);
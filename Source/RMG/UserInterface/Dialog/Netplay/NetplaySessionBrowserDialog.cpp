@@ -23,6 +23,7 @@
 #include <QJsonArray>
 #include <QFile>
 
+#include <RMG-Core/CachedRomHeaderAndSettings.hpp>
 #include <RMG-Core/Settings.hpp>
 #include <RMG-Core/Rom.hpp>
 
@@ -424,6 +425,16 @@ void NetplaySessionBrowserDialog::accept()
         }
     }
 
+    // attempt to find ROM from the ROM header & settings cache
+    if (this->sessionFile.isEmpty())
+    {
+        std::filesystem::path cachedFile;
+        if (CoreFindCachedRomFileByMD5(md5, cachedFile))
+        {
+            this->sessionFile = QString::fromStdU32String(cachedFile.u32string());
+        }
+    }
+
     // show ROM dialog when we haven't found the ROM
     if (this->sessionFile.isEmpty())
     {
@@ -287,10 +287,14 @@ void SettingsDialog::loadCoreSettings(void)
     int saveFilenameFormat = 0;
     int siDmaDuration = -1;
     bool randomizeInterrupt = true;
+    bool framePacingDisplayLock = false;
     bool usePIFROM = false;
     QString ntscPifROM;
     QString palPifRom;
     bool overrideGameSettings = false;
+    bool rewindEnabled = false;
+    int rewindBufferSize = 0;
+    int rewindInterval = 0;
 
     disableExtraMem = CoreSettingsGetBoolValue(SettingsID::CoreOverlay_DisableExtraMem);
     counterFactor = CoreSettingsGetIntValue(SettingsID::CoreOverlay_CountPerOp);
@@ -298,19 +302,28 @@ void SettingsDialog::loadCoreSettings(void)
     saveFilenameFormat = CoreSettingsGetIntValue(SettingsID::CoreOverLay_SaveFileNameFormat);
     siDmaDuration = CoreSettingsGetIntValue(SettingsID::CoreOverlay_SiDmaDuration);
     randomizeInterrupt = CoreSettingsGetBoolValue(SettingsID::CoreOverlay_RandomizeInterrupt);
+    framePacingDisplayLock = CoreSettingsGetBoolValue(SettingsID::Core_FramePacingDisplayLock);
     usePIFROM = CoreSettingsGetBoolValue(SettingsID::Core_PIF_Use);
     ntscPifROM = QString::fromStdString(CoreSettingsGetStringValue(SettingsID::Core_PIF_NTSC));
     palPifRom = QString::fromStdString(CoreSettingsGetStringValue(SettingsID::Core_PIF_PAL));
     overrideGameSettings = CoreSettingsGetBoolValue(SettingsID::Core_OverrideGameSpecificSettings);
+    rewindEnabled = CoreSettingsGetBoolValue(SettingsID::Core_Rewind_Enabled);
+    rewindBufferSize = CoreSettingsGetIntValue(SettingsID::Core_Rewind_BufferSize);
+    rewindInterval = CoreSettingsGetIntValue(SettingsID::Core_Rewind_Interval);
 
     this->coreCpuEmulatorComboBox->setCurrentIndex(cpuEmulator);
     this->coreSaveFilenameFormatComboBox->setCurrentIndex(saveFilenameFormat);
     this->coreRandomizeTimingCheckBox->setChecked(randomizeInterrupt);
+    this->coreFramePacingDisplayLockCheckBox->setChecked(framePacingDisplayLock);
 
     this->usePifRomGroupBox->setChecked(usePIFROM);
     this->ntscPifRomLineEdit->setText(ntscPifROM);
     this->palPifRomLineEdit->setText(palPifRom);
 
+    this->coreRewindGroupBox->setChecked(rewindEnabled);
+    this->coreRewindBufferSizeSpinBox->setValue(rewindBufferSize);
+    this->coreRewindIntervalSpinBox->setValue(rewindInterval);
+
     this->coreOverrideGameSettingsGroup->setChecked(overrideGameSettings);
 
     if (!overrideGameSettings)
@@ -333,6 +346,7 @@ void SettingsDialog::loadGameSettings(void)
     this->gameCounterFactorComboBox->setCurrentIndex(this->currentGameSettings.CountPerOp - 1);
     this->gameTransferPakComboBox->setCurrentIndex(this->currentGameSettings.TransferPak);
     this->gameSiDmaDurationSpinBox->setValue(this->currentGameSettings.SiDMADuration);
+    this->gameRunAheadFramesSpinBox->setValue(this->currentGameSettings.RunAheadFrames);
 }
 
 void SettingsDialog::loadGameCoreSettings(void)
@@ -515,6 +529,7 @@ void SettingsDialog::loadInterfaceEmulationSettings(void)
 void SettingsDialog::loadInterfaceRomBrowserSettings(void)
 {
     this->searchSubDirectoriesCheckbox->setChecked(CoreSettingsGetBoolValue(SettingsID::RomBrowser_Recursive));
+    this->watchDirectoryCheckbox->setChecked(CoreSettingsGetBoolValue(SettingsID::RomBrowser_WatchDirectory));
     this->romSearchLimitSpinBox->setValue(CoreSettingsGetIntValue(SettingsID::RomBrowser_MaxItems));
 }
 
@@ -558,6 +573,8 @@ void SettingsDialog::loadInterfaceNetplaySettings(void)
 
     this->netplayNicknameLineEdit->setText(QString::fromStdString(CoreSettingsGetStringValue(SettingsID::Netplay_Nickname)));
     this->netplayServerUrlLineEdit->setText(QString::fromStdString(CoreSettingsGetStringValue(SettingsID::Netplay_ServerJsonUrl)));
+    this->netplayRollbackFramesSpinBox->setValue(CoreSettingsGetIntValue(SettingsID::Core_NetplayRollbackFrames));
+    this->netplaySyncHashIntervalSpinBox->setValue(CoreSettingsGetIntValue(SettingsID::Core_NetplaySyncHashInterval));
 }
 
 void SettingsDialog::loadDefaultCoreSettings(void)
@@ -568,10 +585,14 @@ void SettingsDialog::loadDefaultCoreSettings(void)
     int saveFilenameFormat = 0;
     int siDmaDuration = -1;
     bool randomizeInterrupt = true;
+    bool framePacingDisplayLock = false;
     bool usePIFROM;
     QString ntscPifROM;
     QString palPifRom;
     bool overrideGameSettings;
+    bool rewindEnabled;
+    int rewindBufferSize;
+    int rewindInterval;
 
     disableExtraMem = CoreSettingsGetDefaultBoolValue(SettingsID::CoreOverlay_DisableExtraMem);
     counterFactor = CoreSettingsGetDefaultIntValue(SettingsID::CoreOverlay_CountPerOp);
@@ -579,19 +600,28 @@ void SettingsDialog::loadDefaultCoreSettings(void)
     siDmaDuration = CoreSettingsGetDefaultIntValue(SettingsID::CoreOverlay_SiDmaDuration);
     saveFilenameFormat = CoreSettingsGetDefaultIntValue(SettingsID::CoreOverLay_SaveFileNameFormat);
     randomizeInterrupt = CoreSettingsGetDefaultBoolValue(SettingsID::CoreOverlay_RandomizeInterrupt);
+    framePacingDisplayLock = CoreSettingsGetDefaultBoolValue(SettingsID::Core_FramePacingDisplayLock);
     usePIFROM = CoreSettingsGetDefaultBoolValue(SettingsID::Core_PIF_Use);
     ntscPifROM = QString::fromStdString(CoreSettingsGetDefaultStringValue(SettingsID::Core_PIF_NTSC));
     palPifRom = QString::fromStdString(CoreSettingsGetDefaultStringValue(SettingsID::Core_PIF_PAL));
     overrideGameSettings = CoreSettingsGetDefaultBoolValue(SettingsID::Core_OverrideGameSpecificSettings);
+    rewindEnabled = CoreSettingsGetDefaultBoolValue(SettingsID::Core_Rewind_Enabled);
+    rewindBufferSize = CoreSettingsGetDefaultIntValue(SettingsID::Core_Rewind_BufferSize);
+    rewindInterval = CoreSettingsGetDefaultIntValue(SettingsID::Core_Rewind_Interval);
 
     this->coreCpuEmulatorComboBox->setCurrentIndex(cpuEmulator);
     this->coreSaveFilenameFormatComboBox->setCurrentIndex(saveFilenameFormat);
     this->coreRandomizeTimingCheckBox->setChecked(randomizeInterrupt);
+    this->coreFramePacingDisplayLockCheckBox->setChecked(framePacingDisplayLock);
 
     this->usePifRomGroupBox->setChecked(usePIFROM);
     this->ntscPifRomLineEdit->setText(ntscPifROM);
     this->palPifRomLineEdit->setText(palPifRom);
 
+    this->coreRewindGroupBox->setChecked(rewindEnabled);
+    this->coreRewindBufferSizeSpinBox->setValue(rewindBufferSize);
+    this->coreRewindIntervalSpinBox->setValue(rewindInterval);
+
     this->coreOverrideGameSettingsGroup->setChecked(overrideGameSettings);
 
     if (!this->coreOverrideGameSettingsGroup->isChecked())
@@ -614,6 +644,7 @@ void SettingsDialog::loadDefaultGameSettings(void)
     this->gameCounterFactorComboBox->setCurrentIndex(this->defaultGameSettings.CountPerOp - 1);
     this->gameTransferPakComboBox->setCurrentIndex(this->defaultGameSettings.TransferPak);
     this->gameSiDmaDurationSpinBox->setValue(this->defaultGameSettings.SiDMADuration);
+    this->gameRunAheadFramesSpinBox->setValue(this->defaultGameSettings.RunAheadFrames);
 }
 
 void SettingsDialog::loadDefaultGameCoreSettings(void)
@@ -698,6 +729,7 @@ void SettingsDialog::loadDefaultInterfaceEmulationSettings(void)
 void SettingsDialog::loadDefaultInterfaceRomBrowserSettings(void)
 {
     this->searchSubDirectoriesCheckbox->setChecked(CoreSettingsGetDefaultBoolValue(SettingsID::RomBrowser_Recursive));
+    this->watchDirectoryCheckbox->setChecked(CoreSettingsGetDefaultBoolValue(SettingsID::RomBrowser_WatchDirectory));
     this->romSearchLimitSpinBox->setValue(CoreSettingsGetDefaultIntValue(SettingsID::RomBrowser_MaxItems));
 }
 
@@ -732,6 +764,8 @@ void SettingsDialog::loadDefaultInterfaceNetplaySettings(void)
 {
     this->netplayNicknameLineEdit->setText(QString::fromStdString(CoreSettingsGetDefaultStringValue(SettingsID::Netplay_Nickname)));
     this->netplayServerUrlLineEdit->setText(QString::fromStdString(CoreSettingsGetDefaultStringValue(SettingsID::Netplay_ServerJsonUrl)));
+    this->netplayRollbackFramesSpinBox->setValue(CoreSettingsGetDefaultIntValue(SettingsID::Core_NetplayRollbackFrames));
+    this->netplaySyncHashIntervalSpinBox->setValue(CoreSettingsGetDefaultIntValue(SettingsID::Core_NetplaySyncHashInterval));
 }
 
 void SettingsDialog::saveSettings(void)
@@ -766,18 +800,26 @@ void SettingsDialog::saveCoreSettings(void)
     int saveFilenameFormat = this->coreSaveFilenameFormatComboBox->currentIndex();
     int siDmaDuration = this->coreSiDmaDurationSpinBox->value();
     bool randomizeInterrupt = this->coreRandomizeTimingCheckBox->isChecked();
+    bool framePacingDisplayLock = this->coreFramePacingDisplayLockCheckBox->isChecked();
     bool usePIF = this->usePifRomGroupBox->isChecked();
     QString ntscPifROM = this->ntscPifRomLineEdit->text();
     QString palPifROM = this->palPifRomLineEdit->text();
     bool overrideGameSettings = this->coreOverrideGameSettingsGroup->isChecked();
+    bool rewindEnabled = this->coreRewindGroupBox->isChecked();
+    int rewindBufferSize = this->coreRewindBufferSizeSpinBox->value();
+    int rewindInterval = this->coreRewindIntervalSpinBox->value();
 
     CoreSettingsSetValue(SettingsID::CoreOverlay_CPU_Emulator, cpuEmulator);
     CoreSettingsSetValue(SettingsID::CoreOverLay_SaveFileNameFormat, saveFilenameFormat);
     CoreSettingsSetValue(SettingsID::CoreOverlay_RandomizeInterrupt, randomizeInterrupt);
+    CoreSettingsSetValue(SettingsID::Core_FramePacingDisplayLock, framePacingDisplayLock);
     CoreSettingsSetValue(SettingsID::Core_PIF_Use, usePIF);
     CoreSettingsSetValue(SettingsID::Core_PIF_NTSC, ntscPifROM.toStdString());
     CoreSettingsSetValue(SettingsID::Core_PIF_PAL, palPifROM.toStdString());
     CoreSettingsSetValue(SettingsID::Core_OverrideGameSpecificSettings, overrideGameSettings);
+    CoreSettingsSetValue(SettingsID::Core_Rewind_Enabled, rewindEnabled);
+    CoreSettingsSetValue(SettingsID::Core_Rewind_BufferSize, rewindBufferSize);
+    CoreSettingsSetValue(SettingsID::Core_Rewind_Interval, rewindInterval);
 
     if (!overrideGameSettings)
     {
@@ -798,12 +840,14 @@ void SettingsDialog::saveGameSettings(void)
     int countPerOp = this->gameCounterFactorComboBox->currentIndex() + 1;
     bool transferPak = this->gameTransferPakComboBox->currentIndex() != 0;
     int siDmaDuration = this->gameSiDmaDurationSpinBox->value();
+    int runAheadFrames = this->gameRunAheadFramesSpinBox->value();
 
     if ((this->defaultGameSettings.DisableExtraMem != disableExtraMem) ||
         (this->defaultGameSettings.SaveType != saveType) ||
         (this->defaultGameSettings.CountPerOp != countPerOp) ||
         (this->defaultGameSettings.TransferPak != transferPak) ||
-        (this->defaultGameSettings.SiDMADuration != siDmaDuration))
+        (this->defaultGameSettings.SiDMADuration != siDmaDuration) ||
+        (this->defaultGameSettings.RunAheadFrames != runAheadFrames))
     {
         CoreSettingsSetValue(SettingsID::Game_OverrideSettings, this->gameSection, true);
         CoreSettingsSetValue(SettingsID::Game_TransferPak, this->gameSection, transferPak);
@@ -811,6 +855,7 @@ void SettingsDialog::saveGameSettings(void)
         CoreSettingsSetValue(SettingsID::Game_SaveType, this->gameSection, saveType);
         CoreSettingsSetValue(SettingsID::Game_CountPerOp, this->gameSection, countPerOp);
         CoreSettingsSetValue(SettingsID::Game_SiDmaDuration, this->gameSection, siDmaDuration);
+        CoreSettingsSetValue(SettingsID::Game_RunAheadFrames, this->gameSection, runAheadFrames);
     }
 
     // update cache when needed
@@ -822,6 +867,7 @@ void SettingsDialog::saveGameSettings(void)
         romSettings.CountPerOp = countPerOp;
         romSettings.TransferPak = transferPak;
         romSettings.SiDMADuration = siDmaDuration;
+        romSettings.RunAheadFrames = runAheadFrames;
         CoreUpdateCachedRomHeaderAndSettings(this->currentGameFile.toStdU32String(), this->currentGameType, this->currentGameHeader, this->defaultGameSettings, romSettings);
     }
 }
@@ -945,6 +991,7 @@ void SettingsDialog::saveInterfaceEmulationSettings(void)
 void SettingsDialog::saveInterfaceRomBrowserSettings(void)
 {
     CoreSettingsSetValue(SettingsID::RomBrowser_Recursive, this->searchSubDirectoriesCheckbox->isChecked());
+    CoreSettingsSetValue(SettingsID::RomBrowser_WatchDirectory, this->watchDirectoryCheckbox->isChecked());
     CoreSettingsSetValue(SettingsID::RomBrowser_MaxItems, this->romSearchLimitSpinBox->value());
 }
 
@@ -976,6 +1023,8 @@ void SettingsDialog::saveInterfaceNetplaySettings(void)
 {
     CoreSettingsSetValue(SettingsID::Netplay_Nickname, this->netplayNicknameLineEdit->text().toStdString());
     CoreSettingsSetValue(SettingsID::Netplay_ServerJsonUrl, this->netplayServerUrlLineEdit->text().toStdString());
+    CoreSettingsSetValue(SettingsID::Core_NetplayRollbackFrames, this->netplayRollbackFramesSpinBox->value());
+    CoreSettingsSetValue(SettingsID::Core_NetplaySyncHashInterval, this->netplaySyncHashIntervalSpinBox->value());
 }
 
 void SettingsDialog::commonHotkeySettings(SettingsDialogAction action)
@@ -1006,6 +1055,7 @@ void SettingsDialog::commonHotkeySettings(SettingsDialogAction action)
         { this->loadKeyButton, SettingsID::KeyBinding_Load },
         { this->cheatsKeyButton, SettingsID::KeyBinding_Cheats },
         { this->gsButtonKeyButton, SettingsID::KeyBinding_GSButton },
+        { this->rewindKeyButton, SettingsID::KeyBinding_Rewind },
     };
 
     std::vector<keybinding> keybindings_SpeedFactor =
@@ -64,6 +64,7 @@
 #include <RMG-Core/Settings.hpp>
 #include <RMG-Core/Netplay.hpp>
 #include <RMG-Core/Version.hpp>
+#include <RMG-Core/Rewind.hpp>
 #include <RMG-Core/Cheats.hpp>
 #include <RMG-Core/Volume.hpp>
 #include <RMG-Core/Error.hpp>
@@ -720,6 +721,10 @@ void MainWindow::launchEmulationThread(QString cartRom, QString diskRom, bool re
         this->ui_ShowStatusbar = CoreSettingsGetBoolValue(SettingsID::GUI_StatusBar);
     }
 
+    // don't apply the changes in the ROM directory
+    // while emulating, they're applied afterwards
+    this->ui_Widget_RomBrowser->PauseRomDirectoryWatcher();
+
     this->emulationThread->SetRomFile(cartRom);
     this->emulationThread->SetDiskFile(diskRom);
     this->emulationThread->start();
@@ -776,6 +781,9 @@ void MainWindow::updateActions(bool inEmulation, bool isPaused)
     keyBinding = QString::fromStdString(CoreSettingsGetStringValue(SettingsID::KeyBinding_GSButton));
     this->action_System_GSButton->setEnabled(inEmulation && !CoreHasInitNetplay());
     this->action_System_GSButton->setShortcut(QKeySequence(keyBinding));
+    keyBinding = QString::fromStdString(CoreSettingsGetStringValue(SettingsID::KeyBinding_Rewind));
+    this->action_System_Rewind->setEnabled(inEmulation && !CoreHasInitNetplay() && CoreSettingsGetBoolValue(SettingsID::Core_Rewind_Enabled));
+    this->action_System_Rewind->setShortcut(QKeySequence(keyBinding));
     keyBinding = QString::fromStdString(CoreSettingsGetStringValue(SettingsID::KeyBinding_Exit));
     this->action_System_Exit->setShortcut(QKeySequence(keyBinding));
 
@@ -1035,7 +1043,8 @@ void MainWindow::configureActions(void)
         this->actionSlot_3, this->actionSlot_4, this->actionSlot_5,
         this->actionSlot_6, this->actionSlot_7, this->actionSlot_8,
         this->actionSlot_9, this->action_System_Cheats,
-        this->action_System_GSButton, this->action_System_Exit,
+        this->action_System_GSButton, this->action_System_Rewind,
+        this->action_System_Exit,
         // Settings actions
         this->action_Settings_Graphics, this->action_Settings_Audio,
         this->action_Settings_Rsp, this->action_Settings_Input,
@@ -1166,6 +1175,7 @@ void MainWindow::connectActionSignals(void)
     connect(this->action_System_Load, &QAction::triggered, this, &MainWindow::on_Action_System_Load);
     connect(this->action_System_Cheats, &QAction::triggered, this, &MainWindow::on_Action_System_Cheats);
     connect(this->action_System_GSButton, &QAction::triggered, this, &MainWindow::on_Action_System_GSButton);
+    connect(this->action_System_Rewind, &QAction::triggered, this, &MainWindow::on_Action_System_Rewind);
 
     connect(this->action_Settings_Graphics, &QAction::triggered, this, &MainWindow::on_Action_Settings_Graphics);
     connect(this->action_Settings_Audio, &QAction::triggered, this, &MainWindow::on_Action_Settings_Audio);
@@ -1832,6 +1842,16 @@ void MainWindow::on_Action_System_GSButton(void)
     }
 }
 
+void MainWindow::on_Action_System_Rewind(void)
+{
+    // a keyboard shortcut can't be held down
+    // reliably, so the action toggles rewinding
+    if (!CoreSetRewinding(!CoreIsRewinding()))
+    {
+        this->showErrorMessage("CoreSetRewinding() Failed", "Rewind hasn't been initialized");
+    }
+}
+
 void MainWindow::on_Action_Settings_Graphics(void)
 {
     CorePluginsOpenConfig(CorePluginType::Gfx, this);
@@ -2046,6 +2066,10 @@ void MainWindow::on_Emulation_Started(void)
 
     this->ui_MessageBoxList.clear();
     this->ui_DebugCallbackErrors.clear();
+
+    // allow the speed limiter to lock
+    // to the refresh rate of the display
+    CoreSetDisplayRefreshRate(this->screen()->refreshRate());
 }
 
 void MainWindow::on_Emulation_Finished(bool ret, QString error)
@@ -2065,6 +2089,8 @@ void MainWindow::on_Emulation_Finished(bool ret, QString error)
     }
 #endif // NETPLAY
 
+    this->ui_Widget_RomBrowser->ResumeRomDirectoryWatcher();
+
     if (!this->ui_QuitAfterEmulation &&
         !this->ui_NoSwitchToRomBrowser &&
         this->ui_RefreshRomListAfterEmulation)
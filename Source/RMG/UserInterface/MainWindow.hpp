@@ -193,6 +193,7 @@ class MainWindow : public QMainWindow, private Ui::MainWindow
     void on_Action_System_CurrentSaveState(int slot);
     void on_Action_System_Cheats(void);
     void on_Action_System_GSButton(void);
+    void on_Action_System_Rewind(void);
     void on_Action_System_Exit(void);
 
     void on_Action_Settings_Graphics(void);
@@ -10,6 +10,7 @@
 #include "RomBrowserWidget.hpp"
 
 #include <QDesktopServices>
+#include <QDirIterator>
 #include <QFileDialog>
 #include <QGridLayout>
 #include <QBoxLayout>
@@ -20,6 +21,7 @@
 #include <QList>
 #include <QDir>
 
+#include <RMG-Core/CachedRomHeaderAndSettings.hpp>
 #include <RMG-Core/Directories.hpp>
 #include <RMG-Core/SaveState.hpp>
 #include <RMG-Core/Settings.hpp>
@@ -82,6 +84,16 @@ RomBrowserWidget::RomBrowserWidget(QWidget *parent) : QWidget(parent)
     connect(this->romSearcherThread, &Thread::RomSearcherThread::RomsFound, this, &RomBrowserWidget::on_RomBrowserThread_RomsFound);
     connect(this->romSearcherThread, &Thread::RomSearcherThread::Finished, this, &RomBrowserWidget::on_RomBrowserThread_Finished);
 
+    // configure rom directory watcher,
+    // changes are collected for a short while
+    // before they're applied to the ROM list
+    this->romDirectoryWatcher = new QFileSystemWatcher(this);
+    this->romDirectoryWatcherTimer = new QTimer(this);
+    this->romDirectoryWatcherTimer->setSingleShot(true);
+    this->romDirectoryWatcherTimer->setInterval(500);
+    connect(this->romDirectoryWatcher, &QFileSystemWatcher::directoryChanged, this, &RomBrowserWidget::on_RomDirectoryWatcher_directoryChanged);
+    connect(this->romDirectoryWatcherTimer, &QTimer::timeout, this, &RomBrowserWidget::on_RomDirectoryWatcherTimer_timeout);
+
     // configure empty widget
     this->emptyWidget = new Widget::RomBrowserEmptyWidget(this);
     this->stackedWidget->addWidget(this->emptyWidget);
@@ -184,6 +196,23 @@ RomBrowserWidget::RomBrowserWidget(QWidget *parent) : QWidget(parent)
     connect(this->gridViewWidget, &Widget::RomBrowserGridViewWidget::ZoomOut, this, &RomBrowserWidget::on_ZoomOut);
     connect(this->gridViewWidget, &Widget::RomBrowserGridViewWidget::FileDropped, this, &RomBrowserWidget::FileDropped);
 
+    // configure cover loader, covers are loaded in the
+    // background for the items which are (almost) visible,
+    // until then the fallback cover is shown
+    this->coverLoader = new Thread::CoverLoader(this);
+    this->coverLoaderTimer = new QTimer(this);
+    this->coverLoaderTimer->setSingleShot(true);
+    this->coverLoaderTimer->setInterval(25);
+    this->fallbackCoverIcon = QIcon(QPixmap(":Resource/CoverFallback.png"));
+    connect(this->coverLoader, &Thread::CoverLoader::CoverLoaded, this, &RomBrowserWidget::on_CoverLoader_CoverLoaded);
+    connect(this->coverLoaderTimer, &QTimer::timeout, this, &RomBrowserWidget::on_CoverLoaderTimer_timeout);
+    connect(this->gridViewWidget->verticalScrollBar(), &QScrollBar::valueChanged, this->coverLoaderTimer, qOverload<>(&QTimer::start));
+    connect(this->gridViewWidget->verticalScrollBar(), &QScrollBar::rangeChanged, this->coverLoaderTimer, qOverload<>(&QTimer::start));
+    connect(this->gridViewWidget, &QListView::iconSizeChanged, this->coverLoaderTimer, qOverload<>(&QTimer::start));
+    connect(this->gridViewProxyModel, &QSortFilterProxyModel::layoutChanged, this->coverLoaderTimer, qOverload<>(&QTimer::start));
+    connect(this->gridViewProxyModel, &QSortFilterProxyModel::rowsInserted, this->coverLoaderTimer, qOverload<>(&QTimer::start));
+    connect(this->stackedWidget, &QStackedWidget::currentChanged, this->coverLoaderTimer, qOverload<>(&QTimer::start));
+
 #ifdef DRAG_DROP
     // configure drag & drop
     this->setAcceptDrops(true);
@@ -286,6 +315,21 @@ void RomBrowserWidget::RefreshRomList(void)
 {
     this->listViewModel->removeRows(0, this->listViewModel->rowCount());
     this->gridViewModel->removeRows(0, this->gridViewModel->rowCount());
+    this->romFileTimes.clear();
+    this->gridViewItems.clear();
+
+    // stop watching the ROM directory,
+    // we'll start watching it again
+    // when we're done refreshing
+    this->romDirectoryWatcherTimer->stop();
+    this->changedRomDirectories.clear();
+    this->isUpdatingRomList = false;
+    this->isSyncingRomList  = false;
+    this->syncedRomFiles.clear();
+    if (!this->romDirectoryWatcher->directories().isEmpty())
+    {
+        this->romDirectoryWatcher->removePaths(this->romDirectoryWatcher->directories());
+    }
 
     this->menu_PlayGameWithDisk->clear();
 
@@ -293,6 +337,11 @@ void RomBrowserWidget::RefreshRomList(void)
     this->coversDirectory += CORE_DIR_SEPERATOR_STR;
     this->coversDirectory += "Covers";
 
+    QString thumbnailDirectory = QString::fromStdString(CoreGetUserCacheDirectory().string());
+    thumbnailDirectory += CORE_DIR_SEPERATOR_STR;
+    thumbnailDirectory += "CoverThumbnails";
+    this->coverLoader->SetDirectories(this->coversDirectory, thumbnailDirectory);
+
     this->listViewSortSection = CoreSettingsGetIntValue(SettingsID::RomBrowser_ListViewSortSection);
     this->listViewSortOrder   = CoreSettingsGetIntValue(SettingsID::RomBrowser_ListViewSortOrder);
 
@@ -303,16 +352,35 @@ void RomBrowserWidget::RefreshRomList(void)
         return;
     }
 
-    this->stackedWidget->setCurrentWidget(this->loadingWidget);
+    const bool recursive = CoreSettingsGetBoolValue(SettingsID::RomBrowser_Recursive);
+    const int  maxItems  = CoreSettingsGetIntValue(SettingsID::RomBrowser_MaxItems);
 
     this->showSearchLineEdit = this->searchLineEdit->isVisible();
     this->searchLineEdit->hide();
 
+    // show the cached entries of the ROM directory right away,
+    // the ROM directory is still searched in the background
+    // and the differences are applied to the list afterwards,
+    // when there are no cached entries, show the loading screen
+    if (this->addCachedRomData(directory, recursive, maxItems))
+    {
+        this->isSyncingRomList = true;
+        this->configureRomListView();
+        this->stackedWidget->setCurrentWidget(this->currentViewWidget);
+        this->searchLineEdit->setVisible(this->showSearchLineEdit);
+    }
+    else
+    {
+        this->stackedWidget->setCurrentWidget(this->loadingWidget);
+    }
+
     this->romSearcherTimer.start();
 
-    this->romSearcherThread->SetMaximumFiles(CoreSettingsGetIntValue(SettingsID::RomBrowser_MaxItems));
-    this->romSearcherThread->SetRecursive(CoreSettingsGetBoolValue(SettingsID::RomBrowser_Recursive));
+    this->romSearcherThread->SetMaximumFiles(maxItems);
+    this->romSearcherThread->SetRecursive(recursive);
     this->romSearcherThread->SetDirectory(directory);
+    this->romSearcherThread->SetFiles({});
+    this->romSearcherThread->SetOpenDisks(true);
     this->romSearcherThread->start();
 }
 
@@ -326,12 +394,29 @@ void RomBrowserWidget::StopRefreshRomList(void)
     return this->romSearcherThread->Stop();
 }
 
+void RomBrowserWidget::PauseRomDirectoryWatcher(void)
+{
+    // keep collecting the changed directories,
+    // they're applied when we're resumed
+    this->isRomDirectoryWatcherPaused = true;
+    this->romDirectoryWatcherTimer->stop();
+}
+
+void RomBrowserWidget::ResumeRomDirectoryWatcher(void)
+{
+    this->isRomDirectoryWatcherPaused = false;
+    if (!this->changedRomDirectories.isEmpty())
+    {
+        this->romDirectoryWatcherTimer->start();
+    }
+}
+
 void RomBrowserWidget::ShowList(void)
 {
     this->currentViewWidget = this->listViewWidget;
 
     // only change widget now when we're not refreshing
-    if (!this->IsRefreshingRomList() &&
+    if ((!this->IsRefreshingRomList() || this->isUpdatingRomList) &&
         this->stackedWidget->currentWidget() != this->emptyWidget)
     {
         this->stackedWidget->setCurrentWidget(this->listViewWidget);
@@ -343,7 +428,7 @@ void RomBrowserWidget::ShowGrid(void)
     this->currentViewWidget = this->gridViewWidget;
 
     // only change widget now when we're not refreshing
-    if (!this->IsRefreshingRomList() &&
+    if ((!this->IsRefreshingRomList() || this->isUpdatingRomList) &&
         this->stackedWidget->currentWidget() != this->emptyWidget)
     {
         this->stackedWidget->setCurrentWidget(this->gridViewWidget);
@@ -499,10 +584,9 @@ void RomBrowserWidget::addRomData(QString file, CoreRomType type, CoreRomHeader
     QString gameFormat;
     float fileSize;
     QString fileSizeString;
-    QString coverFile;
-    QIcon   coverIcon;
     QVariant itemData;
     RomBrowserModelData modelData;
+    QFileInfo fileInfo(file);
 
     // create item data
     modelData = RomBrowserModelData(file, type, header, settings);
@@ -512,7 +596,7 @@ void RomBrowserWidget::addRomData(QString file, CoreRomType type, CoreRomHeader
     if (name.endsWith("(unknown rom)") ||
         name.endsWith("(unknown disk)"))
     {
-        name = QFileInfo(file).fileName();
+        name = fileInfo.fileName();
     }
 
     // generate game format to use in UI
@@ -526,16 +610,16 @@ void RomBrowserWidget::addRomData(QString file, CoreRomType type, CoreRomHeader
     }
 
     // generate file size to use in UI
-    fileSize = QFileInfo(file).size()/1048576.0;
+    fileSize = fileInfo.size()/1048576.0;
     fileSizeString = (QString::number(fileSize, 'f', 2)).append(" MB");
     if (fileSizeString.size() == 7)
     {
         fileSizeString = fileSizeString.prepend("  ");
     }
 
-    // retrieve cover image
-    coverIcon = this->getCurrentCover(file, header, settings, coverFile);
-    modelData.coverFile = coverFile;
+    // keep track of the file's modification time,
+    // so we can detect changes to it later on
+    this->romFileTimes.insert(file, fileInfo.lastModified());
 
     // create item data
     itemData = QVariant::fromValue<RomBrowserModelData>(modelData);
@@ -560,11 +644,11 @@ void RomBrowserWidget::addRomData(QString file, CoreRomType type, CoreRomHeader
     listViewRow.append(listViewItem4);
     // file name
     QStandardItem* listViewItem5 = new QStandardItem();
-    listViewItem5->setText(QFileInfo(file).completeBaseName());
+    listViewItem5->setText(fileInfo.completeBaseName());
     listViewRow.append(listViewItem5);
     // file extension
     QStandardItem* listViewItem6 = new QStandardItem();
-    listViewItem6->setText(((QFileInfo(file).suffix()).prepend(".")).toUpper());
+    listViewItem6->setText((fileInfo.suffix().prepend(".")).toUpper());
     listViewRow.append(listViewItem6);
     // file size
     QStandardItem* listViewItem7 = new QStandardItem();
@@ -580,85 +664,337 @@ void RomBrowserWidget::addRomData(QString file, CoreRomType type, CoreRomHeader
     listViewRow.append(listViewItem9);
     this->listViewModel->appendRow(listViewRow);
 
+    // the cover is loaded when
+    // the item becomes visible
     QStandardItem* gridViewItem = new QStandardItem();
-    gridViewItem->setIcon(coverIcon);
+    gridViewItem->setIcon(this->fallbackCoverIcon);
     gridViewItem->setText(name);
     gridViewItem->setData(itemData);
     this->gridViewModel->appendRow(gridViewItem);
+    this->gridViewItems.insert(file, gridViewItem);
+}
+
+void RomBrowserWidget::removeRomData(const QSet<QString>& files)
+{
+    RomBrowserModelData modelData;
+    int count = 0;
+
+    // both models contain the same rows
+    // in the same order, so we only have
+    // to look at the list view's model,
+    // adjacent rows are removed at once
+    for (int i = this->listViewModel->rowCount() - 1; i >= 0; i--)
+    {
+        modelData = this->listViewModel->item(i)->data().value<RomBrowserModelData>();
+        if (files.contains(modelData.file))
+        {
+            this->romFileTimes.remove(modelData.file);
+            this->gridViewItems.remove(modelData.file);
+            this->coverLoader->Remove(modelData.file);
+            count++;
+            continue;
+        }
+
+        if (count > 0)
+        {
+            this->listViewModel->removeRows(i + 1, count);
+            this->gridViewModel->removeRows(i + 1, count);
+            count = 0;
+        }
+    }
+
+    if (count > 0)
+    {
+        this->listViewModel->removeRows(0, count);
+        this->gridViewModel->removeRows(0, count);
+    }
 }
 
-QIcon RomBrowserWidget::getCurrentCover(QString file, CoreRomHeader header, CoreRomSettings settings, QString& coverFileName)
+bool RomBrowserWidget::addCachedRomData(QString directory, bool recursive, int maxItems)
 {
-    QPixmap pixmap;
-
-    // construct basename of file,
-    // by retrieving the last index of '.'
-    // and removing all characters from that index
-    // until the end of the string
-    QString baseName         = QFileInfo(file).fileName();
-    qsizetype lastIndexOfDot = baseName.lastIndexOf(".");
-    if (lastIndexOfDot != -1)
-    { // only remove when index was found
-        baseName.remove(lastIndexOfDot, baseName.size() - lastIndexOfDot);
-    }
-
-    // try to load cover using
-    // 1) basename of file
-    // 2) MD5
-    // 3) good name
-    // 4) internal name
-    bool foundCover = false;
-    for (QString name : { 
-        baseName,
-        QString::fromStdString(settings.MD5), 
-        QString::fromStdString(settings.GoodName), 
-        QString::fromStdString(header.Name) })
-    {
-        // fixup file name
-        QString fixedName = name;
-        for (const QChar c : QString(":<>\"/\\|?*"))
+    const QStringList nameFilters = Thread::RomSearcherThread::GetNameFilters();
+    std::vector<CoreRomHeaderAndSettings> cachedRoms;
+    QString file;
+    int count = 0;
+
+    cachedRoms = CoreGetCachedRomHeaderAndSettingsInDirectory(directory.toStdU32String(), recursive);
+
+    for (const CoreRomHeaderAndSettings& cachedRom : cachedRoms)
+    {
+        if (count >= maxItems)
         {
-            fixedName.replace(c, "_");
+            break;
         }
 
-        // skip empty names,
-        // this can i.e happen
-        // when ROMs don't have 
-        // an internal ROM name
-        if (fixedName.isEmpty())
+        file = QString::fromStdU32String(cachedRom.File.u32string());
+
+        // only add the files which the
+        // ROM searcher would find as well
+        if (!QDir::match(nameFilters, QFileInfo(file).fileName()))
         {
             continue;
         }
 
-        // we support jpg & png as file extensions
-        for (QString ext : { ".png", ".jpg", ".jpeg" })
+        this->addRomData(file, cachedRom.Type, cachedRom.Header, cachedRom.Settings);
+        count++;
+    }
+
+    return count > 0;
+}
+
+void RomBrowserWidget::configureRomListView(void)
+{
+    // sort data
+    this->listViewProxyModel->sort(this->listViewSortSection, (Qt::SortOrder)this->listViewSortOrder);
+    this->gridViewProxyModel->sort(0, Qt::SortOrder::AscendingOrder);
+
+    // retrieve column settings
+    std::vector<int> columnSizes = CoreSettingsGetIntListValue(SettingsID::RomBrowser_ColumnSizes);
+    std::vector<int> columnOrder = CoreSettingsGetIntListValue(SettingsID::RomBrowser_ColumnOrder);
+    std::vector<int> columnVisibility = CoreSettingsGetIntListValue(SettingsID::RomBrowser_ColumnVisibility);
+
+    // temporarily disable stretching last column in list view
+    this->listViewWidget->horizontalHeader()->setStretchLastSection(false);
+
+    // reset column sizes setting in config file if number of values is incorrect
+    if (!columnSizes.empty() && 
+        columnSizes.size() != this->listViewModel->columnCount())
+    {
+        columnSizes.clear();
+        columnSizes.resize(this->listViewModel->columnCount(), -1);
+        CoreSettingsSetValue(SettingsID::RomBrowser_ColumnSizes, columnSizes);
+    }
+
+    // update list view's column sizes when
+    // we have any rows in our list view
+    if (this->listViewModel->rowCount() != 0)
+    {
+        for (size_t i = 0; i < columnSizes.size(); i++)
+        {
+            // set column widths to values specified in config file (or resize to content if not already specified)
+            if (columnSizes.at(i) == -1)
+            {
+                this->listViewWidget->resizeColumnToContents(i);
+            }
+            else
+            {
+                this->listViewWidget->setColumnWidth(i, columnSizes.at(i));
+            }
+        }
+    }
+
+    // enable stretching last column in list view
+    this->listViewWidget->horizontalHeader()->setStretchLastSection(true);
+
+    // reset column order setting in config file if number of values is incorrect
+    if (!columnOrder.empty() &&
+        columnOrder.size() != this->listViewModel->columnCount())
+    {
+        columnOrder.clear();
+        for (int i = 0; i < this->listViewModel->columnCount(); i++)
+        {
+            columnOrder.push_back(i);
+        }
+        CoreSettingsSetValue(SettingsID::RomBrowser_ColumnOrder, columnOrder);
+    }
+
+    // update list view's column order
+    for (size_t i = 0; i < columnOrder.size(); i++)
+    {
+        this->listViewWidget->horizontalHeader()->moveSection(this->listViewWidget->horizontalHeader()->visualIndex(i), columnOrder.at(i));
+    }
+
+    // reset column visibility setting in config file if number of values is incorrect
+    if (!columnVisibility.empty() &&
+        columnVisibility.size() != this->listViewModel->columnCount())
+    {
+        columnVisibility.clear();
+        columnVisibility.resize(this->listViewModel->columnCount(), 0);
+        for (int i = 0; i < 3; i++)
+        {
+            columnVisibility.at(i) = 1;
+        }
+        CoreSettingsSetValue(SettingsID::RomBrowser_ColumnVisibility, columnVisibility);
+    }
+
+    // update list view's column visibilities
+    for (size_t i = 0; i < columnVisibility.size(); i++)
+    {
+        if (columnVisibility.at(i) == 0)
+        {
+            this->listViewWidget->horizontalHeader()->setSectionHidden(i, true);
+        }
+    }
+
+    // generate 'Play Game with Disk' menu here
+    // instead of when a context menu has been requested,
+    // this should save a lot of otherwise wasted CPU cycles
+    this->generatePlayWithDiskMenu();
+}
+
+void RomBrowserWidget::watchRomDirectory(void)
+{
+    if (!CoreSettingsGetBoolValue(SettingsID::RomBrowser_WatchDirectory))
+    {
+        return;
+    }
+
+    QString directory = QString::fromStdString(CoreSettingsGetStringValue(SettingsID::RomBrowser_Directory));
+    if (directory.isEmpty())
+    {
+        return;
+    }
+
+    QStringList directories;
+    directories << directory;
+
+    if (CoreSettingsGetBoolValue(SettingsID::RomBrowser_Recursive))
+    {
+        QDirIterator dirIt(directory, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (dirIt.hasNext())
+        {
+            directories << dirIt.next();
+        }
+    }
+
+    this->romDirectoryWatcher->addPaths(directories);
+}
+
+void RomBrowserWidget::updateRomList(void)
+{
+    const QStringList nameFilters = Thread::RomSearcherThread::GetNameFilters();
+    const bool recursive = CoreSettingsGetBoolValue(SettingsID::RomBrowser_Recursive);
+    const QStringList watchedDirectoryList = this->romDirectoryWatcher->directories();
+    QSet<QString> watchedDirectories(watchedDirectoryList.begin(), watchedDirectoryList.end());
+    QSet<QString> removedFiles;
+    QStringList addedFiles;
+
+    for (const QString& directory : this->changedRomDirectories)
+    {
+        const QString cleanDirectory = QDir::cleanPath(directory);
+        const bool directoryExists   = QDir(directory).exists();
+
+        // find the files which were removed or
+        // modified, when the directory itself
+        // has been removed, every file in it
+        // (and its sub-directories) is removed
+        for (auto it = this->romFileTimes.cbegin(); it != this->romFileTimes.cend(); it++)
+        {
+            const QString& file = it.key();
+
+            if (!directoryExists)
+            {
+                if (QDir::cleanPath(file).startsWith(cleanDirectory + "/"))
+                {
+                    removedFiles.insert(file);
+                }
+                continue;
+            }
+
+            QFileInfo fileInfo(file);
+            if (QDir::cleanPath(fileInfo.path()) != cleanDirectory)
+            {
+                continue;
+            }
+
+            if (!fileInfo.exists())
+            {
+                removedFiles.insert(file);
+            }
+            else if (fileInfo.lastModified() != it.value())
+            {
+                removedFiles.insert(file);
+                addedFiles.append(file);
+            }
+        }
+
+        if (!directoryExists)
         {
-            QString coverPath = this->coversDirectory;
-            coverPath += CORE_DIR_SEPERATOR_STR;
-            coverPath += fixedName;
-            coverPath += ext;
+            continue;
+        }
 
-            if (QFile::exists(coverPath) && 
-                pixmap.load(coverPath))
+        // find the files which were added
+        QDirIterator romDirIt(directory, nameFilters, QDir::Files);
+        while (romDirIt.hasNext())
+        {
+            QString file = romDirIt.next();
+            if (!this->romFileTimes.contains(file))
             {
-                coverFileName = coverPath;
-                foundCover = true;
-                break;
+                addedFiles.append(file);
             }
         }
 
-        if (foundCover)
+        if (!recursive)
         {
-            break;
+            continue;
+        }
+
+        // find the sub-directories which were added,
+        // start watching them and add their files
+        QDirIterator dirIt(directory, QDir::Dirs | QDir::NoDotAndDotDot);
+        while (dirIt.hasNext())
+        {
+            QString subDirectory = dirIt.next();
+            if (watchedDirectories.contains(subDirectory))
+            {
+                continue;
+            }
+
+            QStringList subDirectories;
+            subDirectories << subDirectory;
+
+            QDirIterator subDirIt(subDirectory, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while (subDirIt.hasNext())
+            {
+                subDirectories << subDirIt.next();
+            }
+
+            this->romDirectoryWatcher->addPaths(subDirectories);
+            watchedDirectories.unite(QSet<QString>(subDirectories.begin(), subDirectories.end()));
+
+            QDirIterator subRomDirIt(subDirectory, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+            while (subRomDirIt.hasNext())
+            {
+                addedFiles.append(subRomDirIt.next());
+            }
         }
     }
-    // fallback
-    if (!foundCover)
+
+    this->changedRomDirectories.clear();
+
+    if (!removedFiles.isEmpty())
+    {
+        this->removeRomData(removedFiles);
+    }
+
+    // retrieve the data of the added files
+    // on the ROM searcher thread, only the
+    // data of those files will be added to
+    // the models when it's done
+    const int maxItems = CoreSettingsGetIntValue(SettingsID::RomBrowser_MaxItems) - this->romFileTimes.size();
+    if (!addedFiles.isEmpty() && maxItems > 0)
     {
-        pixmap.load(":Resource/CoverFallback.png");
+        this->isUpdatingRomList = true;
+        this->romSearcherThread->SetMaximumFiles(maxItems);
+        this->romSearcherThread->SetFiles(addedFiles);
+        // opening disks in the core isn't allowed
+        // while we're updating in the background,
+        // new disks are added by the next refresh
+        this->romSearcherThread->SetOpenDisks(false);
+        this->romSearcherThread->start();
+        return;
     }
 
-    return QIcon(pixmap);
+    if (!removedFiles.isEmpty())
+    {
+        this->generatePlayWithDiskMenu();
+
+        if (this->listViewModel->rowCount() == 0)
+        {
+            this->searchLineEdit->hide();
+            this->stackedWidget->setCurrentWidget(this->emptyWidget);
+        }
+    }
 }
 
 void RomBrowserWidget::timerEvent(QTimerEvent* event)
@@ -962,104 +1298,133 @@ void RomBrowserWidget::on_ZoomOut(void)
 
 void RomBrowserWidget::on_RomBrowserThread_RomsFound(QList<RomSearcherThreadData> data, int index, int count)
 {
-    // add every item to our dataset
+    QStandardItem* item;
+    RomBrowserModelData modelData;
+    QSet<QString> changedFiles;
+    QList<qsizetype> addedItems;
+
+    // find the items which we have to add
     for (qsizetype i = 0; i < data.size(); i++)
+    {
+        if (this->isSyncingRomList)
+        {
+            this->syncedRomFiles.insert(data[i].File);
+        }
+
+        // when the file has already been added
+        // from the cache, only replace it
+        // when its data has changed
+        item = this->gridViewItems.value(data[i].File, nullptr);
+        if (item != nullptr)
+        {
+            modelData = item->data().value<RomBrowserModelData>();
+            if (modelData.type == data[i].Type &&
+                modelData.settings.MD5 == data[i].Settings.MD5 &&
+                modelData.settings.GoodName == data[i].Settings.GoodName)
+            {
+                continue;
+            }
+
+            changedFiles.insert(data[i].File);
+        }
+
+        addedItems.append(i);
+    }
+
+    // remove the changed items at once
+    // before adding them again
+    if (!changedFiles.isEmpty())
+    {
+        this->removeRomData(changedFiles);
+    }
+
+    // add every item to our dataset
+    for (qsizetype i : addedItems)
     {
         this->addRomData(data[i].File, data[i].Type, data[i].Header, data[i].Settings);
     }
 
     // update loading widget
-    this->loadingWidget->SetCurrentRomIndex(index, count);
+    if (!this->isUpdatingRomList && !this->isSyncingRomList)
+    {
+        this->loadingWidget->SetCurrentRomIndex(index, count);
+    }
 }
 
 void RomBrowserWidget::on_RomBrowserThread_Finished(bool canceled)
 {
-    // sort data
-    this->listViewProxyModel->sort(this->listViewSortSection, (Qt::SortOrder)this->listViewSortOrder);
-    this->gridViewProxyModel->sort(0, Qt::SortOrder::AscendingOrder);
+    // when we've only updated the ROM list
+    // with the changes in the ROM directory,
+    // the models are already sorted and the
+    // columns are already set up
+    if (this->isUpdatingRomList)
+    {
+        this->isUpdatingRomList = false;
 
-    // retrieve column settings
-    std::vector<int> columnSizes = CoreSettingsGetIntListValue(SettingsID::RomBrowser_ColumnSizes);
-    std::vector<int> columnOrder = CoreSettingsGetIntListValue(SettingsID::RomBrowser_ColumnOrder);
-    std::vector<int> columnVisibility = CoreSettingsGetIntListValue(SettingsID::RomBrowser_ColumnVisibility);
+        this->generatePlayWithDiskMenu();
 
-    // temporarily disable stretching last column in list view
-    this->listViewWidget->horizontalHeader()->setStretchLastSection(false);
+        if (this->listViewModel->rowCount() == 0)
+        {
+            this->searchLineEdit->hide();
+            this->stackedWidget->setCurrentWidget(this->emptyWidget);
+        }
+        else if (this->stackedWidget->currentWidget() == this->emptyWidget)
+        {
+            this->stackedWidget->setCurrentWidget(this->currentViewWidget);
+        }
 
-    // reset column sizes setting in config file if number of values is incorrect
-    if (!columnSizes.empty() && 
-        columnSizes.size() != this->listViewModel->columnCount())
-    {
-        columnSizes.clear();
-        columnSizes.resize(this->listViewModel->columnCount(), -1);
-        CoreSettingsSetValue(SettingsID::RomBrowser_ColumnSizes, columnSizes);
+        // apply the changes which came in
+        // while we were updating
+        if (!this->isRomDirectoryWatcherPaused &&
+            !this->changedRomDirectories.isEmpty())
+        {
+            this->romDirectoryWatcherTimer->start();
+        }
+        return;
     }
 
-    // update list view's column sizes when
-    // we have any rows in our list view
-    if (this->listViewModel->rowCount() != 0)
+    // when we've shown the cached entries,
+    // the list view is already set up, so only
+    // remove the files which don't exist anymore
+    if (this->isSyncingRomList)
     {
-        for (size_t i = 0; i < columnSizes.size(); i++)
+        // the search has been stopped,
+        // so we can't tell which files
+        // have been removed
+        if (canceled)
         {
-            // set column widths to values specified in config file (or resize to content if not already specified)
-            if (columnSizes.at(i) == -1)
-            {
-                this->listViewWidget->resizeColumnToContents(i);
-            }
-            else
-            {
-                this->listViewWidget->setColumnWidth(i, columnSizes.at(i));
-            }
+            return;
         }
-    }
-
-    // enable stretching last column in list view
-    this->listViewWidget->horizontalHeader()->setStretchLastSection(true);
 
-    // reset column order setting in config file if number of values is incorrect
-    if (!columnOrder.empty() &&
-        columnOrder.size() != this->listViewModel->columnCount())
-    {
-        columnOrder.clear();
-        for (int i = 0; i < this->listViewModel->columnCount(); i++)
+        QSet<QString> removedFiles;
+        for (auto it = this->romFileTimes.cbegin(); it != this->romFileTimes.cend(); it++)
         {
-            columnOrder.push_back(i);
+            if (!this->syncedRomFiles.contains(it.key()))
+            {
+                removedFiles.insert(it.key());
+            }
         }
-        CoreSettingsSetValue(SettingsID::RomBrowser_ColumnOrder, columnOrder);
-    }
 
-    // update list view's column order
-    for (size_t i = 0; i < columnOrder.size(); i++)
-    {
-        this->listViewWidget->horizontalHeader()->moveSection(this->listViewWidget->horizontalHeader()->visualIndex(i), columnOrder.at(i));
-    }
+        this->isSyncingRomList = false;
+        this->syncedRomFiles.clear();
 
-    // reset column visibility setting in config file if number of values is incorrect
-    if (!columnVisibility.empty() &&
-        columnVisibility.size() != this->listViewModel->columnCount())
-    {
-        columnVisibility.clear();
-        columnVisibility.resize(this->listViewModel->columnCount(), 0);
-        for (int i = 0; i < 3; i++)
+        if (!removedFiles.isEmpty())
         {
-            columnVisibility.at(i) = 1;
+            this->removeRomData(removedFiles);
         }
-        CoreSettingsSetValue(SettingsID::RomBrowser_ColumnVisibility, columnVisibility);
-    }
 
-    // update list view's column visibilities
-    for (size_t i = 0; i < columnVisibility.size(); i++)
-    {
-        if (columnVisibility.at(i) == 0)
+        this->generatePlayWithDiskMenu();
+        this->watchRomDirectory();
+
+        if (this->listViewModel->rowCount() == 0)
         {
-            this->listViewWidget->horizontalHeader()->setSectionHidden(i, true);
+            this->searchLineEdit->hide();
+            this->stackedWidget->setCurrentWidget(this->emptyWidget);
         }
+        return;
     }
 
-    // generate 'Play Game with Disk' menu here
-    // instead of when a context menu has been requested,
-    // this should save a lot of otherwise wasted CPU cycles
-    this->generatePlayWithDiskMenu();
+    this->configureRomListView();
 
     // when canceled, we shouldn't switch to the grid/list view
     // because that can cause some flicker, so just return here
@@ -1070,6 +1435,10 @@ void RomBrowserWidget::on_RomBrowserThread_Finished(bool canceled)
         return;
     }
 
+    // keep the ROM list in sync with
+    // the ROM directory from now on
+    this->watchRomDirectory();
+
     if (this->listViewModel->rowCount() == 0)
     {
         this->stackedWidget->setCurrentWidget(this->emptyWidget);
@@ -1089,6 +1458,119 @@ void RomBrowserWidget::on_RomBrowserThread_Finished(bool canceled)
     this->searchLineEdit->setVisible(this->showSearchLineEdit);
 }
 
+void RomBrowserWidget::on_RomDirectoryWatcher_directoryChanged(const QString& directory)
+{
+    this->changedRomDirectories.insert(directory);
+    if (!this->isRomDirectoryWatcherPaused)
+    {
+        this->romDirectoryWatcherTimer->start();
+    }
+}
+
+void RomBrowserWidget::on_RomDirectoryWatcherTimer_timeout(void)
+{
+    // the changes will be applied
+    // when the ROM searcher thread
+    // has finished or when we're resumed
+    if (this->isRomDirectoryWatcherPaused ||
+        this->romSearcherThread->isRunning())
+    {
+        return;
+    }
+
+    this->updateRomList();
+}
+
+void RomBrowserWidget::on_CoverLoaderTimer_timeout(void)
+{
+    if (this->stackedWidget->currentWidget() != this->gridViewWidget)
+    {
+        return;
+    }
+
+    const int rowCount = this->gridViewProxyModel->rowCount();
+    if (rowCount == 0)
+    {
+        return;
+    }
+
+    const QRect viewportRect = this->gridViewWidget->viewport()->rect();
+
+    // the grid view lays out its items from
+    // left to right and top to bottom, so we can
+    // find the first visible item with a binary search
+    int low   = 0;
+    int high  = rowCount - 1;
+    int first = rowCount;
+    while (low <= high)
+    {
+        int middle = low + ((high - low) / 2);
+        QRect itemRect = this->gridViewWidget->visualRect(this->gridViewProxyModel->index(middle, 0));
+        if (itemRect.bottom() < viewportRect.top())
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            first = middle;
+            high  = middle - 1;
+        }
+    }
+
+    // request the covers of the visible items
+    // and the items on the next page, so they're
+    // (usually) loaded before they're scrolled into view
+    const int last = viewportRect.bottom() + viewportRect.height();
+    RomBrowserModelData data;
+    for (int i = first; i < rowCount; i++)
+    {
+        QModelIndex proxyIndex = this->gridViewProxyModel->index(i, 0);
+        if (this->gridViewWidget->visualRect(proxyIndex).top() > last)
+        {
+            break;
+        }
+
+        QStandardItem* item = this->gridViewModel->itemFromIndex(this->gridViewProxyModel->mapToSource(proxyIndex));
+        if (item == nullptr)
+        {
+            continue;
+        }
+
+        data = item->data().value<RomBrowserModelData>();
+        this->coverLoader->Load(data.file, data.header, data.settings);
+    }
+}
+
+void RomBrowserWidget::on_CoverLoader_CoverLoaded(QString file, QString coverFile, QImage image)
+{
+    QStandardItem* item = this->gridViewItems.value(file, nullptr);
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    RomBrowserModelData data = item->data().value<RomBrowserModelData>();
+    data.coverFile = coverFile;
+    item->setData(QVariant::fromValue<RomBrowserModelData>(data));
+
+    // both models contain the same rows in the same
+    // order, so keep the list view's item in sync
+    QStandardItem* listViewItem = this->listViewModel->item(item->row());
+    if (listViewItem != nullptr)
+    {
+        listViewItem->setData(QVariant::fromValue<RomBrowserModelData>(data));
+    }
+
+    if (image.isNull())
+    {
+        item->setIcon(this->fallbackCoverIcon);
+    }
+    else
+    {
+        item->setIcon(QIcon(QPixmap::fromImage(image)));
+    }
+}
+
 void RomBrowserWidget::on_Action_PlayGame(void)
 {
     emit this->PlayGame(this->getCurrentRom());
@@ -1208,7 +1690,6 @@ void RomBrowserWidget::on_Action_SetCoverImage(void)
 {
     QString sourceFile;
     QFileInfo sourceFileInfo;
-    QString coverFile;
 
     QStandardItemModel* model = this->getCurrentModel();
     QAbstractItemView*  view  = this->getCurrentModelView();
@@ -1232,7 +1713,6 @@ void RomBrowserWidget::on_Action_SetCoverImage(void)
     sourceFileInfo = QFileInfo(sourceFile);
 
     QModelIndex         index = view->currentIndex();
-    QStandardItem*      item  = model->item(index.row(), index.column());
     RomBrowserModelData data  = model->itemData(index).last().value<RomBrowserModelData>();
 
     // construct new file name (for the cover)
@@ -1261,10 +1741,9 @@ void RomBrowserWidget::on_Action_SetCoverImage(void)
     // copy new one
     QFile::copy(sourceFile, newFileName);
 
-    // update item
-    item->setIcon(this->getCurrentCover(data.file, data.header, data.settings, coverFile));
-    data.coverFile = coverFile;
-    item->setData(QVariant::fromValue<RomBrowserModelData>(data));
+    // the items are updated
+    // when the cover has been loaded
+    this->coverLoader->Reload(data.file, data.header, data.settings);
 }
 
 void RomBrowserWidget::on_Action_RemoveCoverImage(void)
@@ -1277,17 +1756,15 @@ void RomBrowserWidget::on_Action_RemoveCoverImage(void)
     }
 
     QModelIndex         index = view->currentIndex();
-    QStandardItem*      item  = model->item(index.row(), index.column());
     RomBrowserModelData data  = model->itemData(index).last().value<RomBrowserModelData>();
-    QString coverFile;
 
     if (!data.coverFile.isEmpty() && QFile::exists(data.coverFile))
     {
         QFile::remove(data.coverFile);
     }
 
-    // update item
-    item->setIcon(this->getCurrentCover(data.file, data.header, data.settings, coverFile));
-    data.coverFile = coverFile;
-    item->setData(QVariant::fromValue<RomBrowserModelData>(data));
+    // another cover can still be found for
+    // the item, so the items are updated
+    // when the cover has been loaded
+    this->coverLoader->Reload(data.file, data.header, data.settings);
 }
@@ -11,6 +11,7 @@
 #define ROMBROWSERWIDGET_HPP
 
 #include "Thread/RomSearcherThread.hpp"
+#include "Thread/CoverLoader.hpp"
 #include "UserInterface/NoFocusDelegate.hpp"
 
 #include "RomBrowserListViewWidget.hpp"
@@ -19,6 +20,7 @@
 #include "RomBrowserEmptyWidget.hpp"
 
 #include <QSortFilterProxyModel>
+#include <QFileSystemWatcher>
 #include <QStandardItemModel>
 #include <QStackedWidget>
 #include <QGridLayout>
@@ -27,8 +29,12 @@
 #include <QTableView>
 #include <QLineEdit>
 #include <QAction>
+#include <QDateTime>
 #include <QString>
+#include <QTimer>
+#include <QHash>
 #include <QList>
+#include <QSet>
 #include <QMenu>
 #include <QMap>
 
@@ -51,6 +57,9 @@ class RomBrowserWidget : public QWidget
     bool IsRefreshingRomList(void);
     void StopRefreshRomList(void);
 
+    void PauseRomDirectoryWatcher(void);
+    void ResumeRomDirectoryWatcher(void);
+
     void ShowList(void);
     void ShowGrid(void);
 
@@ -78,6 +87,20 @@ class RomBrowserWidget : public QWidget
 
     QElapsedTimer romSearcherTimer;
     Thread::RomSearcherThread* romSearcherThread = nullptr;
+
+    QFileSystemWatcher* romDirectoryWatcher  = nullptr;
+    QTimer* romDirectoryWatcherTimer         = nullptr;
+    QSet<QString> changedRomDirectories;
+    bool isRomDirectoryWatcherPaused = false;
+    QHash<QString, QDateTime> romFileTimes;
+    bool isUpdatingRomList = false;
+    bool isSyncingRomList  = false;
+    QSet<QString> syncedRomFiles;
+
+    Thread::CoverLoader* coverLoader = nullptr;
+    QTimer* coverLoaderTimer         = nullptr;
+    QIcon fallbackCoverIcon;
+    QHash<QString, QStandardItem*> gridViewItems;
   
     int listViewSortSection = 0;
     int listViewSortOrder = 0;
@@ -112,8 +135,13 @@ class RomBrowserWidget : public QWidget
     QString getCurrentRom(void);
 
     void addRomData(QString file, CoreRomType type, CoreRomHeader header, CoreRomSettings settings);
+    void removeRomData(const QSet<QString>& files);
+
+    bool addCachedRomData(QString directory, bool recursive, int maxItems);
+    void configureRomListView(void);
 
-    QIcon getCurrentCover(QString file, CoreRomHeader header, CoreRomSettings settings, QString& coverFileName);
+    void watchRomDirectory(void);
+    void updateRomList(void);
 
   protected:
     void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE;
@@ -140,6 +168,12 @@ class RomBrowserWidget : public QWidget
     void on_RomBrowserThread_RomsFound(QList<RomSearcherThreadData> data, int index, int count);
     void on_RomBrowserThread_Finished(bool canceled);
 
+    void on_RomDirectoryWatcher_directoryChanged(const QString& directory);
+    void on_RomDirectoryWatcherTimer_timeout(void);
+
+    void on_CoverLoaderTimer_timeout(void);
+    void on_CoverLoader_CoverLoaded(QString file, QString coverFile, QImage image);
+
     void on_Action_PlayGame(void);
     void on_Action_PlayGameWith(void);
     void on_Menu_PlayGameWithDisk(QAction* action);